@@ -0,0 +1,38 @@
+/*
+    C versions of the routines in bcd.s, a digit at a time. See bcd.h.
+*/
+
+#include <stdint.h>
+#include "bcd.h"
+
+uint64_t __attribute__((weak)) Bin2Bcd32(uint32_t binary)
+    {
+    uint64_t bcd = 0 ;
+
+    for (int shift = 0; binary != 0; shift += 4)
+        {
+        bcd |= (uint64_t) (binary % 10) << shift ;
+        binary /= 10 ;
+        }
+    return bcd ;
+    }
+
+void __attribute__((weak)) Bin2Bcd64(uint64_t binary, uint32_t bcd[BCD64_WORDS])
+    {
+    for (int k = 0; k < BCD64_WORDS; k++) bcd[k] = 0 ;
+    for (int k = 0; binary != 0; k++)
+        {
+        bcd[k / 8] |= (uint32_t) (binary % 10) << 4*(k % 8) ;
+        binary /= 10 ;
+        }
+    }
+
+char * __attribute__((weak)) Bcd2Text(char *text, const uint32_t bcd[], unsigned words)
+    {
+    int k = 8*words - 1 ;
+
+    while (k > 0 && (bcd[k / 8] >> 4*(k % 8) & 0xF) == 0) k-- ;
+    for (; k >= 0; k--) *text++ = '0' + (bcd[k / 8] >> 4*(k % 8) & 0xF) ;
+    *text = '\0' ;
+    return text ;
+    }
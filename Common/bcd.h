@@ -0,0 +1,39 @@
+/*
+    Binary to packed BCD, and packed BCD to text, for decimal displays that would
+    otherwise take a % 10 and a / 10 per digit:
+
+        uint64_t bcd = Bin2Bcd32(65535) ;           // 0x65535
+        char text[11] ;
+
+        Bcd2Text(text, (uint32_t *) &bcd, 2) ;      // "65535"
+
+    Packed BCD holds a decimal digit in each nibble, eight to a word, with the
+    least significant digit in the low nibble of the first word. A uint32_t needs
+    ten digits (two words; Bin2Bcd32 returns them as one uint64_t, low word first
+    as on the Cortex-M4), a uint64_t twenty (three words).
+
+    bcd.s has the assembly versions, which bcd.c's __attribute__((weak)) C versions
+    stand in for where it is not linked (the host builds). Bin2Bcd32 and Bin2Bcd64
+    split the number into groups of eight and four digits with the reciprocal
+    multiply of Div32X10 (DIVU in divide.inc, and a 64-bit reciprocal of 10^8 for
+    Bin2Bcd64), then convert two digit pairs at once in the halfwords of one word.
+    Bcd2Text writes the digits four to a word. "make kernelbench" in Host/ times them
+    against the digit-at-a-time division loops.
+*/
+
+#ifndef __BCD_H
+#define __BCD_H
+
+#include <stdint.h>
+
+#define BCD32_WORDS         2               // ten digits
+#define BCD64_WORDS         3               // twenty digits
+
+uint64_t                    Bin2Bcd32(uint32_t binary) ;
+void                        Bin2Bcd64(uint64_t binary, uint32_t bcd[BCD64_WORDS]) ;
+
+// The digits of bcd[words-1..0] without leading zeros (but at least one digit),
+// '\0' terminated; returns a pointer to the '\0'
+char *                      Bcd2Text(char *text, const uint32_t bcd[], unsigned words) ;
+
+#endif
@@ -0,0 +1,185 @@
+/*
+    Binary to packed BCD and packed BCD to text. See bcd.h; bcd.c has the same
+    routines in C.
+*/
+        .syntax     unified
+        .cpu        cortex-m4
+        .text
+
+        .include    "divide.inc"
+
+// uint64_t Bin2Bcd32(uint32_t binary) ;
+// The top two digits, then the other eight through Bcd8.
+
+        .global     Bin2Bcd32
+        .thumb_func
+        .align
+Bin2Bcd32:          // R0 = binary
+        PUSH        {R4,LR}
+        DIVU        R4,R0,100000000,R12 // top two digits, 0 to 42
+        LDR         R1,=100000000
+        MLS         R0,R4,R1,R0         // the other eight
+        BL          Bcd8
+        MOVS        R2,205
+        MUL         R1,R4,R2
+        LSRS        R1,R1,11            // tens: (x * 205) >> 11 for x < 1029
+        ADD         R1,R1,R1,LSL 1
+        ADD         R1,R4,R1,LSL 1      // x + 6 x tens is the BCD of x
+        POP         {R4,PC}
+
+// void Bin2Bcd64(uint64_t binary, uint32_t bcd[3]) ;
+// Twice through DivMod1E8 for two groups of eight digits and one of four (the
+// quotient is at most 1844), unless the high word is zero.
+
+        .global     Bin2Bcd64
+        .thumb_func
+        .align
+Bin2Bcd64:          // R1.R0 = binary, R2 = bcd
+        PUSH        {R4-R7,LR}
+        MOV         R4,R2
+        CBNZ        R1,Wide
+        BL          Bin2Bcd32
+        MOVS        R2,0
+        STRD        R0,R1,[R4]
+        STR         R2,[R4,8]
+        POP         {R4-R7,PC}
+Wide:
+        BL          DivMod1E8
+        MOV         R5,R2               // digits 0-7
+        BL          DivMod1E8
+        MOV         R6,R0               // digits 16-19
+        MOV         R0,R2               // digits 8-15
+        BL          Bcd8
+        MOV         R7,R0
+        MOV         R0,R5
+        BL          Bcd8
+        MOV         R5,R0
+        MOV         R0,R6
+        BL          Bcd8
+        STR         R5,[R4]
+        STR         R7,[R4,4]
+        STR         R0,[R4,8]
+        POP         {R4-R7,PC}
+
+// char *Bcd2Text(char *text, const uint32_t bcd[], unsigned words) ;
+// The leading word a digit at a time from its first nonzero digit, then each word
+// after it as two (unaligned) words of four characters.
+
+        .global     Bcd2Text
+        .thumb_func
+        .align
+Bcd2Text:           // R0 = text, R1 = bcd, R2 = words
+        PUSH        {R4-R6}
+        ADD         R1,R1,R2,LSL 2      // just past the top word
+Skip:
+        LDR         R3,[R1,#-4]!
+        CMP         R2,1
+        BLS         Lead                // the last word is written even if zero
+        CBNZ        R3,Lead
+        SUBS        R2,R2,1
+        B           Skip
+Lead:
+        CLZ         R12,R3
+        BIC         R12,R12,3           // 4 x leading zero digits
+        CMP         R12,32
+        IT          EQ
+        MOVEQ       R12,28              // zero is one digit
+        LSL         R3,R3,R12           // first digit in bits 28-31
+        RSB         R12,R12,32          // 4 x digits to write
+LeadDigit:
+        ROR         R3,R3,28            // next digit into bits 0-3
+        AND         R4,R3,15
+        ADD         R4,R4,48            // '0'
+        STRB        R4,[R0],1
+        SUBS        R12,R12,4
+        BNE         LeadDigit
+        LDR         R12,=0x000F000F
+Words:
+        SUBS        R2,R2,1
+        BEQ         Done
+        LDR         R3,[R1,#-4]!        // digits d7 (top nibble) to d0
+        UXTB16      R4,R3,ROR 8         // d7d6 : d3d2 in the halfwords
+        UXTB16      R5,R3               // d5d4 : d1d0
+        AND         R6,R12,R4,LSR 4     // d7 : d3
+        AND         R4,R4,R12           // d6 : d2
+        ORR         R4,R6,R4,LSL 8      // bytes d3 d2 d7 d6, from the lowest
+        AND         R6,R12,R5,LSR 4
+        AND         R5,R5,R12
+        ORR         R5,R6,R5,LSL 8      // bytes d1 d0 d5 d4
+        PKHTB       R6,R5,R4,ASR 16     // d7 d6 d5 d4
+        PKHBT       R4,R4,R5,LSL 16     // d3 d2 d1 d0
+        ORR         R6,R6,0x30303030
+        ORR         R4,R4,0x30303030
+        STR         R6,[R0],4
+        STR         R4,[R0],4
+        B           Words
+Done:
+        MOVS        R1,0
+        STRB        R1,[R0]
+        POP         {R4-R6}
+        BX          LR
+
+// R0 = BCD of R0 < 10^8; R1-R3 and R12 destroyed. Two groups of four digits, each
+// cut in two by 100, then the tens of all four pairs from one multiply per two
+// pairs: with a pair in each halfword, (x * 205) >> 11 leaves each one's tens in
+// the low nibble of its halfword, and adding 6 x tens turns x into its BCD.
+        .thumb_func
+        .align
+Bcd8:
+        DIVU        R1,R0,10000,R12     // a = digits 4-7
+        MOVW        R2,10000
+        MLS         R0,R1,R2,R0         // b = digits 0-3
+        MOVW        R2,5243             // (x * 5243) >> 19 = x / 100 for x < 43699
+        MUL         R3,R1,R2
+        LSRS        R3,R3,19
+        MUL         R12,R0,R2
+        LSRS        R12,R12,19
+        MOVS        R2,100
+        MLS         R1,R3,R2,R1
+        MLS         R0,R12,R2,R0
+        PKHBT       R1,R1,R3,LSL 16     // digits 6-7 : 4-5
+        PKHBT       R0,R0,R12,LSL 16    // digits 2-3 : 0-1
+        MOVS        R2,205
+        MUL         R3,R1,R2
+        MUL         R12,R0,R2
+        LSRS        R3,R3,11
+        LSRS        R12,R12,11
+        AND         R3,R3,0x000F000F
+        AND         R12,R12,0x000F000F
+        ADD         R3,R3,R3,LSL 1
+        ADD         R12,R12,R12,LSL 1
+        ADD         R1,R1,R3,LSL 1      // BCD of each pair in the low byte of
+        ADD         R0,R0,R12,LSL 1     // its halfword
+        ORR         R1,R1,R1,LSR 8
+        ORR         R0,R0,R0,LSR 8
+        PKHBT       R0,R0,R1,LSL 16
+        BX          LR
+
+// R1.R0 = R1.R0 / 10^8, R2 = remainder: the high 64 bits of the dividend x
+// 0xABCC77118461CEFD (2^90 / 10^8 rounded up) shifted right 26, as Div64X10
+        .thumb_func
+        .align
+DivMod1E8:
+        PUSH        {R4,R5}
+        LDR         R3,=0xABCC7711      // high word of the reciprocal
+        LDR         R2,=0x8461CEFD      // low word
+        UMULL       R12,R4,R0,R2
+        MOVS        R5,0
+        UMLAL       R4,R5,R0,R3
+        MOVS        R12,0
+        UMLAL       R4,R12,R1,R2
+        MOVS        R4,0
+        ADDS        R5,R5,R12
+        ADC         R4,R4,0
+        UMLAL       R5,R4,R1,R3         // R4.R5 = product >> 64
+        LSRS        R5,R5,26
+        ORR         R5,R5,R4,LSL 6
+        LSRS        R4,R4,26            // R4.R5 = quotient
+        LDR         R3,=100000000
+        MLS         R2,R5,R3,R0         // low words suffice: the remainder < 10^8
+        MOV         R0,R5
+        MOV         R1,R4
+        POP         {R4,R5}
+        BX          LR
+
+        .end
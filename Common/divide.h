@@ -0,0 +1,85 @@
+/*
+    Division by a constant, worked out at compile time, with neither a divide
+    instruction nor a call to __aeabi_uidiv/__aeabi_uldivmod:
+
+        q = DIVU32(n, 100) ;                // UMULL and a shift
+        q = DIVS32(x, 100) ;                // truncates toward zero, as x / 100 does
+        q = DIVEXACT64(n, 1000000) ;        // n must be a multiple of 1000000
+
+    DIVU32 is the method of Div32X10 in Lab8C-Resistors.s, for any divisor d from 1
+    to 0xFFFFFFFF. With L = ceil(log2(d)), the magic number is ceil(2^(31+L) / d).
+    When that fits in 32 bits and is close enough to 2^(31+L)/d (DIVU_SHORT), the
+    quotient is the high word of n x magic shifted right by L - 1, as for 10:
+    3435973837 and 3. Otherwise (7, for one) the magic is 33 bits: its low word is
+    used and the correction adds n back into the high word before the shift. The
+    same constants are available to assembly language callers from divide.inc.
+
+    DIVS32 divides the magnitudes and then fixes the sign. DIVEXACT64 shifts out
+    the divisor's factors of two and multiplies by the inverse of the odd part
+    modulo 2^64, which gives the quotient only when the remainder is zero; on the
+    Cortex-M4 that is a UMULL and two MLAs.
+
+    The divisor must be a constant expression. "make divcheck" in Host/ checks
+    every 32-bit dividend against the divide instruction for each divisor the
+    programs use and for a spread of others.
+*/
+
+#ifndef __DIVIDE_H
+#define __DIVIDE_H
+
+#include <stdint.h>
+
+// ceil(log2(d)) for d >= 2; 1 for d = 1, which DIVU_FORM handles separately
+#define DIVU_LOG2(d)        (32 - __builtin_clz(((uint32_t) (d) - 1) | 1))
+
+#define DIVU_ONE            0
+#define DIVU_SHORT          1
+#define DIVU_LONG           2
+
+// 2^(31+L) - 1, and ceil(2^(31+L) / d) as 64 bits
+#define DIVU_POWER(d)       ((1ULL << (31 + DIVU_LOG2(d))) - 1)
+#define DIVU_WIDE(d)        (DIVU_POWER(d) / (uint32_t) (d) + 1)
+
+// The rounding error of the short magic must not reach the quotient
+#define DIVU_ERROR(d)       ((uint32_t) (d) - 1 - DIVU_POWER(d) % (uint32_t) (d))
+#define DIVU_FITS(d)        (DIVU_WIDE(d) <= 0xFFFFFFFFULL && DIVU_ERROR(d) <= (1ULL << (DIVU_LOG2(d) - 1)))
+
+#define DIVU_FORM(d)        ((uint32_t) (d) == 1 ? DIVU_ONE : DIVU_FITS(d) ? DIVU_SHORT : DIVU_LONG)
+#define DIVU_SHIFT(d)       (DIVU_LOG2(d) - 1)
+#define DIVU_MAGIC(d)       ((uint32_t) (DIVU_FORM(d) == DIVU_SHORT ? DIVU_WIDE(d) \
+                            : ((((1ULL << DIVU_LOG2(d)) - (uint32_t) (d)) << 32) / (uint32_t) (d) + 1)))
+
+#define DIVU32(n, d)        DivideU32((n), DIVU_MAGIC(d), DIVU_SHIFT(d), DIVU_FORM(d))
+
+#define DIVS_ABS(d)         ((d) < 0 ? 0u - (uint32_t) (d) : (uint32_t) (d))
+#define DIVS32(n, d)        DivideS32((n), DIVU_MAGIC(DIVS_ABS(d)), DIVU_SHIFT(DIVS_ABS(d)), DIVU_FORM(DIVS_ABS(d)), (d) < 0)
+
+// Inverse of an odd number modulo 2^64 by Newton's method: d is its own inverse
+// to 3 bits, and each step doubles the bits that are right
+#define DIVX_ODD(d)         ((uint64_t) (d) >> __builtin_ctzll(d))
+#define DIVX_STEP(d, x)     ((x) * (2 - (d) * (x)))
+#define DIVX_INVERSE(d)     DIVX_STEP(d, DIVX_STEP(d, DIVX_STEP(d, DIVX_STEP(d, DIVX_STEP(d, d)))))
+
+#define DIVEXACT64(n, d)    (((uint64_t) (n) >> __builtin_ctzll(d)) * DIVX_INVERSE(DIVX_ODD(d)))
+
+static inline uint32_t DivideU32(uint32_t n, uint32_t magic, unsigned shift, int form)
+    {
+    uint32_t t ;
+
+    if (form == DIVU_ONE) return n ;
+    t = (uint32_t) (((uint64_t) n * magic) >> 32) ;
+    if (form == DIVU_SHORT) return t >> shift ;
+
+    // (n + t) >> 1 without losing the 33rd bit
+    return (t + ((n - t) >> 1)) >> shift ;
+    }
+
+static inline int32_t DivideS32(int32_t n, uint32_t magic, unsigned shift, int form, int negative)
+    {
+    uint32_t magnitude = n < 0 ? 0u - (uint32_t) n : (uint32_t) n ;
+    uint32_t q = DivideU32(magnitude, magic, shift, form) ;
+
+    return (int32_t) ((n < 0) != negative ? 0u - q : q) ;
+    }
+
+#endif
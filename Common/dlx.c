@@ -0,0 +1,223 @@
+/*
+    Algorithm X on dancing links for Sudoku, without recursion or a heap. See dlx.h.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dlx.h"
+
+#define EMPTY               0
+
+// The four nodes of each matrix row follow the headers: cell, row, column, block
+#define ROW_NODE(row)       (1 + DLX_COLUMNS + 4*(row))
+#define NODE_ROW(node)      (((node) - 1 - DLX_COLUMNS) / 4)
+#define CELL_COLUMN(cell)   (1 + (cell))
+#define ROW_COLUMN(r, d)    (1 + DLX_CELLS + 9*(r) + (d))
+#define COL_COLUMN(c, d)    (1 + 2*DLX_CELLS + 9*(c) + (d))
+#define BLK_COLUMN(b, d)    (1 + 3*DLX_CELLS + 9*(b) + (d))
+
+static void                 Cover(DLX *dlx, unsigned column) ;
+static unsigned             Fewest(const DLX *dlx) ;
+static void                 Moved(DLX *dlx, unsigned node, int placed) ;
+static void                 Uncover(DLX *dlx, unsigned column) ;
+
+DLX_RESULT DlxBegin(DLX *dlx, const uint8_t cells[DLX_CELLS], void (*Move)(void *arg, int cell, int digit), void *arg)
+    {
+    DLX_NODE *node = dlx->node ;
+
+    // The root and the headers in one circular list
+    for (unsigned c = 0; c <= DLX_COLUMNS; c++)
+        {
+        node[c].left = c == 0 ? DLX_COLUMNS : c - 1 ;
+        node[c].right = c == DLX_COLUMNS ? 0 : c + 1 ;
+        node[c].up = node[c].down = node[c].column = c ;
+        dlx->size[c] = 0 ;
+        }
+
+    // Each row appended to the bottom of its four columns
+    for (unsigned row = 0; row < DLX_ROWS; row++)
+        {
+        unsigned cell = row / 9, digit = row % 9, r = cell / 9, c = cell % 9 ;
+        unsigned first = ROW_NODE(row) ;
+        unsigned columns[4] =
+            {
+            CELL_COLUMN(cell), ROW_COLUMN(r, digit), COL_COLUMN(c, digit), BLK_COLUMN(3*(r / 3) + c / 3, digit)
+            } ;
+
+        for (unsigned k = 0; k < 4; k++)
+            {
+            unsigned n = first + k, header = columns[k] ;
+
+            node[n].left = first + (k + 3) % 4 ;
+            node[n].right = first + (k + 1) % 4 ;
+            node[n].column = header ;
+            node[n].up = node[header].up ;
+            node[n].down = header ;
+            node[node[header].up].down = n ;
+            node[header].up = n ;
+            dlx->size[header]++ ;
+            }
+        }
+
+    dlx->depth = 0 ;
+    dlx->descend = 1 ;
+    dlx->result = DLX_RUNNING ;
+    dlx->Move = Move ;
+    dlx->arg = arg ;
+
+    // A given whose columns are all still open, then those columns covered
+    for (unsigned cell = 0; cell < DLX_CELLS; cell++)
+        {
+        unsigned first, n ;
+
+        dlx->given[cell] = cells[cell] ;
+        if (cells[cell] == EMPTY) continue ;
+        if (cells[cell] > 9)
+            {
+            dlx->result = DLX_FAILED ;
+            break ;
+            }
+
+        first = ROW_NODE(9*cell + cells[cell] - 1) ;
+        for (n = first; n < first + 4; n++)
+            {
+            unsigned header = node[n].column ;
+
+            if (node[node[header].left].right != header) dlx->result = DLX_FAILED ;
+            }
+        if (dlx->result != DLX_RUNNING) break ;
+        for (n = first; n < first + 4; n++) Cover(dlx, node[n].column) ;
+        }
+
+    dlx->placed = dlx->removed = 0 ;
+    dlx->updates = 0 ;
+    return dlx->result ;
+    }
+
+// Runs the search for up to budget nodes and returns its result so far
+DLX_RESULT DlxStep(DLX *dlx, unsigned budget)
+    {
+    DLX_NODE *node = dlx->node ;
+
+    while (dlx->result == DLX_RUNNING && budget-- > 0)
+        {
+        unsigned row, column, n ;
+
+        if (dlx->descend)
+            {
+            if (node[0].right == 0)
+                {
+                dlx->result = DLX_SOLVED ;
+                break ;
+                }
+
+            column = Fewest(dlx) ;
+            Cover(dlx, column) ;
+            dlx->choice[dlx->depth++] = column ;
+            dlx->descend = 0 ;
+            continue ;
+            }
+
+        // Take back the row that led nowhere and try the next one in its column
+        row = dlx->choice[dlx->depth - 1] ;
+        column = node[row].column ;
+        if (row != column)
+            {
+            for (n = node[row].left; n != row; n = node[n].left) Uncover(dlx, node[n].column) ;
+            Moved(dlx, row, 0) ;
+            }
+
+        row = node[row].down ;
+        if (row == column)
+            {
+            Uncover(dlx, column) ;
+            if (--dlx->depth == 0) dlx->result = DLX_FAILED ;
+            continue ;
+            }
+
+        dlx->choice[dlx->depth - 1] = row ;
+        for (n = node[row].right; n != row; n = node[n].right) Cover(dlx, node[n].column) ;
+        Moved(dlx, row, 1) ;
+        dlx->descend = 1 ;
+        }
+
+    return dlx->result ;
+    }
+
+void DlxSolution(const DLX *dlx, uint8_t cells[DLX_CELLS])
+    {
+    for (unsigned cell = 0; cell < DLX_CELLS; cell++) cells[cell] = dlx->given[cell] ;
+    for (int level = 0; level < dlx->depth; level++)
+        {
+        unsigned n = dlx->choice[level] ;
+
+        if (n > DLX_COLUMNS) cells[NODE_ROW(n) / 9] = NODE_ROW(n) % 9 + 1 ;
+        }
+    }
+
+// Unlinks the column from the headers and its rows from every other column
+static void Cover(DLX *dlx, unsigned column)
+    {
+    DLX_NODE *node = dlx->node ;
+
+    node[node[column].left].right = node[column].right ;
+    node[node[column].right].left = node[column].left ;
+    for (unsigned i = node[column].down; i != column; i = node[i].down)
+        {
+        for (unsigned j = node[i].right; j != i; j = node[j].right)
+            {
+            node[node[j].down].up = node[j].up ;
+            node[node[j].up].down = node[j].down ;
+            dlx->size[node[j].column]-- ;
+            dlx->updates++ ;
+            }
+        }
+    }
+
+// Exactly the reverse of Cover, so the links come back as they were
+static void Uncover(DLX *dlx, unsigned column)
+    {
+    DLX_NODE *node = dlx->node ;
+
+    for (unsigned i = node[column].up; i != column; i = node[i].up)
+        {
+        for (unsigned j = node[i].left; j != i; j = node[j].left)
+            {
+            dlx->size[node[j].column]++ ;
+            node[node[j].down].up = j ;
+            node[node[j].up].down = j ;
+            dlx->updates++ ;
+            }
+        }
+    node[node[column].left].right = column ;
+    node[node[column].right].left = column ;
+    }
+
+// The first open column with the fewest rows, stopping early at one that has
+// none or one
+static unsigned Fewest(const DLX *dlx)
+    {
+    unsigned best = 0, fewest = DLX_ROWS + 1 ;
+
+    for (unsigned c = dlx->node[0].right; c != 0; c = dlx->node[c].right)
+        {
+        if (dlx->size[c] < fewest)
+            {
+            fewest = dlx->size[c] ;
+            best = c ;
+            if (fewest <= 1) break ;
+            }
+        }
+
+    return best ;
+    }
+
+// Counts a row tried or taken back and tells the caller
+static void Moved(DLX *dlx, unsigned node, int placed)
+    {
+    unsigned row = NODE_ROW(node) ;
+
+    if (placed) dlx->placed++ ;
+    else dlx->removed++ ;
+    if (dlx->Move != NULL) (*dlx->Move)(dlx->arg, row / 9, placed ? row % 9 + 1 : EMPTY) ;
+    }
@@ -0,0 +1,72 @@
+/*
+    Sudoku as an exact cover problem, solved by Knuth's Algorithm X on dancing
+    links, a budget of steps at a time:
+
+        static DLX dlx ;
+
+        if (DlxBegin(&dlx, cells, NULL, NULL) == DLX_RUNNING)
+            while (DlxStep(&dlx, 64) == DLX_RUNNING) ... ;
+        DlxSolution(&dlx, cells) ;
+
+    cells[] is the board a cell per byte, row by row, EMPTY (0) or 1 to 9, as
+    GetNibbles (Lab 7) unpacks it. Each of the 729 rows of the matrix puts one digit
+    in one cell and covers four of its 324 columns: the cell, and the digit in its
+    row, its column and its block. A solution is 81 rows that cover every column
+    exactly once.
+
+    All of it lives in the DLX structure, about 33 KB: one node per column header
+    and four per matrix row, linked by 16-bit indexes, and the row chosen at each
+    level of the search in place of the recursion. There is no heap and the stack
+    use does not depend on the puzzle. DlxBegin links the whole matrix and then
+    selects the givens, so the search starts from the columns they leave open.
+
+    Each step of DlxStep is one node of the search tree: cover the open column with
+    the fewest rows, or take back the row tried in the newest column and try the
+    next one. If Move is not NULL, it is called with the cell and digit of every
+    row tried and with EMPTY for every row taken back, in order, so a caller can
+    keep a board or a display in step with the search.
+*/
+
+#ifndef __DLX_H
+#define __DLX_H
+
+#include <stdint.h>
+
+#define DLX_CELLS           81
+#define DLX_COLUMNS         324             // 4 constraints x 81
+#define DLX_ROWS            729             // 9 digits x 81 cells
+#define DLX_NODES           (1 + DLX_COLUMNS + 4*DLX_ROWS)  // the root is node 0
+
+typedef enum {DLX_RUNNING, DLX_SOLVED, DLX_FAILED} DLX_RESULT ;
+
+typedef struct
+    {
+    uint16_t                left, right ;
+    uint16_t                up, down ;
+    uint16_t                column ;        // its header; a header's is itself
+    } DLX_NODE ;
+
+typedef struct
+    {
+    DLX_NODE                node[DLX_NODES] ;
+    uint16_t                size[1 + DLX_COLUMNS] ;     // rows still in each column
+    uint16_t                choice[DLX_CELLS] ;         // row node tried at each level, or its column
+    uint8_t                 given[DLX_CELLS] ;
+    int                     depth ;
+    int                     descend ;       // cover a column next, else try the next row
+    DLX_RESULT              result ;
+    unsigned                placed ;        // rows tried
+    unsigned                removed ;       // rows taken back
+    unsigned long           updates ;       // links changed by cover and uncover
+    void                    (*Move)(void *arg, int cell, int digit) ;
+    void *                  arg ;
+    } DLX ;
+
+// DLX_FAILED if two givens share a row, column or block
+DLX_RESULT                  DlxBegin(DLX *dlx, const uint8_t cells[DLX_CELLS], void (*Move)(void *arg, int cell, int digit), void *arg) ;
+DLX_RESULT                  DlxStep(DLX *dlx, unsigned budget) ;
+
+// The givens and the rows chosen so far, the whole board once DLX_SOLVED
+void                        DlxSolution(const DLX *dlx, uint8_t cells[DLX_CELLS]) ;
+
+#endif
@@ -0,0 +1,128 @@
+/*
+    Interrupt-driven touch screen and push button events. See events.h.
+*/
+
+#include <stdint.h>
+#include "library.h"
+#include "touch.h"
+#include "timers.h"
+#include "tasks.h"
+#include "events.h"
+#include "interrupts.h"
+
+typedef struct
+    {
+    int                     state ;         // debounced: 1 = down
+    int                     count ;         // samples in a row that disagree with state
+    } DEBOUNCE ;
+
+static int                  Debounce(DEBOUNCE *input, int sample) ;
+static void                 EventTick(void) ;
+static void                 Post(EVENT_TYPE type, int x, int y) ;
+
+static EVENT                queue[EVENT_QUEUE] ;
+static volatile unsigned    head = 0 ;      // written only by the interrupt
+static volatile unsigned    tail = 0 ;      // written only by the main program
+static unsigned             countdown = EVENT_SAMPLE_MS ;
+static DEBOUNCE             touch, button ;
+static int                  touch_x, touch_y ;
+
+void EventInitialize(void)
+    {
+    head = tail = 0 ;
+    countdown = EVENT_SAMPLE_MS ;
+    touch.state = touch.count = 0 ;
+    button.state = button.count = 0 ;
+
+    TimerInitialize() ;
+    TimerHook(EventTick) ;
+    }
+
+int EventPoll(EVENT *event)
+    {
+    unsigned next = tail ;
+
+    InterruptWindow() ;
+    if (next == head) return 0 ;
+    *event = queue[next % EVENT_QUEUE] ;
+    tail = next + 1 ;
+    return 1 ;
+    }
+
+// Timers and tasks keep running while the program waits
+void EventWait(EVENT *event)
+    {
+    while (!EventPoll(event)) TaskIdle() ;
+    }
+
+// Called from the timer interrupt on every tick
+static void EventTick(void)
+    {
+    int down, x, y ;
+
+    if (--countdown != 0) return ;
+    countdown = EVENT_SAMPLE_MS ;
+
+    down = TS_Touched() ;
+    x = down ? TS_GetX() : touch_x ;
+    y = down ? TS_GetY() : touch_y ;
+    if (Debounce(&touch, down))
+        {
+        touch_x = x ;
+        touch_y = y ;
+        Post(down ? EVENT_TOUCH_DOWN : EVENT_TOUCH_UP, x, y) ;
+        }
+    else if (touch.state && down)
+        {
+        int dx = x - touch_x, dy = y - touch_y ;
+
+        if (dx >= EVENT_DRAG_PIXELS || -dx >= EVENT_DRAG_PIXELS || dy >= EVENT_DRAG_PIXELS || -dy >= EVENT_DRAG_PIXELS)
+            {
+            touch_x = x ;
+            touch_y = y ;
+            Post(EVENT_TOUCH_DRAG, x, y) ;
+            }
+        }
+
+    down = PushButtonPressed() != 0 ;
+    if (Debounce(&button, down)) Post(down ? EVENT_BUTTON_DOWN : EVENT_BUTTON_UP, 0, 0) ;
+    }
+
+// Returns 1 when sample has disagreed with the debounced state long enough to replace it
+static int Debounce(DEBOUNCE *input, int sample)
+    {
+    if (sample == input->state)
+        {
+        input->count = 0 ;
+        return 0 ;
+        }
+    if (++input->count < EVENT_DEBOUNCE) return 0 ;
+
+    input->state = sample ;
+    input->count = 0 ;
+    return 1 ;
+    }
+
+static void Post(EVENT_TYPE type, int x, int y)
+    {
+    unsigned next = head ;
+    EVENT *event ;
+
+    if (next - tail < EVENT_QUEUE)
+        {
+        event = &queue[next % EVENT_QUEUE] ;
+        event->type = type ;
+        event->x = x ;
+        event->y = y ;
+        event->msec = TimerClock() ;
+        head = next + 1 ;
+        return ;
+        }
+
+    // Full: a drag just moves the newest drag (the reader is at the oldest entry)
+    event = &queue[(next - 1) % EVENT_QUEUE] ;
+    if (type != EVENT_TOUCH_DRAG || event->type != EVENT_TOUCH_DRAG) return ;
+    event->x = x ;
+    event->y = y ;
+    event->msec = TimerClock() ;
+    }
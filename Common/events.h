@@ -0,0 +1,65 @@
+/*
+    Touch screen and push button events, collected by the 1 kHz timer interrupt so that
+    a main loop can sleep until there is something to do instead of polling:
+
+        EventInitialize() ;
+        for (;;)
+            {
+            EVENT event ;
+
+            EventWait(&event) ;
+            if (event.type == EVENT_TOUCH_DOWN) ...
+            }
+
+    Every EVENT_SAMPLE_MS the interrupt samples TS_Touched() and PushButtonPressed();
+    a change is believed once it has held for EVENT_DEBOUNCE samples in a row. While
+    the screen is touched, a move of EVENT_DRAG_PIXELS or more in x or y posts a drag.
+    Events carry the touch position as TS_GetX()/TS_GetY() returned it and the
+    TimerClock() time in milliseconds.
+
+    After EventInitialize() the interrupt owns the touch screen and the button: the
+    program must not call TS_Touched(), TS_GetX(), TS_GetY() or PushButtonPressed()
+    itself, since the touch controller is read over I2C and cannot be shared.
+
+    The queue holds EVENT_QUEUE events. When it is full, a drag replaces the drag
+    behind it and anything else is dropped.
+
+    The interrupt is the tick of timers.h. While EventWait() waits, it makes the
+    timer callbacks and runs the tasks of tasks.h, and sleeps in WFI when there are
+    none. On the host the tick is simulated (see Host.h), so a scripted run delivers
+    the same events at the same times on every run.
+*/
+
+#ifndef __EVENTS_H
+#define __EVENTS_H
+
+#include <stdint.h>
+
+#define EVENT_QUEUE         16
+#define EVENT_SAMPLE_MS     10
+#define EVENT_DEBOUNCE      2
+#define EVENT_DRAG_PIXELS   4
+
+typedef enum
+    {
+    EVENT_NONE = 0,
+    EVENT_TOUCH_DOWN,
+    EVENT_TOUCH_DRAG,
+    EVENT_TOUCH_UP,
+    EVENT_BUTTON_DOWN,
+    EVENT_BUTTON_UP
+    } EVENT_TYPE ;
+
+typedef struct
+    {
+    EVENT_TYPE              type ;
+    int                     x ;             // touch events only
+    int                     y ;
+    uint32_t                msec ;          // TimerClock() when the event was posted
+    } EVENT ;
+
+void                        EventInitialize(void) ;
+int                         EventPoll(EVENT *event) ;
+void                        EventWait(EVENT *event) ;
+
+#endif
@@ -0,0 +1,259 @@
+/*
+    Integer-only string formatting for the lab user interfaces. See format.h.
+*/
+
+#include <stdint.h>
+#include <stdarg.h>
+#include "format.h"
+#include "divide.h"
+
+typedef struct
+    {
+    char *                  next ;
+    char *                  last ;          // room for the '\0' is kept past this
+    } OUTPUT ;
+
+#define FLAG_LEFT           (1 << 0)
+#define FLAG_ZERO           (1 << 1)
+#define FLAG_PLUS           (1 << 2)
+#define FLAG_SPACE          (1 << 3)
+
+#define DIGITS_MAX          24              // 2^64 has 20 digits; room for '.' and a 0
+
+static char *               Decimal(char *end, uint64_t value) ;
+static uint32_t             Div10(uint32_t dividend) ;
+static void                 Field(OUTPUT *out, char sign, const char *body, int length, int width, int flags) ;
+static char *               Hexadecimal(char *end, uint64_t value, const char *digits) ;
+static uint32_t             Mul10(uint32_t multiplicand) ;
+static void                 Put(OUTPUT *out, char c) ;
+
+int FormatString(char *text, unsigned size, const char *format, ...)
+    {
+    va_list args ;
+    int length ;
+
+    va_start(args, format) ;
+    length = FormatList(text, size, format, args) ;
+    va_end(args) ;
+    return length ;
+    }
+
+int FormatList(char *text, unsigned size, const char *format, va_list args)
+    {
+    char digits[DIGITS_MAX], *end = digits + DIGITS_MAX, *body ;
+    int flags, width, precision, longs ;
+    int64_t svalue ;
+    uint64_t uvalue ;
+    OUTPUT out ;
+    char sign ;
+
+    if (size == 0) return 0 ;
+    out.next = text ;
+    out.last = text + size - 1 ;
+
+    for (; *format != '\0'; format++)
+        {
+        if (*format != '%')
+            {
+            Put(&out, *format) ;
+            continue ;
+            }
+
+        flags = 0 ;
+        for (;;)
+            {
+            switch (*++format)
+                {
+                case '-':   flags |= FLAG_LEFT ;    continue ;
+                case '0':   flags |= FLAG_ZERO ;    continue ;
+                case '+':   flags |= FLAG_PLUS ;    continue ;
+                case ' ':   flags |= FLAG_SPACE ;   continue ;
+                }
+            break ;
+            }
+
+        width = 0 ;
+        if (*format == '*')
+            {
+            width = va_arg(args, int) ;
+            format++ ;
+            }
+        else while (*format >= '0' && *format <= '9') width = Mul10(width) + (*format++ - '0') ;
+
+        precision = -1 ;
+        if (*format == '.')
+            {
+            precision = 0 ;
+            while (*++format >= '0' && *format <= '9') precision = Mul10(precision) + (*format - '0') ;
+            }
+
+        for (longs = 0; *format == 'l'; format++) longs++ ;
+
+        sign = '\0' ;
+        switch (*format)
+            {
+            case 'd':
+            case 'i':
+            case 'q':
+                if (longs == 0)         svalue = va_arg(args, int) ;
+                else if (longs == 1)    svalue = va_arg(args, long) ;
+                else                    svalue = va_arg(args, long long) ;
+
+                if (svalue < 0) sign = '-' ;
+                else if (flags & FLAG_PLUS) sign = '+' ;
+                else if (flags & FLAG_SPACE) sign = ' ' ;
+                uvalue = (svalue < 0) ? -(uint64_t) svalue : (uint64_t) svalue ;
+
+                body = Decimal(end, uvalue) ;
+                if (*format == 'q' && precision > 0)
+                    {
+                    char *point ;
+
+                    while (end - body <= precision && body > digits + 1) *--body = '0' ;
+                    for (point = body - 1; point < end - precision - 1; point++) point[0] = point[1] ;
+                    *point = '.' ;
+                    body-- ;
+                    }
+                Field(&out, sign, body, end - body, width, flags) ;
+                break ;
+
+            case 'u':
+            case 'x':
+            case 'X':
+                if (longs == 0)         uvalue = va_arg(args, unsigned) ;
+                else if (longs == 1)    uvalue = va_arg(args, unsigned long) ;
+                else                    uvalue = va_arg(args, unsigned long long) ;
+
+                if (*format == 'u')         body = Decimal(end, uvalue) ;
+                else if (*format == 'x')    body = Hexadecimal(end, uvalue, "0123456789abcdef") ;
+                else                        body = Hexadecimal(end, uvalue, "0123456789ABCDEF") ;
+                Field(&out, '\0', body, end - body, width, flags) ;
+                break ;
+
+            case 'c':
+                digits[0] = (char) va_arg(args, int) ;
+                Field(&out, '\0', digits, 1, width, flags & ~FLAG_ZERO) ;
+                break ;
+
+            case 's':
+                {
+                const char *string = va_arg(args, const char *) ;
+                int length = 0 ;
+
+                if (string == 0) string = "(null)" ;
+                while (string[length] != '\0' && (precision < 0 || length < precision)) length++ ;
+                Field(&out, '\0', string, length, width, flags & ~FLAG_ZERO) ;
+                break ;
+                }
+
+            case '%':
+                Put(&out, '%') ;
+                break ;
+
+            case '\0':
+                format-- ;
+                break ;
+
+            default:
+                Put(&out, '%') ;
+                Put(&out, *format) ;
+                break ;
+            }
+        }
+
+    *out.next = '\0' ;
+    return out.next - text ;
+    }
+
+char *FormatEngineering(char *text, uint64_t value, int width, int *group)
+    {
+    char digits[DIGITS_MAX], *end = digits + DIGITS_MAX, *body ;
+    int length, whole, count ;
+
+    body = Decimal(end, value) ;
+    length = end - body ;
+
+    // (length - 1)/3 as a multiply and shift, exact for the 20 digits of 2^64
+    *group = ((length - 1) * 11) >> 5 ;
+    whole = length - 3 * *group ;
+
+    for (count = 0; count < whole; count++) *text++ = *body++ ;
+    if (*group > 0 && count + 1 < width)
+        {
+        *text++ = '.' ;
+        for (count++; count < width; count++) *text++ = *body++ ;
+        }
+
+    *text = '\0' ;
+    return text ;
+    }
+
+// Digits of value written backwards so they end just before end
+static char *Decimal(char *end, uint64_t value)
+    {
+    uint32_t low ;
+
+    // While the value needs 64 bits, divide each half by 10 and recombine:
+    // (10*qh + rh)*2^32 + 10*ql + rl = 10*(qh*2^32 + rh*429496729 + ql) + 6*rh + rl
+    while ((value >> 32) != 0)
+        {
+        uint32_t hi = (uint32_t) (value >> 32) ;
+        uint32_t lo = (uint32_t) value ;
+        uint32_t qh = Div10(hi), rh = hi - Mul10(qh) ;
+        uint32_t ql = Div10(lo), rl = lo - Mul10(ql) ;
+        uint32_t carry = 6*rh + rl ;
+        uint32_t qc = Div10(carry) ;
+
+        *--end = '0' + (carry - Mul10(qc)) ;
+        value = ((uint64_t) qh << 32) + (uint64_t) rh * 429496729U + ql + qc ;
+        }
+
+    low = (uint32_t) value ;
+    do
+        {
+        uint32_t quotient = Div10(low) ;
+
+        *--end = '0' + (low - Mul10(quotient)) ;
+        low = quotient ;
+        } while (low != 0) ;
+
+    return end ;
+    }
+
+static char *Hexadecimal(char *end, uint64_t value, const char *digits)
+    {
+    do
+        {
+        *--end = digits[value & 0xF] ;
+        value >>= 4 ;
+        } while (value != 0) ;
+
+    return end ;
+    }
+
+static void Field(OUTPUT *out, char sign, const char *body, int length, int width, int flags)
+    {
+    int padding = width - length - (sign != '\0') ;
+
+    if (!(flags & (FLAG_LEFT | FLAG_ZERO))) while (padding-- > 0) Put(out, ' ') ;
+    if (sign != '\0') Put(out, sign) ;
+    if ((flags & (FLAG_LEFT | FLAG_ZERO)) == FLAG_ZERO) while (padding-- > 0) Put(out, '0') ;
+    while (length-- > 0) Put(out, *body++) ;
+    while (padding-- > 0) Put(out, ' ') ;
+    }
+
+static void Put(OUTPUT *out, char c)
+    {
+    if (out->next < out->last) *out->next++ = c ;
+    }
+
+// Same reciprocal multiply as Div32X10 in Lab8C-Resistors.s: UMULL, then LSR #3
+static uint32_t Div10(uint32_t dividend)
+    {
+    return DIVU32(dividend, 10) ;
+    }
+
+static uint32_t Mul10(uint32_t multiplicand)
+    {
+    return (multiplicand << 3) + (multiplicand << 1) ;
+    }
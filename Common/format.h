@@ -0,0 +1,31 @@
+/*
+    Integer-only replacement for the sprintf/vsprintf calls in the lab user interfaces.
+    Nothing here touches floating point, so it pulls neither soft-float double nor
+    newlib's printf into the image. Digits come from the same multiply-by-reciprocal
+    divide as Div32X10 (a UMULL and a shift) instead of a division instruction.
+
+    Conversions: %[-+0][width][.precision][l|ll](d|i|u|x|X|c|s|q|%)
+
+        %q      a fixed-point integer with precision implied decimal places, so
+                FormatString(text, sizeof(text), "%5.1q", 253) gives " 25.3"
+        .N      on %s, at most N characters; on %d/%u/%x, ignored
+
+    Like snprintf, the output is always '\0' terminated and cut off to fit in size
+    bytes; the return value is the number of characters stored.
+*/
+
+#ifndef __FORMAT_H
+#define __FORMAT_H
+
+#include <stdint.h>
+#include <stdarg.h>
+
+int                         FormatString(char *text, unsigned size, const char *format, ...) ;
+int                         FormatList(char *text, unsigned size, const char *format, va_list args) ;
+
+// Writes value / 1000^group with the decimal point placed, cut off (not rounded)
+// to at most width characters and never ending in '.'; group is the largest power
+// of 1000 not above value. Returns a pointer to the terminating '\0'.
+char *                      FormatEngineering(char *text, uint64_t value, int width, int *group) ;
+
+#endif
@@ -0,0 +1,129 @@
+/*
+    Glyph cache and word-wide text blitter. See glyphs.h.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "graphics.h"
+#include "glyphs.h"
+
+#define FRAME               ((uint32_t *) 0xD0000000)
+
+typedef struct _tFont
+    {
+    const uint8_t *         table ;
+    const uint16_t          Width ;
+    const uint16_t          Height ;
+    } sFONT ;
+
+typedef struct
+    {
+    const sFONT *           font ;          // 0 = empty
+    uint32_t                foreground ;
+    uint32_t                background ;
+    uint32_t *              cell ;          // Width x Height words in the pool
+    char                    c ;
+    } GLYPH ;
+
+extern sFONT *              BSP_LCD_GetFont(void) ;
+
+static uint32_t *           Expand(const sFONT *font, uint32_t foreground, uint32_t background, char c) ;
+static uint32_t *           Lookup(const sFONT *font, uint32_t foreground, uint32_t background, char c) ;
+
+static uint32_t             pool[GLYPH_POOL_WORDS] ;
+static unsigned             used = 0 ;
+static GLYPH                entries[GLYPH_ENTRIES] ;
+
+void GlyphChar(unsigned x, unsigned y, char c)
+    {
+    const sFONT *font = BSP_LCD_GetFont() ;
+    const uint32_t *src ;
+    uint32_t *dst ;
+    unsigned width, rows ;
+
+    if (x >= XPIXELS || y >= YPIXELS) return ;
+    width = (x + font->Width <= XPIXELS) ? font->Width : XPIXELS - x ;
+    rows = (y + font->Height <= YPIXELS) ? font->Height : YPIXELS - y ;
+
+    src = Lookup(font, GetForeground(), GetBackground(), c) ;
+    dst = FRAME + x + XPIXELS*y ;
+    for (unsigned row = 0; row < rows; row++, src += font->Width, dst += XPIXELS)
+        {
+        const uint32_t *s = src ;
+        uint32_t *d = dst ;
+        unsigned words = width ;
+
+        // Pairs of words, which the compiler turns into LDRD/STRD
+        for (; words >= 2; words -= 2, s += 2, d += 2)
+            {
+            d[0] = s[0] ;
+            d[1] = s[1] ;
+            }
+        if (words != 0) *d = *s ;
+        }
+    }
+
+void GlyphString(unsigned x, unsigned y, const char *text)
+    {
+    const sFONT *font = BSP_LCD_GetFont() ;
+
+    while (*text != '\0' && x + font->Width <= XPIXELS)
+        {
+        GlyphChar(x, y, *text++) ;
+        x += font->Width ;
+        }
+    }
+
+void GlyphFlush(void)
+    {
+    memset(entries, 0, sizeof(entries)) ;
+    used = 0 ;
+    }
+
+static uint32_t *Lookup(const sFONT *font, uint32_t foreground, uint32_t background, char c)
+    {
+    uint32_t hash = (uint32_t) (uintptr_t) font ^ foreground ^ (background << 1) ;
+    GLYPH *glyph ;
+
+    if (c < ' ' || c > '~') c = ' ' ;
+
+    // Fold the key down and add the character last, so one font and color pair
+    // spreads its 95 characters over 95 consecutive entries
+    hash ^= hash >> 16 ;
+    hash ^= hash >> 8 ;
+    glyph = &entries[(hash + c) & (GLYPH_ENTRIES - 1)] ;
+
+    if (glyph->font == font && glyph->c == c
+        && glyph->foreground == foreground && glyph->background == background)
+        {
+        return glyph->cell ;
+        }
+
+    if (used + font->Width*font->Height > GLYPH_POOL_WORDS) GlyphFlush() ;
+
+    glyph->font = font ;
+    glyph->foreground = foreground ;
+    glyph->background = background ;
+    glyph->c = c ;
+    glyph->cell = Expand(font, foreground, background, c) ;
+    return glyph->cell ;
+    }
+
+// Same bit order as DisplayChar: (Width + 7)/8 bytes per row, leftmost pixel in bit 7
+static uint32_t *Expand(const sFONT *font, uint32_t foreground, uint32_t background, char c)
+    {
+    unsigned bytes = (font->Width + 7) / 8 ;
+    const uint8_t *bits = font->table + (c - ' ') * font->Height * bytes ;
+    uint32_t *cell = pool + used ;
+    uint32_t *px = cell ;
+
+    for (unsigned row = 0; row < font->Height; row++, bits += bytes)
+        {
+        for (unsigned col = 0; col < font->Width; col++)
+            {
+            *px++ = ((bits[col / 8] << (col % 8)) & 0x80) ? foreground : background ;
+            }
+        }
+    used += font->Width*font->Height ;
+    return cell ;
+    }
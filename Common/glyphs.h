@@ -0,0 +1,38 @@
+/*
+    Glyph cache and word-wide text blitter for text that is redrawn often: status
+    lines, report lines, counters and the Sudoku digits.
+
+        SetForeground(COLOR_BLACK) ;
+        SetBackground(COLOR_WHITE) ;
+        GlyphString(x, y, "Total Moves: 12") ;      // same pixels as DisplayStringAt
+
+    DisplayChar() tests one font bit per pixel and writes each pixel through
+    DrawPixel(). The first time a character is drawn in a given font, foreground
+    and background, GlyphChar() expands its bitmap into a cell of ARGB words; from
+    then on each row of the character is a straight copy of Width words into the
+    frame buffer at 0xD0000000, two at a time, as FillCell does with STRD.
+
+    The cells live in a pool of GLYPH_POOL_WORDS words. A character takes Width x
+    Height words (84 in Font12, 176 in Font16, 408 in Font24). When the pool is full
+    it is emptied and refilled by the characters that are drawn next. The index has
+    GLYPH_ENTRIES entries; consecutive characters of one font and color pair never
+    share an entry, so a line of text does not evict itself.
+
+    GlyphChar() and GlyphString() draw in the current font and colors and clip
+    exactly as DisplayChar() and DisplayStringAt() do. GlyphFlush() empties the
+    cache; a program only needs it if it changes a font table at run time.
+*/
+
+#ifndef __GLYPHS_H
+#define __GLYPHS_H
+
+#include <stdint.h>
+
+#define GLYPH_POOL_WORDS    8192            // 32 KB
+#define GLYPH_ENTRIES       128             // a power of two, at least 95
+
+void                        GlyphChar(unsigned x, unsigned y, char c) ;
+void                        GlyphString(unsigned x, unsigned y, const char *text) ;
+void                        GlyphFlush(void) ;
+
+#endif
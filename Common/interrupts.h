@@ -0,0 +1,21 @@
+/*
+    Where the interrupt-driven modules (timers.c, events.c) sleep and where they
+    let interrupts in. On the board an interrupt can come at any instruction, so
+    InterruptWindow() is nothing and WaitForInterrupt() is WFI. The host can only
+    take its simulated interrupts when the program calls into it (see Host.h), so
+    both call the host library instead.
+*/
+
+#ifndef __INTERRUPTS_H
+#define __INTERRUPTS_H
+
+#ifdef __arm__
+#define WaitForInterrupt()  __asm volatile ("wfi")
+#define InterruptWindow()
+#else
+#include "Host.h"
+#define WaitForInterrupt()  HostWaitForInterrupt()
+#define InterruptWindow()   HostPoll()
+#endif
+
+#endif
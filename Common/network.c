@@ -0,0 +1,304 @@
+/*
+    Resistor network search over the standard E-series values. See network.h.
+*/
+
+#include <stdint.h>
+#include "network.h"
+#include "divide.h"
+
+#define E12_PARTS           (12*NETWORK_DECADES)
+#define E24_PARTS           (24*NETWORK_DECADES)
+#define E96_PARTS           (96*NETWORK_DECADES)
+
+typedef struct
+    {
+    const uint32_t *        part ;
+    unsigned                parts ;
+    uint32_t                target ;
+    NETWORK *               best ;
+    } SEARCH ;
+
+typedef struct
+    {
+    const uint16_t *        significands ;  // first decade, in hundredths of an ohm / scale
+    unsigned                count ;
+    unsigned                scale ;         // 10 for two-digit series, 1 for three
+    uint32_t *              parts ;
+    } TABLE ;
+
+static unsigned             Bracket(const uint32_t *part, unsigned lo, unsigned hi, uint32_t x) ;
+static void                 Consider(SEARCH *s, NETWORK_SHAPE shape, uint32_t a, uint32_t b, uint32_t c) ;
+static uint32_t             Ideal(uint32_t a, uint32_t goal) ;
+static uint32_t             Mul10(uint32_t multiplicand) ;
+static uint32_t             Parallel(uint32_t a, uint32_t b) ;
+static void                 ParallelPairs(SEARCH *s, NETWORK_SHAPE shape, uint32_t a, uint32_t goal, unsigned lo) ;
+static void                 SeriesPairs(SEARCH *s, NETWORK_SHAPE shape, uint32_t a, uint32_t goal, unsigned lo) ;
+static int                  Within(const NETWORK *net, uint32_t target, uint32_t ppm) ;
+
+static const uint16_t       e12[] =
+    {
+    10, 12, 15, 18, 22, 27, 33, 39, 47, 56, 68, 82
+    } ;
+
+static const uint16_t       e24[] =
+    {
+    10, 11, 12, 13, 15, 16, 18, 20, 22, 24, 27, 30, 33, 36, 39, 43, 47, 51, 56, 62, 68, 75, 82, 91
+    } ;
+
+static const uint16_t       e96[] =
+    {
+    100, 102, 105, 107, 110, 113, 115, 118, 121, 124, 127, 130, 133, 137, 140, 143,
+    147, 150, 154, 158, 162, 165, 169, 174, 178, 182, 187, 191, 196, 200, 205, 210,
+    215, 221, 226, 232, 237, 243, 249, 255, 261, 267, 274, 280, 287, 294, 301, 309,
+    316, 324, 332, 340, 348, 357, 365, 374, 383, 392, 402, 412, 422, 432, 442, 453,
+    464, 475, 487, 499, 511, 523, 536, 549, 562, 576, 590, 604, 619, 634, 649, 665,
+    681, 698, 715, 732, 750, 768, 787, 806, 825, 845, 866, 887, 909, 931, 953, 976
+    } ;
+
+static uint32_t             e12_parts[E12_PARTS] ;
+static uint32_t             e24_parts[E24_PARTS] ;
+static uint32_t             e96_parts[E96_PARTS] ;
+
+static TABLE                tables[] =
+    {
+    {e12, sizeof(e12)/sizeof(e12[0]), 10, e12_parts},
+    {e24, sizeof(e24)/sizeof(e24[0]), 10, e24_parts},
+    {e96, sizeof(e96)/sizeof(e96[0]),  1, e96_parts}
+    } ;
+
+static const char *         names[] =
+    {
+    "R", "R + R", "R || R", "R + R + R", "R || R || R", "R + (R || R)", "R || (R + R)"
+    } ;
+
+int NetworkSearch(NETWORK_SERIES series, uint32_t target, uint32_t ppm, unsigned maxParts, NETWORK *best)
+    {
+    SEARCH search, *s = &search ;
+    unsigned n, lo ;
+
+    s->part = NetworkParts(series, &n) ;
+    s->parts = n ;
+    s->target = target ;
+    s->best = best ;
+    best->parts = 0 ;
+    best->error = UINT32_MAX ;
+
+    // One part: the two either side of the target
+    lo = Bracket(s->part, 0, n, target) ;
+    if (lo < n) Consider(s, NETWORK_ONE, s->part[lo], 0, 0) ;
+    if (lo > 0) Consider(s, NETWORK_ONE, s->part[lo - 1], 0, 0) ;
+    if (maxParts < 2 || Within(best, target, ppm)) return Within(best, target, ppm) ;
+
+    // Two parts
+    SeriesPairs(s, NETWORK_SERIES2, 0, target, 0) ;
+    ParallelPairs(s, NETWORK_PARALLEL2, 0, target, 0) ;
+    if (maxParts < 3 || Within(best, target, ppm)) return Within(best, target, ppm) ;
+
+    // Three parts, a <= b <= c where the shape allows: a + b + c >= 3a
+    for (unsigned i = 0; i < n && best->error != 0; i++)
+        {
+        uint32_t a = s->part[i] ;
+
+        if (a >= target || 3ULL*a > (uint64_t) target + best->error) break ;
+        SeriesPairs(s, NETWORK_SERIES3, a, target - a, i) ;
+        }
+
+    // a || b || c lies between a/3 and a; below the target, the largest b and c
+    for (unsigned i = lo > 0 ? lo - 1 : 0; i < n && best->error != 0; i++)
+        {
+        uint32_t a = s->part[i] ;
+
+        if (a > 3ULL*((uint64_t) target + best->error)) break ;
+        if (a <= target) Consider(s, NETWORK_PARALLEL3, a, s->part[n - 1], s->part[n - 1]) ;
+        else ParallelPairs(s, NETWORK_PARALLEL3, a, Ideal(a, target), i) ;
+        }
+
+    // a + (b || c): a below the target, any b and c
+    for (unsigned i = 0; i < n && s->part[i] < target && best->error != 0; i++)
+        {
+        ParallelPairs(s, NETWORK_SERIES_PARALLEL, s->part[i], target - s->part[i], 0) ;
+        }
+
+    // a || (b + c): a above the target, b + c = a x target / (a - target)
+    for (unsigned i = lo; i < n && best->error != 0; i++)
+        {
+        uint32_t a = s->part[i] ;
+
+        if (a > target) SeriesPairs(s, NETWORK_PARALLEL_SERIES, a, Ideal(a, target), 0) ;
+        }
+
+    return Within(best, target, ppm) ;
+    }
+
+const uint32_t *NetworkParts(NETWORK_SERIES series, unsigned *count)
+    {
+    TABLE *table = &tables[series] ;
+
+    // Each decade is ten times the one before it
+    if (table->parts[0] == 0)
+        {
+        uint32_t *part = table->parts ;
+
+        for (unsigned k = 0; k < table->count; k++) *part++ = table->significands[k] * table->scale ;
+        for (unsigned k = table->count; k < NETWORK_DECADES*table->count; k++, part++)
+            {
+            *part = Mul10(part[-(int) table->count]) ;
+            }
+        }
+
+    *count = NETWORK_DECADES*table->count ;
+    return table->parts ;
+    }
+
+int NetworkBands(uint32_t value, unsigned ndigits, uint8_t digits[], int *exponent)
+    {
+    uint32_t limit = 1 ;
+    int shift = 0 ;
+
+    if (value == 0) return 0 ;
+    for (unsigned k = 0; k < ndigits; k++) limit = Mul10(limit) ;
+
+    // Take off trailing zeros until the significand fits in ndigits
+    while (value >= limit)
+        {
+        uint32_t quotient = DIVU32(value, 10) ;
+
+        if (value != Mul10(quotient)) return 0 ;
+        value = quotient ;
+        shift++ ;
+        }
+    // ... and pad it out to ndigits
+    while (Mul10(value) < limit)
+        {
+        value = Mul10(value) ;
+        shift-- ;
+        }
+
+    for (int k = ndigits - 1; k >= 0; k--)
+        {
+        uint32_t quotient = DIVU32(value, 10) ;
+
+        digits[k] = value - Mul10(quotient) ;
+        value = quotient ;
+        }
+    *exponent = shift - 2 ;                 // hundredths of an ohm
+    return 1 ;
+    }
+
+const char *NetworkShapeName(NETWORK_SHAPE shape)
+    {
+    return names[shape] ;
+    }
+
+// Pairs b <= c from part[lo..] with b + c near goal, each found by a binary
+// search for c; b past goal/2 only takes the sum further above it
+static void SeriesPairs(SEARCH *s, NETWORK_SHAPE shape, uint32_t a, uint32_t goal, unsigned lo)
+    {
+    for (unsigned i = lo; i < s->parts && s->best->error != 0; i++)
+        {
+        uint32_t b = s->part[i] ;
+        unsigned j = Bracket(s->part, i, s->parts, goal > b ? goal - b : 0) ;
+
+        if (j < s->parts) Consider(s, shape, a, b, s->part[j]) ;
+        if (j > i) Consider(s, shape, a, b, s->part[j - 1]) ;
+        if (2ULL*b >= goal) break ;
+        }
+    }
+
+// Pairs b <= c from part[lo..] with b || c near goal: b || c is below b and at
+// least b/2, so b runs from just under goal to 2 x goal
+static void ParallelPairs(SEARCH *s, NETWORK_SHAPE shape, uint32_t a, uint32_t goal, unsigned lo)
+    {
+    unsigned first = Bracket(s->part, lo, s->parts, goal) ;
+
+    for (unsigned i = first > lo ? first - 1 : lo; i < s->parts && s->best->error != 0; i++)
+        {
+        uint32_t b = s->part[i] ;
+        unsigned j = Bracket(s->part, i, s->parts, Ideal(b, goal)) ;
+
+        if (j < s->parts) Consider(s, shape, a, b, s->part[j]) ;
+        if (j > i) Consider(s, shape, a, b, s->part[j - 1]) ;
+        if (b / 2 >= goal) break ;
+        }
+    }
+
+static void Consider(SEARCH *s, NETWORK_SHAPE shape, uint32_t a, uint32_t b, uint32_t c)
+    {
+    NETWORK *best = s->best ;
+    uint64_t value, error ;
+
+    switch (shape)
+        {
+        case NETWORK_ONE:               value = a ; break ;
+        case NETWORK_SERIES2:           value = (uint64_t) b + c ; break ;
+        case NETWORK_PARALLEL2:         value = Parallel(b, c) ; break ;
+        case NETWORK_SERIES3:           value = (uint64_t) a + b + c ; break ;
+        case NETWORK_PARALLEL3:         value = Parallel(Parallel(a, b), c) ; break ;
+        case NETWORK_SERIES_PARALLEL:   value = (uint64_t) a + Parallel(b, c) ; break ;
+        default:                        value = Parallel(a, b + c) ; break ;
+        }
+
+    // Sums past UINT32_MAX are never the closest: a single part is nearer
+    if (value > UINT32_MAX) return ;
+    error = value > s->target ? value - s->target : s->target - value ;
+    if (error >= best->error) return ;
+
+    best->shape = shape ;
+    best->value = (uint32_t) value ;
+    best->error = (uint32_t) error ;
+    if (shape == NETWORK_SERIES2 || shape == NETWORK_PARALLEL2)
+        {
+        best->parts = 2 ;
+        best->part[0] = b ;
+        best->part[1] = c ;
+        }
+    else
+        {
+        best->parts = shape == NETWORK_ONE ? 1 : 3 ;
+        best->part[0] = a ;
+        best->part[1] = b ;
+        best->part[2] = c ;
+        }
+    }
+
+// First index in lo..hi-1 whose part is at least x, or hi
+static unsigned Bracket(const uint32_t *part, unsigned lo, unsigned hi, uint32_t x)
+    {
+    while (lo < hi)
+        {
+        unsigned mid = (lo + hi) >> 1 ;
+
+        if (part[mid] < x) lo = mid + 1 ;
+        else hi = mid ;
+        }
+    return lo ;
+    }
+
+// The b that makes a || b = goal; UINT32_MAX if there is none
+static uint32_t Ideal(uint32_t a, uint32_t goal)
+    {
+    uint64_t b ;
+
+    if (a <= goal) return UINT32_MAX ;
+    b = (uint64_t) a * goal / (a - goal) ;
+    return b > UINT32_MAX ? UINT32_MAX : (uint32_t) b ;
+    }
+
+// a || b to the nearest hundredth
+static uint32_t Parallel(uint32_t a, uint32_t b)
+    {
+    uint64_t sum = (uint64_t) a + b ;
+
+    return (uint32_t) (((uint64_t) a * b + (sum >> 1)) / sum) ;
+    }
+
+static int Within(const NETWORK *net, uint32_t target, uint32_t ppm)
+    {
+    return (uint64_t) net->error * 1000000 <= (uint64_t) ppm * target ;
+    }
+
+// Same shift-and-add as Mul32X10 in Lab8C-Resistors.s
+static uint32_t Mul10(uint32_t multiplicand)
+    {
+    return (multiplicand << 3) + (multiplicand << 1) ;
+    }
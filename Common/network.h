@@ -0,0 +1,76 @@
+/*
+    Standard resistor values the other way round: given a target and a tolerance,
+    the best single E12, E24 or E96 part, or failing that the best network of two
+    or three of them in series and parallel.
+
+        NETWORK net ;
+
+        if (NetworkSearch(NETWORK_E24, 3300000, 1000, 3, &net))    // 33 kOhms, 0.1%
+            ... net.part[0..net.parts-1] combined as net.shape give net.value
+
+    Values are in hundredths of an ohm (NETWORK_OHM), so a uint32_t covers the parts
+    from 1 ohm to 9.76 MOhms and targets up to 42 MOhms. The parts of each series
+    are generated once, in ascending order, from the significands of the standard:
+    each decade is the last one times ten, with the shift-and-add of Mul32X10.
+
+    NetworkSearch() tries one part, then two, then three, and stops at the first
+    count that meets the tolerance, so a network never has more parts than it needs.
+    Within a count it keeps the smallest error. The pairs are found by a binary
+    search for the part that completes each candidate, and the loops stop as soon as
+    the parts they have left can only take the value further from the target
+    (a + b + c >= 3a for a <= b <= c, a || b || c >= a/3, and so on). Ties go to the
+    network found first, which is the one with the smallest parts.
+
+    NetworkBands() splits a part value into its significant digits and the power
+    of ten to multiply them by, which is what the color bands encode: 4.7 kOhms is
+    4, 7 and 10^2. The exponent is -1 for the gold and -2 for the silver multiplier.
+*/
+
+#ifndef __NETWORK_H
+#define __NETWORK_H
+
+#include <stdint.h>
+
+#define NETWORK_OHM         100             // values are in hundredths of an ohm
+#define NETWORK_DECADES     7               // parts from 1 ohm to 9.76 MOhms
+
+typedef enum
+    {
+    NETWORK_E12,
+    NETWORK_E24,
+    NETWORK_E96
+    } NETWORK_SERIES ;
+
+typedef enum
+    {
+    NETWORK_ONE,                            // part[0]
+    NETWORK_SERIES2,                        // part[0] + part[1]
+    NETWORK_PARALLEL2,                      // part[0] || part[1]
+    NETWORK_SERIES3,                        // part[0] + part[1] + part[2]
+    NETWORK_PARALLEL3,                      // part[0] || part[1] || part[2]
+    NETWORK_SERIES_PARALLEL,                // part[0] + (part[1] || part[2])
+    NETWORK_PARALLEL_SERIES                 // part[0] || (part[1] + part[2])
+    } NETWORK_SHAPE ;
+
+typedef struct
+    {
+    NETWORK_SHAPE           shape ;
+    unsigned                parts ;
+    uint32_t                part[3] ;
+    uint32_t                value ;         // of the network, to the nearest hundredth
+    uint32_t                error ;         // |value - target|
+    } NETWORK ;
+
+// Nonzero if best is within ppm parts per million of target; otherwise best is the
+// closest network of up to maxParts (1 to 3) parts found
+int                         NetworkSearch(NETWORK_SERIES series, uint32_t target, uint32_t ppm, unsigned maxParts, NETWORK *best) ;
+
+// The ascending values of a series, and how many there are
+const uint32_t *            NetworkParts(NETWORK_SERIES series, unsigned *count) ;
+
+// digits[0..ndigits-1] x 10^exponent ohms == value; zero if value needs more digits
+int                         NetworkBands(uint32_t value, unsigned ndigits, uint8_t digits[], int *exponent) ;
+
+const char *                NetworkShapeName(NETWORK_SHAPE shape) ;
+
+#endif
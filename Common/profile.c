@@ -0,0 +1,292 @@
+/*
+    Scoped cycle-count profiler: named regions, log-linear histograms, overhead
+    subtraction, a footer overlay and a CSV dump. See profile.h.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "library.h"
+#include "graphics.h"
+#include "profile.h"
+#include "format.h"
+#include "divide.h"
+
+typedef struct
+    {
+    const char *            name ;
+    unsigned                count ;
+    unsigned                min ;
+    unsigned                max ;
+    uint64_t                total ;
+    uint32_t                bucket[PROFILE_BUCKETS] ;
+    } REGION ;
+
+typedef struct _tFont
+    {
+    const uint8_t *         table ;
+    const uint16_t          Width ;
+    const uint16_t          Height ;
+    } sFONT ;
+
+extern sFONT                Font8 ;
+
+#define DEMCR               ((volatile uint32_t *) 0xE000EDFC)
+#define DWT_CTRL            ((volatile uint32_t *) 0xE0001000)
+#define DWT_CYCCNT          ((volatile uint32_t *) 0xE0001004)
+
+#define DEMCR_TRCENA        (1 << 24)
+#define DWT_CYCCNTENA       (1 << 0)
+
+#define CALIBRATION_RUNS    32
+#define FOOTER_ROW          (YPIXELS - 16)
+#define SCALED_SIZE         12              // Scaled's text: ten digits, a unit and '\0'
+
+static unsigned             Bucket(unsigned cycles) ;
+static unsigned             BucketValue(unsigned bucket) ;
+static uint32_t             Cycles(void) ;
+static int                  Find(const char *name, int create) ;
+static unsigned             Mean(REGION *region) ;
+static unsigned             Percentile(REGION *region, unsigned percent) ;
+static void                 Record(REGION *region, unsigned cycles) ;
+static char *               Scaled(char *text, unsigned cycles) ;
+
+static REGION               regions[PROFILE_REGIONS] ;
+static int                  nregions = 0 ;
+static unsigned             overhead = 0 ;
+static int                  initialized = 0 ;
+
+void ProfileInitialize(void)
+    {
+    unsigned cycles, best = ~0U ;
+
+#ifdef __arm__
+    *DEMCR |= DEMCR_TRCENA ;
+    *DWT_CTRL |= DWT_CYCCNTENA ;
+#endif
+    initialized = 1 ;
+    overhead = 0 ;
+
+    // Same path as a real sample, with nothing in between and nowhere to record it
+    for (int run = 0; run < CALIBRATION_RUNS; run++)
+        {
+        PROFILE_TIMER timer = ProfileBegin(NULL) ;
+        cycles = ProfileEnd(&timer) ;
+        if (cycles < best) best = cycles ;
+        }
+    overhead = best ;
+    }
+
+unsigned ProfileOverhead(void)
+    {
+    if (!initialized) ProfileInitialize() ;
+    return overhead ;
+    }
+
+PROFILE_TIMER ProfileBegin(const char *name)
+    {
+    PROFILE_TIMER timer ;
+
+    if (!initialized) ProfileInitialize() ;
+    timer.region = Find(name, 1) ;
+    timer.strt = Cycles() ;
+    return timer ;
+    }
+
+unsigned ProfileEnd(PROFILE_TIMER *timer)
+    {
+    uint32_t stop = Cycles() ;
+    unsigned cycles = stop - timer->strt ;
+
+    cycles = (cycles > overhead) ? cycles - overhead : 0 ;
+    if (timer->region >= 0) Record(&regions[timer->region], cycles) ;
+    return cycles ;
+    }
+
+void ProfileRecord(const char *name, unsigned cycles)
+    {
+    int which = Find(name, 1) ;
+
+    if (which >= 0) Record(&regions[which], cycles) ;
+    }
+
+static void Record(REGION *region, unsigned cycles)
+    {
+    if (region->count == 0 || cycles < region->min) region->min = cycles ;
+    if (cycles > region->max) region->max = cycles ;
+    region->total += cycles ;
+    region->bucket[Bucket(cycles)]++ ;
+    region->count++ ;
+    }
+
+int ProfileStats(const char *name, PROFILE_STATS *stats)
+    {
+    int which = Find(name, 0) ;
+    REGION *region ;
+
+    memset(stats, 0, sizeof(PROFILE_STATS)) ;
+    if (which < 0 || regions[which].count == 0) return 0 ;
+
+    region = &regions[which] ;
+    stats->count  = region->count ;
+    stats->min    = region->min ;
+    stats->median = Percentile(region, 50) ;
+    stats->p99    = Percentile(region, 99) ;
+    stats->max    = region->max ;
+    stats->total  = region->total ;
+    return 1 ;
+    }
+
+void ProfileReset(void)
+    {
+    memset(regions, 0, sizeof(regions)) ;
+    nregions = 0 ;
+    }
+
+// Replaces the footer line with "<name> <min>/<median>/<p99>" in Font8
+void ProfileOverlay(const char *name)
+    {
+    extern void BSP_LCD_SetFont(sFONT *) ;
+    extern sFONT *BSP_LCD_GetFont(void) ;
+    uint32_t foreground = GetForeground() ;
+    uint32_t background = GetBackground() ;
+    sFONT *font = BSP_LCD_GetFont() ;
+    char text[60], min[SCALED_SIZE], median[SCALED_SIZE], p99[SCALED_SIZE] ;
+    PROFILE_STATS stats ;
+    int x ;
+
+    if (!ProfileStats(name, &stats)) return ;
+    FormatString(text, sizeof(text), "%.16s n=%u %s/%s/%s", name, stats.count,
+                 Scaled(min, stats.min), Scaled(median, stats.median), Scaled(p99, stats.p99)) ;
+
+    SetForeground(COLOR_BLUE) ;
+    FillRect(0, FOOTER_ROW, XPIXELS, 16) ;
+    BSP_LCD_SetFont(&Font8) ;
+    SetForeground(COLOR_WHITE) ;
+    SetBackground(COLOR_BLUE) ;
+    x = (XPIXELS - (int) (Font8.Width*strlen(text))) / 2 ;
+    DisplayStringAt(x < 0 ? 0 : x, FOOTER_ROW + (16 - Font8.Height) / 2, (uint8_t *) text) ;
+
+    BSP_LCD_SetFont(font) ;
+    SetForeground(foreground) ;
+    SetBackground(background) ;
+    }
+
+void ProfileCSV(void (*Emit)(char *line))
+    {
+    char line[100] ;
+
+    FormatString(line, sizeof(line), "region,count,min,median,p99,max,mean,overhead\n") ;
+    Emit(line) ;
+    for (int which = 0; which < nregions; which++)
+        {
+        REGION *region = &regions[which] ;
+
+        if (region->count == 0) continue ;
+        FormatString(line, sizeof(line), "%s,%u,%u,%u,%u,%u,%u,%u\n", region->name, region->count,
+                     region->min, Percentile(region, 50), Percentile(region, 99), region->max,
+                     Mean(region), overhead) ;
+        Emit(line) ;
+        }
+    }
+
+static uint32_t Cycles(void)
+    {
+#ifdef __arm__
+    return *DWT_CYCCNT ;
+#else
+    return GetClockCycleCount() ;
+#endif
+    }
+
+// Names are normally string literals, so try the pointer before the characters
+static int Find(const char *name, int create)
+    {
+    if (name == NULL) return -1 ;
+    for (int which = 0; which < nregions; which++)
+        {
+        if (regions[which].name == name) return which ;
+        }
+    for (int which = 0; which < nregions; which++)
+        {
+        if (strcmp(regions[which].name, name) == 0) return which ;
+        }
+    if (!create || nregions == PROFILE_REGIONS) return -1 ;
+
+    regions[nregions].name = name ;
+    return nregions++ ;
+    }
+
+// 0-7 get a bucket each; above that, 4 buckets per power of two
+static unsigned Bucket(unsigned cycles)
+    {
+    unsigned msb ;
+
+    if (cycles < 8) return cycles ;
+    msb = 31 - __builtin_clz(cycles) ;
+    return 8 + 4*(msb - 3) + ((cycles >> (msb - 2)) & 3) ;
+    }
+
+// Middle of the range of values that land in a bucket
+static unsigned BucketValue(unsigned bucket)
+    {
+    unsigned msb, lower, width ;
+
+    if (bucket < 8) return bucket ;
+    msb = 3 + (bucket - 8) / 4 ;
+    width = 1U << (msb - 2) ;
+    lower = (4 + (bucket - 8) % 4) * width ;
+    return lower + (width - 1) / 2 ;
+    }
+
+// total / count a bit at a time in 32-bit halves, with no __aeabi_uldivmod; the
+// mean is at most max, so the high half starts below count and the quotient fits
+static unsigned Mean(REGION *region)
+    {
+    uint32_t high = (uint32_t) (region->total >> 32), low = (uint32_t) region->total ;
+    uint32_t quotient = 0 ;
+
+    for (int bit = 0; bit < 32; bit++)
+        {
+        uint32_t carry = high >> 31 ;
+
+        high = (high << 1) | (low >> 31) ;
+        low <<= 1 ;
+        quotient <<= 1 ;
+        if (carry || high >= region->count)
+            {
+            high -= region->count ;
+            quotient |= 1 ;
+            }
+        }
+    return quotient ;
+    }
+
+// The sample at rank ceil(count x percent / 100), percent at most 100
+static unsigned Percentile(REGION *region, unsigned percent)
+    {
+    uint32_t hundreds = DIVU32(region->count, 100) ;
+    uint32_t rank = hundreds*percent + DIVU32((region->count - 100*hundreds)*percent + 99, 100) ;
+    uint32_t seen = 0 ;
+    unsigned value ;
+
+    if (rank == 0) rank = 1 ;
+    for (unsigned bucket = 0; bucket < PROFILE_BUCKETS; bucket++)
+        {
+        seen += region->bucket[bucket] ;
+        if (seen < rank) continue ;
+        value = BucketValue(bucket) ;
+        if (value < region->min) value = region->min ;
+        if (value > region->max) value = region->max ;
+        return value ;
+        }
+    return region->max ;
+    }
+
+static char *Scaled(char *text, unsigned cycles)
+    {
+    if (cycles < 100000)            FormatString(text, SCALED_SIZE, "%u", cycles) ;
+    else if (cycles < 100000000)    FormatString(text, SCALED_SIZE, "%uK", DIVU32(cycles + 500, 1000)) ;
+    else                            FormatString(text, SCALED_SIZE, "%uM", DIVU32(cycles + 500000, 1000000)) ;
+    return text ;
+    }
@@ -0,0 +1,64 @@
+/*
+    Scoped cycle-count profiler shared by the lab programs. Each named region keeps a
+    log-linear histogram of its samples (4 buckets per power of two, so any reported
+    percentile is within 12.5% of the true value; values below 8 are exact) plus the
+    exact minimum, maximum and total.
+
+    Time a block either explicitly:
+
+        PROFILE_TIMER timer = ProfileBegin("SolvePuzzle") ;
+        ...
+        cycles = ProfileEnd(&timer) ;
+
+    or for the rest of the enclosing scope:
+
+        PROFILE_SCOPE("CopyCell") ;
+
+    The cost of a ProfileBegin/ProfileEnd pair with nothing between them is measured
+    once, the way Lab 4 times CallReturnOverhead, and subtracted from every sample.
+    On the board the samples come straight from DWT_CYCCNT; on the host they come
+    from the GetClockCycleCount() stand-in.
+*/
+
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#include <stdint.h>
+
+#define PROFILE_REGIONS     16
+#define PROFILE_BUCKETS     124
+
+typedef struct
+    {
+    int                     region ;
+    uint32_t                strt ;
+    } PROFILE_TIMER ;
+
+typedef struct
+    {
+    unsigned                count ;
+    unsigned                min ;
+    unsigned                median ;
+    unsigned                p99 ;
+    unsigned                max ;
+    uint64_t                total ;
+    } PROFILE_STATS ;
+
+#define PROFILE_CONCAT(a, b)    a ## b
+#define PROFILE_NAME(line)      PROFILE_CONCAT(profile_timer_, line)
+#define PROFILE_SCOPE(name)     PROFILE_TIMER PROFILE_NAME(__LINE__) \
+                                __attribute__((cleanup(ProfileEnd))) = ProfileBegin(name)
+
+PROFILE_TIMER               ProfileBegin(const char *name) ;
+unsigned                    ProfileEnd(PROFILE_TIMER *timer) ;
+void                        ProfileRecord(const char *name, unsigned cycles) ;
+
+void                        ProfileInitialize(void) ;
+unsigned                    ProfileOverhead(void) ;
+int                         ProfileStats(const char *name, PROFILE_STATS *stats) ;
+void                        ProfileReset(void) ;
+
+void                        ProfileOverlay(const char *name) ;
+void                        ProfileCSV(void (*Emit)(char *line)) ;
+
+#endif
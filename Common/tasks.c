@@ -0,0 +1,66 @@
+/*
+    Cooperative run-to-completion task scheduler. See tasks.h.
+*/
+
+#include <stdint.h>
+#include "timers.h"
+#include "tasks.h"
+
+static TASK *               first = 0 ;
+static TASK *               last = 0 ;
+static int                  dispatching = 0 ;
+
+// Does nothing if the task is already waiting to run
+void TaskReady(TASK *task)
+    {
+    if (task->ready) return ;
+
+    task->ready = 1 ;
+    task->next = 0 ;
+    if (last != 0) last->next = task ;
+    else first = task ;
+    last = task ;
+    }
+
+// Makes the timer callbacks that are due and runs one ready task, or sleeps until
+// the next interrupt if there was neither. Returns 1 if it did any work.
+int TaskIdle(void)
+    {
+    TASK *task ;
+    int work ;
+
+    if (dispatching)
+        {
+        TimerSleep() ;
+        return 0 ;
+        }
+
+    dispatching = 1 ;
+    TimerInitialize() ;
+    work = TimerService() ;
+    if ((task = first) != 0)
+        {
+        if ((first = task->next) == 0) last = 0 ;
+        task->ready = 0 ;
+        (*task->Run)(task->arg) ;
+        work++ ;
+        }
+    dispatching = 0 ;
+
+    if (work == 0) TimerSleep() ;
+    return work != 0 ;
+    }
+
+void TaskDelay(uint32_t msec)
+    {
+    uint32_t until ;
+
+    TimerInitialize() ;
+    until = TimerClock() + msec ;
+    while ((int32_t) (until - TimerClock()) > 0) TaskIdle() ;
+    }
+
+void TaskRun(void)
+    {
+    for (;;) TaskIdle() ;
+    }
@@ -0,0 +1,38 @@
+/*
+    Cooperative, run-to-completion tasks. A task is a function that does one piece
+    of work and returns; TaskReady() puts it on the ready list and the next idle
+    moment runs it once:
+
+        static TASK plot = {PlotSample, &sensor} ;
+
+        TaskReady(&plot) ;      // from a timer callback, an event handler, ...
+
+    Wherever the main program would have waited, it calls TaskIdle(), TaskDelay()
+    or EventWait() (events.h) instead. These make the timer callbacks that are due
+    and run ready tasks, and sleep in WFI only when there is nothing left to do.
+    A task that has more to do readies itself again before it returns and goes to
+    the back of the list.
+
+    Tasks and timer callbacks must not wait themselves. If one does, the wait just
+    sleeps, without running anything else.
+*/
+
+#ifndef __TASKS_H
+#define __TASKS_H
+
+#include <stdint.h>
+
+typedef struct _TASK
+    {
+    void                    (*Run)(void *arg) ;
+    void *                  arg ;
+    struct _TASK *          next ;          // kept by tasks.c
+    int                     ready ;
+    } TASK ;
+
+void                        TaskReady(TASK *task) ;
+int                         TaskIdle(void) ;
+void                        TaskDelay(uint32_t msec) ;
+void                        TaskRun(void) ;
+
+#endif
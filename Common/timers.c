@@ -0,0 +1,141 @@
+/*
+    1 kHz tick and timer wheel. See timers.h.
+*/
+
+#include <stdint.h>
+#include "timers.h"
+#include "interrupts.h"
+
+#define RCC_APB1ENR         ((volatile uint32_t *) 0x40023840)
+#define TIM7_CR1            ((volatile uint32_t *) 0x40001400)
+#define TIM7_DIER           ((volatile uint32_t *) 0x4000140C)
+#define TIM7_SR             ((volatile uint32_t *) 0x40001410)
+#define TIM7_EGR            ((volatile uint32_t *) 0x40001414)
+#define TIM7_PSC            ((volatile uint32_t *) 0x40001428)
+#define TIM7_ARR            ((volatile uint32_t *) 0x4000142C)
+#define NVIC_ISER1          ((volatile uint32_t *) 0xE000E104)
+#define NVIC_IPR            ((volatile uint8_t *)  0xE000E400)
+
+#define RCC_TIM7EN          (1 << 5)
+#define TIM_CEN             (1 << 0)
+#define TIM_UIE             (1 << 0)
+#define TIM_UIF             (1 << 0)
+#define TIM_UG              (1 << 0)
+#define TIM7_IRQn           55
+#define TIM7_CLOCK_MHZ      84              // APB1 timer clock with a 168 MHz core
+#define PRIORITY_LOWEST     0xF0
+
+static void                 Insert(TIMER *timer) ;
+
+static TIMER *              wheel[TIMER_SLOTS] ;
+static volatile uint32_t    ticks = 0 ;     // written only by the interrupt
+static uint32_t             serviced = 0 ;  // last tick whose slot has been looked at
+static void                 (*volatile hook)(void) = 0 ;
+static int                  running = 0 ;
+
+void TimerInitialize(void)
+    {
+    if (running) return ;
+
+    // TIM7 counts microseconds and interrupts every 1000 of them
+    *RCC_APB1ENR |= RCC_TIM7EN ;
+    *TIM7_CR1 = 0 ;
+    *TIM7_PSC = TIM7_CLOCK_MHZ - 1 ;
+    *TIM7_ARR = 1000 - 1 ;
+    *TIM7_EGR = TIM_UG ;
+    *TIM7_SR = 0 ;
+    *TIM7_DIER = TIM_UIE ;
+    NVIC_IPR[TIM7_IRQn] = PRIORITY_LOWEST ;
+    *NVIC_ISER1 = 1 << (TIM7_IRQn - 32) ;
+    *TIM7_CR1 = TIM_CEN ;
+    running = 1 ;
+    }
+
+uint32_t TimerClock(void)
+    {
+    return ticks ;
+    }
+
+// Hook runs inside the interrupt on every tick; keep it short
+void TimerHook(void (*Hook)(void))
+    {
+    hook = Hook ;
+    }
+
+void TimerStart(TIMER *timer, uint32_t msec, uint32_t period, void (*Callback)(void *arg), void *arg)
+    {
+    if (timer->active) TimerStop(timer) ;
+
+    timer->expires = ticks + (msec != 0 ? msec : 1) ;
+    timer->period = period ;
+    timer->Callback = Callback ;
+    timer->arg = arg ;
+    Insert(timer) ;
+    }
+
+void TimerStop(TIMER *timer)
+    {
+    TIMER **link = &wheel[timer->expires % TIMER_SLOTS] ;
+
+    if (!timer->active) return ;
+    while (*link != timer) link = &(*link)->next ;
+    *link = timer->next ;
+    timer->active = 0 ;
+    }
+
+// Makes the callbacks for every tick since the last call; returns how many it made
+int TimerService(void)
+    {
+    uint32_t now ;
+    int calls = 0 ;
+
+    InterruptWindow() ;
+    now = ticks ;
+    while (serviced != now)
+        {
+        TIMER **slot = &wheel[++serviced % TIMER_SLOTS] ;
+        TIMER *timer ;
+
+        // Rescan after each callback, since it may have started or stopped any timer
+        for (;;)
+            {
+            for (timer = *slot; timer != 0; timer = timer->next)
+                {
+                if (timer->expires == serviced) break ;
+                }
+            if (timer == 0) break ;
+
+            TimerStop(timer) ;
+            if (timer->period != 0)
+                {
+                timer->expires += timer->period ;
+                Insert(timer) ;
+                }
+            (*timer->Callback)(timer->arg) ;
+            calls++ ;
+            }
+        }
+    return calls ;
+    }
+
+// An interrupt between the caller's last look and the WFI costs at most one tick
+void TimerSleep(void)
+    {
+    WaitForInterrupt() ;
+    }
+
+void TIM7_IRQHandler(void)
+    {
+    *TIM7_SR = ~TIM_UIF ;
+    ticks++ ;
+    if (hook != 0) (*hook)() ;
+    }
+
+static void Insert(TIMER *timer)
+    {
+    TIMER **slot = &wheel[timer->expires % TIMER_SLOTS] ;
+
+    timer->next = *slot ;
+    *slot = timer ;
+    timer->active = 1 ;
+    }
@@ -0,0 +1,47 @@
+/*
+    A 1 kHz tick and a timer wheel on top of it, so a program can ask to be called
+    back later instead of spinning in a delay loop:
+
+        static TIMER blink ;
+
+        TimerStart(&blink, 500, 500, Blink, NULL) ;   // in 500 msec, then every 500
+
+    A timer sits in slot expires % TIMER_SLOTS of the wheel. Each tick looks only at
+    the slot that has come due, so the cost of a tick does not grow with the number
+    of timers waiting further out.
+
+    Callbacks are made by TimerService(), which TaskIdle() (tasks.h) calls from the
+    main program, never from the interrupt. A callback may draw, ready a task and
+    start or stop timers, its own included, but it must not wait.
+
+    On the board the tick is the TIM7 update interrupt at the lowest priority; on
+    the host it is simulated (see Host.h).
+*/
+
+#ifndef __TIMERS_H
+#define __TIMERS_H
+
+#include <stdint.h>
+
+#define TIMER_SLOTS         32              // a power of two
+
+typedef struct _TIMER
+    {
+    struct _TIMER *         next ;          // rest of the wheel slot
+    uint32_t                expires ;       // TimerClock() of the next callback
+    uint32_t                period ;        // 0 = one shot
+    void                    (*Callback)(void *arg) ;
+    void *                  arg ;
+    int                     active ;
+    } TIMER ;
+
+void                        TimerInitialize(void) ;
+uint32_t                    TimerClock(void) ;
+void                        TimerHook(void (*Hook)(void)) ;
+
+void                        TimerStart(TIMER *timer, uint32_t msec, uint32_t period, void (*Callback)(void *arg), void *arg) ;
+void                        TimerStop(TIMER *timer) ;
+int                         TimerService(void) ;
+void                        TimerSleep(void) ;
+
+#endif
@@ -0,0 +1,174 @@
+/*
+    Retained-mode labels, value boxes and buttons that redraw only what changed.
+    See widget.h.
+*/
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include "graphics.h"
+#include "format.h"
+#include "widget.h"
+#include "glyphs.h"
+
+typedef struct _tFont
+    {
+    const uint8_t *         table ;
+    const uint16_t          Width ;
+    const uint16_t          Height ;
+    } sFONT ;
+
+extern sFONT *              BSP_LCD_GetFont(void) ;
+extern void                 BSP_LCD_SetFont(sFONT *) ;
+
+static void                 CellOrigin(WIDGET *widget, int count, int *x, int *y) ;
+static int                  Layout(WIDGET *widget, const char *text, char *cells) ;
+static unsigned             Repaint(WIDGET *widget, const char *text, const char *cells, int count) ;
+
+unsigned WidgetText(WIDGET *widget, const char *text)
+    {
+    const sFONT *font = widget->font ;
+    uint32_t foreground = GetForeground() ;
+    uint32_t background = GetBackground() ;
+    sFONT *previous = BSP_LCD_GetFont() ;
+    char cells[WIDGET_CHARS + 1] ;
+    unsigned painted = 0 ;
+    int count, x, y ;
+
+    count = Layout(widget, text, cells) ;
+    BSP_LCD_SetFont((sFONT *) font) ;
+
+    if (!widget->drawn
+        || widget->font != widget->drawn_font
+        || widget->foreground != widget->drawn_foreground
+        || widget->background != widget->drawn_background
+        || widget->border != widget->drawn_border
+        || (widget->border != 0 && strcmp(cells, widget->cells) != 0))
+        {
+        painted = Repaint(widget, text, cells, count) ;
+        }
+    else
+        {
+        CellOrigin(widget, count, &x, &y) ;
+        SetForeground(widget->foreground) ;
+        SetBackground(widget->background) ;
+        for (int cell = 0; cell < count; cell++, x += font->Width)
+            {
+            if (cells[cell] == widget->cells[cell]) continue ;
+            GlyphChar(x, y, cells[cell]) ;
+            painted++ ;
+            }
+        }
+
+    memcpy(widget->cells, cells, sizeof(cells)) ;
+    widget->drawn = 1 ;
+    widget->drawn_font = widget->font ;
+    widget->drawn_foreground = widget->foreground ;
+    widget->drawn_background = widget->background ;
+    widget->drawn_border = widget->border ;
+
+    BSP_LCD_SetFont(previous) ;
+    SetForeground(foreground) ;
+    SetBackground(background) ;
+    return painted ;
+    }
+
+unsigned WidgetFormat(WIDGET *widget, const char *format, ...)
+    {
+    char text[2*WIDGET_CHARS + 1] ;
+    va_list args ;
+
+    va_start(args, format) ;
+    FormatList(text, sizeof(text), format, args) ;
+    va_end(args) ;
+    return WidgetText(widget, text) ;
+    }
+
+// The screen under the widget has been painted over; repaint all of it next time
+void WidgetForget(WIDGET *widget)
+    {
+    widget->drawn = 0 ;
+    }
+
+// Top left corner of the first character cell
+static void CellOrigin(WIDGET *widget, int count, int *x, int *y)
+    {
+    const sFONT *font = widget->font ;
+    int spare = widget->xsize - count*font->Width ;
+
+    *x = widget->xpos ;
+    if (widget->align == WIDGET_RIGHT) *x += spare ;
+    else if (widget->align == WIDGET_CENTER) *x += spare / 2 ;
+
+    *y = widget->ypos ;
+    if (widget->ysize > font->Height) *y += (widget->ysize - font->Height) / 2 ;
+    }
+
+// Lay text out on the widget's character cells; returns the number of cells
+static int Layout(WIDGET *widget, const char *text, char *cells)
+    {
+    const sFONT *font = widget->font ;
+    int count = widget->xsize / font->Width ;
+    int length = strlen(text) ;
+    int left ;
+
+    if (count > WIDGET_CHARS) count = WIDGET_CHARS ;
+    if (length > count)
+        {
+        if (widget->align == WIDGET_RIGHT) text += length - count ;
+        length = count ;
+        }
+
+    if (widget->align == WIDGET_RIGHT)          left = count - length ;
+    else if (widget->align == WIDGET_CENTER)    left = (count - length) / 2 ;
+    else                                        left = 0 ;
+
+    memset(cells, ' ', count) ;
+    memcpy(cells + left, text, length) ;
+    cells[count] = '\0' ;
+    return count ;
+    }
+
+static unsigned Repaint(WIDGET *widget, const char *text, const char *cells, int count)
+    {
+    const sFONT *font = widget->font ;
+    const sFONT *old = widget->drawn ? widget->drawn_font : font ;
+    int height = widget->ysize ;
+    unsigned painted = 0 ;
+    int x, y ;
+
+    // Without a height of its own, cover whatever the previous font drew too
+    if (height == 0) height = (old->Height > font->Height) ? old->Height : font->Height ;
+
+    SetForeground(widget->background) ;
+    FillRect(widget->xpos, widget->ypos, widget->xsize, height) ;
+    if (widget->border != 0)
+        {
+        SetForeground(widget->border) ;
+        DrawRect(widget->xpos, widget->ypos, widget->xsize, height) ;
+        }
+
+    SetForeground(widget->foreground) ;
+    SetBackground(widget->background) ;
+
+    // Buttons centre their label to the pixel, clear of the top border
+    if (widget->border != 0)
+        {
+        int length = strlen(text) ;
+
+        if (length > count) length = count ;
+        x = widget->xpos + (widget->xsize - length*font->Width) / 2 ;
+        y = widget->ypos + (height - font->Height) / 2 + 1 ;
+        for (int k = 0; k < length; k++, x += font->Width) GlyphChar(x, y, text[k]) ;
+        return length ;
+        }
+
+    CellOrigin(widget, count, &x, &y) ;
+    for (int cell = 0; cell < count; cell++, x += font->Width)
+        {
+        if (cells[cell] == ' ') continue ;
+        GlyphChar(x, y, cells[cell]) ;
+        painted++ ;
+        }
+    return painted ;
+    }
@@ -0,0 +1,55 @@
+/*
+    Retained-mode widgets: labels, value boxes and buttons that remember what they
+    last put on the screen. Updating one with the same text and colors draws
+    nothing. Updating one with new text redraws only the character cells whose
+    glyph changed. A change of font or colors, or the first update, repaints the
+    whole widget.
+
+    A widget is a WIDGET with its placement and colors filled in; the rest starts
+    out zero, as it is for a static or a member of a static table:
+
+        static WIDGET result = {40, 150, 180, 0, WIDGET_LEFT, &Font16, COLOR_BLACK, COLOR_YELLOW} ;
+
+        WidgetText(&result, Value(ohms)) ;
+
+    Text is laid out on a grid of xsize/font->Width character cells, aligned as
+    asked; whatever does not fit is cut off on the side away from the alignment.
+    With a border color the widget is a button: the whole rectangle is filled
+    and outlined, and any change repaints it.
+*/
+
+#ifndef __WIDGET_H
+#define __WIDGET_H
+
+#include <stdint.h>
+
+#define WIDGET_CHARS        32
+
+typedef enum {WIDGET_LEFT = 0, WIDGET_RIGHT = 1, WIDGET_CENTER = 2} WIDGET_ALIGN ;
+
+typedef struct
+    {
+    int                     xpos ;          // left edge
+    int                     ypos ;          // top edge
+    int                     xsize ;         // width in pixels
+    int                     ysize ;         // height in pixels (0 = one line of text)
+    WIDGET_ALIGN            align ;
+    const void *            font ;          // an sFONT from the run-time library
+    uint32_t                foreground ;
+    uint32_t                background ;
+    uint32_t                border ;        // 0 = none; otherwise a button
+
+    // What is on the screen now, kept by widget.c
+    int                     drawn ;
+    const void *            drawn_font ;
+    uint32_t                drawn_foreground ;
+    uint32_t                drawn_background ;
+    uint32_t                drawn_border ;
+    char                    cells[WIDGET_CHARS + 1] ;
+    } WIDGET ;
+
+unsigned                    WidgetText(WIDGET *widget, const char *text) ;
+unsigned                    WidgetFormat(WIDGET *widget, const char *format, ...) ;
+void                        WidgetForget(WIDGET *widget) ;
+
+#endif
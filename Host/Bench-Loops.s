@@ -0,0 +1,224 @@
+/*
+    Baselines for kernelbench (Kernel-Bench.c): the loop of scalar calls that
+    Div32X10Array and Mul32X10Array replace, so that the interpreter can time the
+    call overhead along with the kernels.
+
+    Also the 64-bit division by 10 that Div64X10 and DivMod64X10 replace: "ohms/10"
+    on a uint64_t compiles to a call to __aeabi_uldivmod. There is no libgcc here,
+    so UDivMod64 stands in for it with three UDIVs on 16-bit digits; the library
+    routine goes through __udivmoddi4 and costs more, so this is a lower bound on
+    what the kernels save.
+
+    And the digit-at-a-time loops that Bin2Bcd32 and Bin2Bcd64 (../Common/bcd.s)
+    replace: "bcd |= (n % 10) << shift ; n /= 10" with the division by Div32X10 or
+    DivMod64X10, which is what the compiler's own reciprocal comes to.
+
+    And the cell-at-a-time loops that GetNibbles and PutNibbles (Lab 7) replace.
+    Assembled by "make objects".
+*/
+        .syntax     unified
+        .cpu        cortex-m4
+        .text
+
+// void Div32X10Loop(uint32_t *dst, uint32_t *src, uint32_t count) ;
+
+        .global     Div32X10Loop
+        .thumb_func
+        .align
+Div32X10Loop:       // R0 = dst, R1 = src, R2 = count
+        PUSH        {R4-R6,LR}
+        MOV         R4,R0
+        MOV         R5,R1
+        MOVS        R6,R2
+        BEQ         DivLoopDone
+DivLoop:
+        LDR         R0,[R5],4
+        BL          Div32X10
+        STR         R0,[R4],4
+        SUBS        R6,R6,1
+        BNE         DivLoop
+DivLoopDone:
+        POP         {R4-R6,PC}
+
+// void Mul32X10Loop(uint32_t *dst, uint32_t *src, uint32_t count) ;
+
+        .global     Mul32X10Loop
+        .thumb_func
+        .align
+Mul32X10Loop:       // R0 = dst, R1 = src, R2 = count
+        PUSH        {R4-R6,LR}
+        MOV         R4,R0
+        MOV         R5,R1
+        MOVS        R6,R2
+        BEQ         MulLoopDone
+MulLoop:
+        LDR         R0,[R5],4
+        BL          Mul32X10
+        STR         R0,[R4],4
+        SUBS        R6,R6,1
+        BNE         MulLoop
+MulLoopDone:
+        POP         {R4-R6,PC}
+
+// uint64_t Div64X10Call(uint64_t dividend) ;
+
+        .global     Div64X10Call
+        .thumb_func
+        .align
+Div64X10Call:       // R1.R0 = dividend
+        PUSH        {R4,LR}
+        MOVS        R2,10
+        BL          UDivMod64
+        POP         {R4,PC}
+
+// uint64_t DivMod64X10Call(uint64_t dividend, uint32_t *remainder) ;
+
+        .global     DivMod64X10Call
+        .thumb_func
+        .align
+DivMod64X10Call:    // R1.R0 = dividend, R2 = remainder address
+        PUSH        {R4,LR}
+        MOV         R4,R2
+        MOVS        R2,10
+        BL          UDivMod64
+        STR         R2,[R4]
+        POP         {R4,PC}
+
+// uint64_t Bin2Bcd32Loop(uint32_t binary) ;
+
+        .global     Bin2Bcd32Loop
+        .thumb_func
+        .align
+Bin2Bcd32Loop:      // R0 = binary
+        PUSH        {R4-R8,LR}
+        MOV         R4,R0
+        MOVS        R5,0                // R6.R5 = BCD
+        MOVS        R6,0
+        MOVS        R7,0                // shift
+        CBZ         R4,Bcd32LoopDone
+Bcd32Loop:
+        MOV         R0,R4
+        BL          Div32X10
+        ADD         R1,R0,R0,LSL 2
+        SUB         R1,R4,R1,LSL 1      // n % 10
+        MOV         R4,R0
+        LSL         R2,R1,R7            // shifts of 32 and more give 0
+        ORR         R5,R5,R2
+        SUB         R8,R7,32
+        LSL         R2,R1,R8
+        ORR         R6,R6,R2
+        ADD         R7,R7,4
+        CMP         R4,0
+        BNE         Bcd32Loop
+Bcd32LoopDone:
+        MOV         R0,R5
+        MOV         R1,R6
+        POP         {R4-R8,PC}
+
+// void Bin2Bcd64Loop(uint64_t binary, uint32_t bcd[3]) ;
+
+        .global     Bin2Bcd64Loop
+        .thumb_func
+        .align
+Bin2Bcd64Loop:      // R1.R0 = binary, R2 = bcd
+        PUSH        {R4-R8,LR}
+        MOV         R4,R0
+        MOV         R5,R1
+        MOV         R6,R2
+        MOVS        R7,0
+        STR         R7,[R2]
+        STR         R7,[R2,4]
+        STR         R7,[R2,8]
+Bcd64Loop:
+        ORRS        R0,R4,R5
+        BEQ         Bcd64LoopDone
+        MOV         R0,R4
+        MOV         R1,R5
+        SUB         SP,SP,8
+        MOV         R2,SP
+        BL          DivMod64X10
+        LDR         R2,[SP],8           // n % 10
+        MOV         R4,R0
+        MOV         R5,R1
+        LDR         R3,[R6]
+        LSL         R2,R2,R7
+        ORR         R3,R3,R2
+        STR         R3,[R6]
+        ADD         R7,R7,4
+        CMP         R7,32
+        BNE         Bcd64Loop
+        MOVS        R7,0                // next word
+        ADD         R6,R6,4
+        B           Bcd64Loop
+Bcd64LoopDone:
+        POP         {R4-R8,PC}
+
+// R1.R0 = R1.R0 / R2, R2 = remainder, for a divisor below 2^16: long division
+// by 16-bit digits, each step's remainder prefixed to the next digit
+        .thumb_func
+        .align
+UDivMod64:
+        PUSH        {R4}
+        UDIV        R3,R1,R2            // high word of the quotient
+        MLS         R1,R3,R2,R1         // remainder, less than the divisor
+        LSRS        R12,R0,16
+        ORR         R12,R12,R1,LSL 16   // remainder : upper half of low word
+        UDIV        R4,R12,R2
+        MLS         R12,R4,R2,R12
+        UBFX        R1,R0,0,16
+        ORR         R1,R1,R12,LSL 16    // remainder : lower half
+        UDIV        R0,R1,R2
+        MLS         R2,R0,R2,R1         // final remainder
+        ORR         R0,R0,R4,LSL 16
+        MOV         R1,R3
+        POP         {R4}
+        BX          LR
+
+// void GetNibblesLoop(uint8_t *bytes, void *nibbles, uint32_t count) ;
+
+        .global     GetNibblesLoop
+        .thumb_func
+        .align
+GetNibblesLoop:     // R0 = bytes, R1 = nibbles, R2 = count
+        PUSH        {R4-R7,LR}
+        MOV         R4,R0
+        MOV         R5,R1
+        MOVS        R7,0                // which
+        MOVS        R6,R2
+        BEQ         GetLoopDone
+GetLoop:
+        MOV         R0,R5
+        MOV         R1,R7
+        BL          GetNibble
+        STRB        R0,[R4,R7]
+        ADDS        R7,R7,1
+        CMP         R7,R6
+        BNE         GetLoop
+GetLoopDone:
+        POP         {R4-R7,PC}
+
+// void PutNibblesLoop(void *nibbles, uint8_t *bytes, uint32_t count) ;
+
+        .global     PutNibblesLoop
+        .thumb_func
+        .align
+PutNibblesLoop:     // R0 = nibbles, R1 = bytes, R2 = count
+        PUSH        {R4-R7,LR}
+        MOV         R4,R0
+        MOV         R5,R1
+        MOVS        R7,0                // which
+        MOVS        R6,R2
+        BEQ         PutLoopDone
+PutLoop:
+        MOV         R0,R4
+        MOV         R1,R7
+        LDRB        R2,[R5,R7]
+        AND         R2,R2,15
+        BL          PutNibble
+        ADDS        R7,R7,1
+        CMP         R7,R6
+        BNE         PutLoop
+PutLoopDone:
+        POP         {R4-R7,PC}
+
+        .end
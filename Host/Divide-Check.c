@@ -0,0 +1,297 @@
+/*
+    divcheck: the divide-by-constant generator of ../Common/divide.h and
+    ../Common/divide.inc against real division.
+
+        divcheck [-a] [-n samples] [-d objdir]
+
+    For every divisor in the table below, the magic number, shift and form that
+    divide.h computes at compile time are tried on dividends as follows:
+
+        used        every dividend from 0 to 0xFFFFFFFF
+        others      both sides of every multiple of the divisor, k*d - 1 and k*d,
+                    except below 4 where that saves nothing. DivideU32 and n / d
+                    are both nondecreasing in n, so if they agree there they agree
+                    everywhere in between. -a tries every dividend for these too
+                    (about 10 s each).
+
+    The reference quotient is kept by counting rather than dividing, so a pass over
+    all 2^32 dividends takes seconds. DIVS32 is checked around each multiple of the
+    divisor near zero and the ends of the int32_t range and on random dividends;
+    its magnitudes go through the DivideU32 already checked. DIVEXACT64 is checked
+    on random multiples of its divisor.
+
+    The DIVU macro of divide.inc is assembled into Divide-Macros.s ("make objects")
+    and run in the Thumb-2 interpreter on the edges and on random dividends. The
+    exit status is 1 if anything disagrees.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "divide.h"
+#include "Thumb.h"
+
+#define EDGES               4096                // dividends near each end, for DIVS32
+
+typedef struct
+    {
+    uint32_t                divisor ;
+    uint32_t                magic ;
+    unsigned                shift ;
+    int                     form ;
+    int                     used ;              // by the programs: always every dividend
+    const char *            function ;          // in Divide-Macros.s
+    } DIVISOR ;
+
+typedef struct
+    {
+    int32_t                 divisor ;
+    uint32_t                magic ;
+    unsigned                shift ;
+    int                     form ;
+    int                     negative ;
+    } SIGNED ;
+
+#define U(d, used)          {d, DIVU_MAGIC(d), DIVU_SHIFT(d), DIVU_FORM(d), used, "DivU" #d}
+#define S(d)                {d, DIVU_MAGIC(DIVS_ABS(d)), DIVU_SHIFT(DIVS_ABS(d)), DIVU_FORM(DIVS_ABS(d)), (d) < 0}
+
+static DIVISOR              unsigned_divisors[] =
+    {
+    U(10, 1), U(100, 1), U(1000, 1), U(1000000, 1),
+    U(1, 0), U(2, 0), U(3, 0), U(5, 0), U(6, 0), U(7, 0), U(9, 0), U(11, 0), U(13, 0),
+    U(25, 0), U(60, 0), U(240, 0), U(641, 0), U(1023, 0), U(1024, 0), U(1025, 0),
+    U(10000, 0), U(100000, 0), U(10000000, 0), U(100000000, 0), U(1000000000, 0),
+    U(0x7FFFFFFF, 0), U(0x80000000, 0), U(0x80000001, 0), U(0xFFFFFFFE, 0), U(0xFFFFFFFF, 0)
+    } ;
+
+static SIGNED               signed_divisors[] =
+    {
+    S(10), S(100), S(1), S(-1), S(3), S(-3), S(7), S(-7), S(1000), S(-1000000),
+    S(0x7FFFFFFF), S(-0x7FFFFFFF), S(INT32_MIN)
+    } ;
+
+static const uint64_t       exact_divisors[] =
+    {
+    10, 100, 1000, 1000000, 1000000000, 3, 7, 640, 1000000000000ULL
+    } ;
+
+static uint64_t             random_state = 88172645463325252ULL ;
+
+static int                  CheckAll(DIVISOR *d) ;
+static int                  CheckBoundaries(DIVISOR *d) ;
+static int                  CheckSigned(SIGNED *d, unsigned long samples) ;
+static int                  CheckExact(uint64_t d, unsigned long samples) ;
+static int                  CheckMacro(THUMB_CPU *cpu, DIVISOR *d, unsigned long samples) ;
+static uint64_t             Random(void) ;
+static double               Seconds(void) ;
+static void                 Usage(void) ;
+
+int main(int argc, char **argv)
+    {
+    const char *dir = "build/arm" ;
+    unsigned long samples = 1000000 ;
+    int all = 0, failed = 0 ;
+    char path[512] ;
+    THUMB_CPU *cpu = ThumbCreate() ;
+    FILE *fp ;
+
+    for (int k = 1; k < argc; k++)
+        {
+        if (strcmp(argv[k], "-a") == 0) all = 1 ;
+        else if (strcmp(argv[k], "-n") == 0 && k + 1 < argc) samples = strtoul(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-d") == 0 && k + 1 < argc) dir = argv[++k] ;
+        else Usage() ;
+        }
+
+    setvbuf(stdout, NULL, _IOLBF, 0) ;                  // a line per divisor as it finishes
+    snprintf(path, sizeof(path), "%s/Divide-Macros.o", dir) ;
+    if ((fp = fopen(path, "rb")) != NULL)
+        {
+        fclose(fp) ;
+        ThumbLoadObject(cpu, path) ;
+        }
+    if (!ThumbLink(cpu)) return 2 ;
+
+    printf("%-12s %-6s %10s %5s %-10s %8s %8s %8s\n", "divisor", "form", "magic", "shift", "dividends", "wrong", "asm", "seconds") ;
+    for (DIVISOR *d = unsigned_divisors; d < unsigned_divisors + sizeof(unsigned_divisors)/sizeof(unsigned_divisors[0]); d++)
+        {
+        static const char *form[] = {"one", "short", "long"} ;
+        double start = Seconds() ;
+        int every = d->used || all || d->divisor < 4 ;      // no fewer boundaries than dividends
+        int wrong = every ? CheckAll(d) : CheckBoundaries(d) ;
+        int macro = CheckMacro(cpu, d, samples) ;
+
+        printf("%-12u %-6s 0x%08X %5u %-10s %8d ", d->divisor, form[d->form], d->magic, d->shift, every ? "every" : "boundaries", wrong) ;
+        if (macro < 0) printf("%8s", "skipped") ;
+        else printf("%8d", macro) ;
+        printf(" %8.1f\n", Seconds() - start) ;
+        if (wrong != 0 || macro > 0) failed = 1 ;
+        }
+
+    for (SIGNED *d = signed_divisors; d < signed_divisors + sizeof(signed_divisors)/sizeof(signed_divisors[0]); d++)
+        {
+        int wrong = CheckSigned(d, samples) ;
+
+        printf("DIVS32 %-11d %8d wrong\n", d->divisor, wrong) ;
+        if (wrong != 0) failed = 1 ;
+        }
+
+    for (int k = 0; k < sizeof(exact_divisors)/sizeof(exact_divisors[0]); k++)
+        {
+        int wrong = CheckExact(exact_divisors[k], samples) ;
+
+        printf("DIVEXACT64 %-13llu %4d wrong\n", (unsigned long long) exact_divisors[k], wrong) ;
+        if (wrong != 0) failed = 1 ;
+        }
+
+    // The programs' own uses, through the macros rather than the table
+    if (DIVU32(12345678, 100) != 123456 || DIVS32(-12345, 100) != -123
+        || DIVEXACT64(123000000ULL, 1000000) != 123 || DIVU32(0xFFFFFFFF, 7) != 0xFFFFFFFFu / 7)
+        {
+        printf("DIVU32/DIVS32/DIVEXACT64 macros disagree with the table\n") ;
+        failed = 1 ;
+        }
+
+    ThumbDestroy(cpu) ;
+    return failed ;
+    }
+
+static int Report(const char *what, long long divisor, long long n, long long got, long long want, int wrong)
+    {
+    if (wrong < 3) printf("    %s %lld / %lld = %lld, should be %lld\n", what, n, divisor, got, want) ;
+    return wrong + 1 ;
+    }
+
+// Every dividend, with the reference quotient kept by counting
+static int CheckAll(DIVISOR *d)
+    {
+    uint32_t n = 0, q = 0, r = 0 ;
+    int wrong = 0 ;
+
+    do
+        {
+        uint32_t got = DivideU32(n, d->magic, d->shift, d->form) ;
+
+        if (got != q) wrong = Report("DIVU32", d->divisor, n, got, q, wrong) ;
+        if (++r == d->divisor)
+            {
+            r = 0 ;
+            q++ ;
+            }
+        }
+    while (++n != 0) ;
+
+    return wrong ;
+    }
+
+static int CheckBoundaries(DIVISOR *d)
+    {
+    uint32_t last = 0xFFFFFFFFu / d->divisor ;
+    int wrong = 0 ;
+
+    for (uint64_t k = 0; k <= last; k++)
+        {
+        uint32_t n = (uint32_t) (k * d->divisor) ;
+        uint32_t got = DivideU32(n, d->magic, d->shift, d->form) ;
+
+        if (got != k) wrong = Report("DIVU32", d->divisor, n, got, k, wrong) ;
+        if (k == 0) continue ;
+        got = DivideU32(n - 1, d->magic, d->shift, d->form) ;
+        if (got != k - 1) wrong = Report("DIVU32", d->divisor, n - 1, got, k - 1, wrong) ;
+        }
+
+    // The last quotient runs to the end of the range
+    if (DivideU32(0xFFFFFFFF, d->magic, d->shift, d->form) != last)
+        {
+        wrong = Report("DIVU32", d->divisor, 0xFFFFFFFF, DivideU32(0xFFFFFFFF, d->magic, d->shift, d->form), last, wrong) ;
+        }
+    return wrong ;
+    }
+
+static int CheckSigned(SIGNED *d, unsigned long samples)
+    {
+    int wrong = 0 ;
+
+    for (unsigned long k = 0; k < 3*EDGES + samples; k++)
+        {
+        int32_t n ;
+        int32_t got, want ;
+
+        if (k < EDGES)              n = INT32_MIN + (int32_t) k ;
+        else if (k < 2*EDGES)       n = INT32_MAX - (int32_t) (k - EDGES) ;
+        else if (k < 3*EDGES)       n = (int32_t) (k - 2*EDGES) - EDGES/2 ;
+        else                        n = (int32_t) Random() ;
+
+        if (d->divisor == -1 && n == INT32_MIN) continue ;      // overflows in C as well
+        got = DivideS32(n, d->magic, d->shift, d->form, d->negative) ;
+        want = n / d->divisor ;
+        if (got != want) wrong = Report("DIVS32", d->divisor, n, got, want, wrong) ;
+        }
+    return wrong ;
+    }
+
+static int CheckExact(uint64_t d, unsigned long samples)
+    {
+    uint64_t odd = d >> __builtin_ctzll(d) ;
+    uint64_t inverse = DIVX_INVERSE(odd) ;
+    int shift = __builtin_ctzll(d) ;
+    int wrong = 0 ;
+
+    if (odd * inverse != 1) wrong = Report("DIVEXACT64 inverse", d, odd, odd * inverse, 1, wrong) ;
+    for (unsigned long k = 0; k < samples; k++)
+        {
+        uint64_t q = k < 1000 ? k : Random() % (UINT64_MAX / d + 1) ;
+        uint64_t got = ((q * d) >> shift) * inverse ;
+
+        if (got != q) wrong = Report("DIVEXACT64", d, q * d, got, q, wrong) ;
+        }
+    return wrong ;
+    }
+
+// Returns -1 if Divide-Macros.o was not assembled
+static int CheckMacro(THUMB_CPU *cpu, DIVISOR *d, unsigned long samples)
+    {
+    uint32_t fn = ThumbSymbol(cpu, d->function) ;
+    int wrong = 0 ;
+
+    if (fn == 0) return -1 ;
+    for (unsigned long k = 0; k < 2*EDGES + samples; k++)
+        {
+        uint32_t n ;
+
+        if (k < EDGES)              n = (uint32_t) k ;
+        else if (k < 2*EDGES)       n = 0xFFFFFFFFu - (uint32_t) (k - EDGES) ;
+        else if (k & 1)             n = (uint32_t) Random() ;
+        else                        n = (uint32_t) ((Random() % (0xFFFFFFFFu / d->divisor + 1ULL)) * d->divisor - (Random() & 1)) ;
+
+        if (ThumbCall(cpu, fn, &n, 1) != THUMB_OK || cpu->r[0] != n / d->divisor)
+            {
+            wrong = Report("DIVU", d->divisor, n, cpu->r[0], n / d->divisor, wrong) ;
+            }
+        }
+    return wrong ;
+    }
+
+static uint64_t Random(void)
+    {
+    random_state ^= random_state << 13 ;
+    random_state ^= random_state >> 7 ;
+    random_state ^= random_state << 17 ;
+    return random_state ;
+    }
+
+static double Seconds(void)
+    {
+    struct timespec ts ;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return ts.tv_sec + 1e-9 * ts.tv_nsec ;
+    }
+
+static void Usage(void)
+    {
+    fprintf(stderr, "usage: divcheck [-a] [-n samples] [-d objdir]\n") ;
+    exit(1) ;
+    }
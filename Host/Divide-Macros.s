@@ -0,0 +1,53 @@
+/*
+    The DIVU macro of ../Common/divide.inc for each unsigned divisor in divcheck's
+    table (Divide-Check.c): uint32_t DivU<d>(uint32_t n) returns n / d. Assembled
+    by "make objects".
+*/
+        .syntax     unified
+        .cpu        cortex-m4
+        .text
+
+        .include    "divide.inc"
+
+        .macro      DIVIDER name, d
+        .global     \name
+        .thumb_func
+        .align
+\name:
+        DIVU        R2,R0,\d,R1
+        MOV         R0,R2
+        BX          LR
+        .ltorg
+        .endm
+        DIVIDER     DivU10,10
+        DIVIDER     DivU100,100
+        DIVIDER     DivU1000,1000
+        DIVIDER     DivU1000000,1000000
+        DIVIDER     DivU1,1
+        DIVIDER     DivU2,2
+        DIVIDER     DivU3,3
+        DIVIDER     DivU5,5
+        DIVIDER     DivU6,6
+        DIVIDER     DivU7,7
+        DIVIDER     DivU9,9
+        DIVIDER     DivU11,11
+        DIVIDER     DivU13,13
+        DIVIDER     DivU25,25
+        DIVIDER     DivU60,60
+        DIVIDER     DivU240,240
+        DIVIDER     DivU641,641
+        DIVIDER     DivU1023,1023
+        DIVIDER     DivU1024,1024
+        DIVIDER     DivU1025,1025
+        DIVIDER     DivU10000,10000
+        DIVIDER     DivU100000,100000
+        DIVIDER     DivU10000000,10000000
+        DIVIDER     DivU100000000,100000000
+        DIVIDER     DivU1000000000,1000000000
+        DIVIDER     DivU0x7FFFFFFF,0x7FFFFFFF
+        DIVIDER     DivU0x80000000,0x80000000
+        DIVIDER     DivU0x80000001,0x80000001
+        DIVIDER     DivU0xFFFFFFFE,0xFFFFFFFE
+        DIVIDER     DivU0xFFFFFFFF,0xFFFFFFFF
+
+        .end
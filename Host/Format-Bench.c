@@ -0,0 +1,181 @@
+/*
+    fmtbench: ../Common/format.c against the C library's snprintf on the kinds of
+    numbers the lab user interfaces print.
+
+        fmtbench [-n calls] [-s seed]
+
+    Each case formats the same random values both ways, checks that the strings
+    agree and reports nanoseconds per call for each and the speed-up. The
+    floating point cases give snprintf the double the labs used to pass and give
+    format.c the scaled integer they now pass instead. The exit status is 1 if any
+    string differs.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "format.h"
+
+#define TEXT_SIZE           64
+
+typedef struct
+    {
+    const char *            name ;
+    void                    (*Ours)(char *text, uint64_t value) ;
+    void                    (*Theirs)(char *text, uint64_t value) ;
+    uint64_t                (*Generate)(void) ;
+    } CASE ;
+
+static uint64_t             Random(void) ;
+static double               Seconds(void) ;
+static void                 Usage(void) ;
+
+static uint64_t             random_state = 88172645463325252ULL ;
+
+// Lab 5: "%5d" of an A/D reading
+static uint64_t ADCValue(void)                          { return Random() % 4096 ; }
+static void ADCOurs(char *text, uint64_t value)         { FormatString(text, TEXT_SIZE, "%5d", (int) value) ; }
+static void ADCTheirs(char *text, uint64_t value)       { snprintf(text, TEXT_SIZE, "%5d", (int) value) ; }
+
+// Lab 5: "%5.1f" of degrees C, now tenths of a degree as "%5.1q"
+static uint64_t TempValue(void)                         { return (uint64_t) (int64_t) ((int) (Random() % 2000) - 400) ; }
+static void TempOurs(char *text, uint64_t value)        { FormatString(text, TEXT_SIZE, "%5.1q", (int) value) ; }
+static void TempTheirs(char *text, uint64_t value)      { snprintf(text, TEXT_SIZE, "%5.1f", (int) value / 10.0) ; }
+
+// Lab 6 and Lab 7: "%u" counters behind a label
+static uint64_t CountValue(void)                        { return (uint32_t) Random() >> (Random() % 32) ; }
+static void CountOurs(char *text, uint64_t value)       { FormatString(text, TEXT_SIZE, "Total Moves: %u", (unsigned) value) ; }
+static void CountTheirs(char *text, uint64_t value)     { snprintf(text, TEXT_SIZE, "Total Moves: %u", (unsigned) value) ; }
+
+// Lab 7: "%.2fs" of elapsed seconds, now hundredths as "%.2qs"
+static uint64_t TimeValue(void)                         { return Random() % 100000 ; }
+static void TimeOurs(char *text, uint64_t value)        { FormatString(text, TEXT_SIZE, "  Elapsed:%.2qs", (int) value) ; }
+static void TimeTheirs(char *text, uint64_t value)      { snprintf(text, TEXT_SIZE, "  Elapsed:%.2fs", (int) value / 100.0) ; }
+
+// Lab 8: "%f" of ohms/1e3, 1e6 or 1e9 cut to 5 characters, and PRIu64 below that
+static uint64_t OhmsValue(void)
+    {
+    uint64_t ohms = 10 + Random() % 90 ;
+    for (int zeroes = Random() % 10; zeroes > 0; zeroes--) ohms *= 10 ;
+    return ohms - ohms / 20 * (Random() % 2) ;
+    }
+
+static void OhmsOurs(char *text, uint64_t value)
+    {
+    static const char *suffix[] = {" Ohms", " KiloOhms", " MegaOhms", " GigaOhms"} ;
+    char *end ;
+    int group ;
+
+    end = FormatEngineering(text, value, 5, &group) ;
+    strcpy(end, suffix[group]) ;
+    }
+
+static void OhmsTheirs(char *text, uint64_t value)
+    {
+    static const char *suffix[] = {" GigaOhms", " MegaOhms", " KiloOhms"} ;
+    static const double scale[] = {1e9, 1e6, 1e3} ;
+    static const uint64_t limit[] = {1000000000, 1000000, 1000} ;
+
+    for (int k = 0; k < 3; k++)
+        {
+        if (value < limit[k]) continue ;
+        snprintf(text, TEXT_SIZE, "%f", value / scale[k]) ;
+        text[5] = '\0' ;
+        if (text[4] == '.') text[4] = '\0' ;
+        strcat(text, suffix[k]) ;
+        return ;
+        }
+    snprintf(text, TEXT_SIZE, "%llu Ohms", (unsigned long long) value) ;
+    }
+
+// 64-bit values through the two-halves divide
+static uint64_t WideValue(void)                         { return Random() >> (Random() % 64) ; }
+static void WideOurs(char *text, uint64_t value)        { FormatString(text, TEXT_SIZE, "%llu", (unsigned long long) value) ; }
+static void WideTheirs(char *text, uint64_t value)      { snprintf(text, TEXT_SIZE, "%llu", (unsigned long long) value) ; }
+
+static void HexOurs(char *text, uint64_t value)         { FormatString(text, TEXT_SIZE, "0x%08X", (unsigned) value) ; }
+static void HexTheirs(char *text, uint64_t value)       { snprintf(text, TEXT_SIZE, "0x%08X", (unsigned) value) ; }
+
+static CASE                 cases[] =
+    {
+    {"%5d adc",             ADCOurs,    ADCTheirs,      ADCValue},
+    {"%5.1f temp",          TempOurs,   TempTheirs,     TempValue},
+    {"%u count",            CountOurs,  CountTheirs,    CountValue},
+    {"%.2f elapsed",        TimeOurs,   TimeTheirs,     TimeValue},
+    {"ohms (Lab 8 Value)",  OhmsOurs,   OhmsTheirs,     OhmsValue},
+    {"%llu",                WideOurs,   WideTheirs,     WideValue},
+    {"0x%08X",              HexOurs,    HexTheirs,      CountValue}
+    } ;
+
+int main(int argc, char **argv)
+    {
+    unsigned long calls = 1000000 ;
+    unsigned long mismatches = 0 ;
+    uint64_t *values ;
+
+    for (int k = 1; k < argc; k++)
+        {
+        if (strcmp(argv[k], "-n") == 0 && k + 1 < argc) calls = strtoul(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-s") == 0 && k + 1 < argc) random_state = strtoull(argv[++k], NULL, 0) | 1 ;
+        else Usage() ;
+        }
+    if (calls == 0) Usage() ;
+    values = malloc(calls * sizeof(uint64_t)) ;
+
+    printf("%-20s %10s %10s %12s %12s %8s\n", "case", "calls", "mismatch", "format ns", "snprintf ns", "speedup") ;
+    for (CASE *c = cases; c < cases + sizeof(cases)/sizeof(cases[0]); c++)
+        {
+        char ours[TEXT_SIZE], theirs[TEXT_SIZE] ;
+        unsigned long errors = 0 ;
+        double strt, ours_s, theirs_s ;
+
+        for (unsigned long n = 0; n < calls; n++) values[n] = c->Generate() ;
+
+        for (unsigned long n = 0; n < calls; n++)
+            {
+            c->Ours(ours, values[n]) ;
+            c->Theirs(theirs, values[n]) ;
+            if (strcmp(ours, theirs) == 0) continue ;
+            if (errors++ < 3) printf("    %llu: \"%s\" should be \"%s\"\n", (unsigned long long) values[n], ours, theirs) ;
+            }
+
+        strt = Seconds() ;
+        for (unsigned long n = 0; n < calls; n++) c->Ours(ours, values[n]) ;
+        ours_s = Seconds() - strt ;
+
+        strt = Seconds() ;
+        for (unsigned long n = 0; n < calls; n++) c->Theirs(theirs, values[n]) ;
+        theirs_s = Seconds() - strt ;
+
+        printf("%-20s %10lu %10lu %12.1f %12.1f %7.1fx\n", c->name, calls, errors,
+               1e9 * ours_s / calls, 1e9 * theirs_s / calls, theirs_s / ours_s) ;
+        mismatches += errors ;
+        }
+
+    free(values) ;
+    return mismatches != 0 ;
+    }
+
+static uint64_t Random(void)
+    {
+    random_state ^= random_state << 13 ;
+    random_state ^= random_state >> 7 ;
+    random_state ^= random_state << 17 ;
+    return random_state ;
+    }
+
+static double Seconds(void)
+    {
+    struct timespec ts ;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return ts.tv_sec + 1e-9 * ts.tv_nsec ;
+    }
+
+static void Usage(void)
+    {
+    fprintf(stderr, "usage: fmtbench [-n calls] [-s seed]\n") ;
+    exit(1) ;
+    }
@@ -0,0 +1,749 @@
+/*
+    Differential fuzzing of the lab assembly routines against their C references.
+
+        fuzz [-n calls] [-s seed] [-d objdir] [kernel...]
+
+    Every assembly routine in objdir (default build/arm, see "make objects") runs in
+    the Thumb-2 interpreter, and the __attribute__((weak)) C reference from the lab's
+    main program runs natively on the same inputs. The lab mains are linked in with
+    main() renamed, so the references are the very functions the labs fall back on.
+    Inputs mix uniformly random words, random magnitudes and edge values (0, 1, the
+    powers of two, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF, the neighbours of multiples
+    and quotients of ten ...).
+
+    For each routine the harness prints the number of calls and mismatches (with
+    the first few failing inputs), native C calls per second, interpreted calls per
+    second and the modelled Cortex-M4 cycles per call. The exit status is 1 if any
+    routine disagrees with its reference.
+
+    The Lab 4 routines only exist to be timed and have no reference to compare with;
+    Lab 2 has no assembly routines at all.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Thumb.h"
+
+#define BATCH               4096
+#define MAX_REPORTS         5
+
+#define NIBBLE_BYTES        41                  // 81 nibbles: one Sudoku grid
+#define NIBBLE_WORDS        11                  // the grid as Lab 7 stores it, storage[WORDS]
+#define CELL_STRIDE         240                 // Lab 6 cells live in the frame buffer
+#define CELL_WORDS          (60*CELL_STRIDE)
+#define CELL_ADRS           0xD0000000u
+#define ARRAY_WORDS         64                  // longest Div32X10Array/Mul32X10Array run
+#define ARRAY_GUARD         4                   // words past the end that must not change
+
+typedef struct
+    {
+    uint64_t                state ;
+    } RANDOM ;
+
+typedef struct KERNEL
+    {
+    const char *            name ;
+    const char *            object ;
+    int                     nargs ;
+    int                     result_words ;      // 0 for void, 1 for R0, 2 for R1:R0
+    unsigned                scale ;             // run calls/scale trials (slow routines)
+    void                    (*generate)(RANDOM *rng, uint32_t *args) ;
+    uint64_t                (*reference)(const uint32_t *args) ;
+    int                     (*memory)(struct KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials) ;
+    } KERNEL ;
+
+typedef struct
+    {
+    unsigned long long      calls ;
+    unsigned long long      mismatches ;
+    double                  c_seconds ;
+    double                  emu_seconds ;
+    unsigned long long      cycles ;
+    } TALLY ;
+
+// The C references, from the lab main programs and Host-Lab1A.c
+extern int                  Addition(int, int), Subtraction(int, int), Multiplication(int, int), Division(int, int) ;
+extern int32_t              Return32Bits(void) ;
+extern int64_t              Return64Bits(void) ;
+extern uint8_t              Add8Bits(uint8_t x, uint8_t y) ;
+extern uint32_t             FactSum32(uint32_t x, uint32_t y) ;
+extern uint32_t             XPlusGCD(uint32_t x, uint32_t y, uint32_t z) ;
+extern uint32_t             Factorial(uint32_t n) ;
+extern uint32_t             gcd(uint32_t u1, uint32_t u2) ;
+extern int32_t              MxPlusB(int32_t x, int32_t mtop, int32_t mbtm, int32_t b) ;
+extern void                 CopyCell(uint32_t *dst, uint32_t *src) ;
+extern void                 FillCell(uint32_t *dst, uint32_t pixel) ;
+extern uint32_t             GetNibble(void *nibbles, uint32_t which) ;
+extern void                 PutNibble(void *nibbles, uint32_t which, uint32_t value) ;
+extern void                 GetNibbles(uint8_t *bytes, void *nibbles, uint32_t count) ;
+extern void                 PutNibbles(void *nibbles, uint8_t *bytes, uint32_t count) ;
+extern uint32_t             Mul32X10(uint32_t multiplicand) ;
+extern uint64_t             Mul64X10(uint64_t multiplicand) ;
+extern uint32_t             Div32X10(uint32_t dividend) ;
+extern uint64_t             Div64X10(uint64_t dividend) ;
+extern uint64_t             DivMod64X10(uint64_t dividend, uint32_t *remainder) ;
+extern uint32_t             Tolerance64(uint32_t digits, int32_t exponent, uint32_t hundredths, uint64_t values[3]) ;
+extern void                 Mul32X10Array(uint32_t *dst, uint32_t *src, uint32_t count) ;
+extern void                 Div32X10Array(uint32_t *dst, uint32_t *src, uint32_t count) ;
+extern uint64_t             Bin2Bcd32(uint32_t binary) ;
+extern void                 Bin2Bcd64(uint64_t binary, uint32_t bcd[3]) ;
+extern char *               Bcd2Text(char *text, const uint32_t bcd[], unsigned words) ;
+
+static double               Now(void) ;
+static uint32_t             Random(RANDOM *rng) ;
+static uint32_t             Interesting(RANDOM *rng) ;
+static TALLY                RunValues(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials) ;
+static int                  CellTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials) ;
+static int                  NibbleTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials) ;
+static int                  NibblesTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials) ;
+static int                  ArrayTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials) ;
+static int                  RemainderTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials) ;
+static int                  ToleranceTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials) ;
+static int                  BcdTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials) ;
+static void                 HostFactorial(THUMB_CPU *cpu) ;
+static void                 HostGCD(THUMB_CPU *cpu) ;
+
+static const uint32_t       edges[] =
+    {
+    0, 1, 2, 3, 7, 9, 10, 11, 15, 16, 99, 100, 101, 255, 256, 65535, 65536,
+    0x19999999, 0x1999999A, 0x33333333, 0x66666666, 0x7FFFFFFE, 0x7FFFFFFF,
+    0x80000000, 0x80000001, 0x99999999, 0xCCCCCCCC, 0xFFFFFFF6, 0xFFFFFFFE, 0xFFFFFFFF
+    } ;
+
+static TALLY                memory_tally ;      // filled in by the memory trials
+
+// -------------------------------------------------------------------------
+// Input generators and reference adapters
+// -------------------------------------------------------------------------
+
+static void AnyWords(RANDOM *rng, uint32_t *args)
+    {
+    for (int k = 0; k < 4; k++) args[k] = Interesting(rng) ;
+    }
+
+static void Bytes(RANDOM *rng, uint32_t *args)
+    {
+    args[0] = Interesting(rng) & 0xFF ;
+    args[1] = Interesting(rng) & 0xFF ;
+    }
+
+static void Divisor(RANDOM *rng, uint32_t *args)
+    {
+    AnyWords(rng, args) ;
+    if (args[1] == 0 && (Random(rng) & 1)) args[1] = 1 ;
+    }
+
+// Factorial counts down from x + y one multiply at a time
+static void SmallSum(RANDOM *rng, uint32_t *args)
+    {
+    args[0] = Random(rng) % 20 ;
+    args[1] = Random(rng) % 20 ;
+    }
+
+// gcd() subtracts rather than divides and never ends with a zero operand
+static void GCDOperands(RANDOM *rng, uint32_t *args)
+    {
+    args[0] = Interesting(rng) ;
+    args[1] = 1 + Random(rng) % 2000 ;
+    args[2] = 1 + Random(rng) % 2000 ;
+    }
+
+// Nonzero denominator, and mtop*x*mbtm within 32 bits: past that the reference's
+// rounding sign is its own overflow, not a value to compare against. Each operand
+// is shifted down a random amount so small and large magnitudes both turn up.
+static void Line(RANDOM *rng, uint32_t *args)
+    {
+    int64_t dvnd ;
+
+    do
+        {
+        AnyWords(rng, args) ;
+        for (int k = 0; k < 3; k++) args[k] = (uint32_t) ((int32_t) args[k] >> (Random(rng) % 32)) ;
+        dvnd = (int64_t) (int32_t) args[0] * (int32_t) args[1] ;
+        }
+    while (args[2] == 0 || dvnd > INT32_MAX || dvnd < -INT32_MAX ||
+           llabs(dvnd * (int32_t) args[2]) > INT32_MAX) ;
+    }
+
+static uint64_t RefAddition(const uint32_t *a)          { return (uint32_t) Addition(a[0], a[1]) ; }
+static uint64_t RefSubtraction(const uint32_t *a)       { return (uint32_t) Subtraction(a[0], a[1]) ; }
+static uint64_t RefMultiplication(const uint32_t *a)    { return (uint32_t) Multiplication(a[0], a[1]) ; }
+static uint64_t RefDivision(const uint32_t *a)          { return (uint32_t) Division(a[0], a[1]) ; }
+static uint64_t RefReturn32Bits(const uint32_t *a)      { return (uint32_t) Return32Bits() ; }
+static uint64_t RefReturn64Bits(const uint32_t *a)      { return (uint64_t) Return64Bits() ; }
+static uint64_t RefAdd8Bits(const uint32_t *a)          { return Add8Bits(a[0], a[1]) ; }
+static uint64_t RefFactSum32(const uint32_t *a)         { return FactSum32(a[0], a[1]) ; }
+static uint64_t RefXPlusGCD(const uint32_t *a)          { return XPlusGCD(a[0], a[1], a[2]) ; }
+static uint64_t RefMxPlusB(const uint32_t *a)           { return (uint32_t) MxPlusB(a[0], a[1], a[2], a[3]) ; }
+static uint64_t RefMul32X10(const uint32_t *a)          { return Mul32X10(a[0]) ; }
+static uint64_t RefMul64X10(const uint32_t *a)          { return Mul64X10(((uint64_t) a[1] << 32) | a[0]) ; }
+static uint64_t RefDiv32X10(const uint32_t *a)          { return Div32X10(a[0]) ; }
+static uint64_t RefDiv64X10(const uint32_t *a)          { return Div64X10(((uint64_t) a[1] << 32) | a[0]) ; }
+static uint64_t RefBin2Bcd32(const uint32_t *a)         { return Bin2Bcd32(a[0]) ; }
+
+static KERNEL               kernels[] =
+    {
+    {"Addition",        "Lab1A-Calculator",     2, 1,    1, AnyWords,    RefAddition},
+    {"Subtraction",     "Lab1A-Calculator",     2, 1,    1, AnyWords,    RefSubtraction},
+    {"Multiplication",  "Lab1A-Calculator",     2, 1,    1, AnyWords,    RefMultiplication},
+    {"Division",        "Lab1A-Calculator",     2, 1,    1, Divisor,     RefDivision},
+    {"Return32Bits",    "Lab3B-Implementation", 0, 1,    1, AnyWords,    RefReturn32Bits},
+    {"Return64Bits",    "Lab3B-Implementation", 0, 2,    1, AnyWords,    RefReturn64Bits},
+    {"Add8Bits",        "Lab3B-Implementation", 2, 1,    1, Bytes,       RefAdd8Bits},
+    {"FactSum32",       "Lab3B-Implementation", 2, 1,   10, SmallSum,    RefFactSum32},
+    {"XPlusGCD",        "Lab3B-Implementation", 3, 1,  100, GCDOperands, RefXPlusGCD},
+    {"MxPlusB",         "Lab5C-Implementation", 4, 1,    1, Line,        RefMxPlusB},
+    {"CopyCell",        "Lab6C-Implementation", 2, 0, 2000, NULL,        NULL,   CellTrials},
+    {"FillCell",        "Lab6C-Implementation", 2, 0, 2000, NULL,        NULL,   CellTrials},
+    {"GetNibble",       "Lab7C-Implementation", 2, 1,   10, NULL,        NULL,   NibbleTrials},
+    {"PutNibble",       "Lab7C-Implementation", 3, 0,   10, NULL,        NULL,   NibbleTrials},
+    {"GetNibbles",      "Lab7C-Implementation", 3, 0,   10, NULL,        NULL,   NibblesTrials},
+    {"PutNibbles",      "Lab7C-Implementation", 3, 0,   10, NULL,        NULL,   NibblesTrials},
+    {"Mul32X10",        "Lab8C-Resistors",      1, 1,    1, AnyWords,    RefMul32X10},
+    {"Mul64X10",        "Lab8C-Resistors",      2, 2,    1, AnyWords,    RefMul64X10},
+    {"Div32X10",        "Lab8C-Resistors",      1, 1,    1, AnyWords,    RefDiv32X10},
+    {"Div64X10",        "Lab8C-Resistors",      2, 2,    1, AnyWords,    RefDiv64X10},
+    {"DivMod64X10",     "Lab8C-Resistors",      3, 2,    1, AnyWords,    NULL,   RemainderTrials},
+    {"Tolerance64",     "Lab8C-Resistors",      4, 1,    1, NULL,        NULL,   ToleranceTrials},
+    {"Mul32X10Array",   "Lab8C-Resistors",      3, 0,   10, NULL,        NULL,   ArrayTrials},
+    {"Div32X10Array",   "Lab8C-Resistors",      3, 0,   10, NULL,        NULL,   ArrayTrials},
+    {"Bin2Bcd32",       "bcd",                  1, 2,    1, AnyWords,    RefBin2Bcd32},
+    {"Bin2Bcd64",       "bcd",                  3, 0,    1, NULL,        NULL,   BcdTrials},
+    {"Bcd2Text",        "bcd",                  3, 1,    1, NULL,        NULL,   BcdTrials},
+    } ;
+
+#define KERNELS             (sizeof(kernels) / sizeof(kernels[0]))
+
+int main(int argc, char **argv)
+    {
+    const char *dir = "build/arm" ;
+    unsigned long long calls = 1000000 ;
+    RANDOM rng = {0x9E3779B97F4A7C15ULL} ;
+    char **names = NULL ;
+    int nnames = 0, failed = 0 ;
+    char loaded[KERNELS][64] ;
+    int nloaded = 0 ;
+    THUMB_CPU *cpu = ThumbCreate() ;
+
+    for (int k = 1; k < argc; k++)
+        {
+        if (strcmp(argv[k], "-n") == 0 && k + 1 < argc) calls = strtoull(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-s") == 0 && k + 1 < argc) rng.state = strtoull(argv[++k], NULL, 0) | 1 ;
+        else if (strcmp(argv[k], "-d") == 0 && k + 1 < argc) dir = argv[++k] ;
+        else if (argv[k][0] == '-')
+            {
+            fprintf(stderr, "usage: fuzz [-n calls] [-s seed] [-d objdir] [kernel...]\n") ;
+            return 2 ;
+            }
+        else
+            {
+            names = &argv[k] ;
+            nnames = argc - k ;
+            break ;
+            }
+        }
+
+    // Every object once, then link them as a unit; Lab 3 calls back into C
+    for (int k = 0; k < KERNELS; k++)
+        {
+        char path[512] ;
+        int seen = 0 ;
+        FILE *fp ;
+
+        for (int j = 0; j < nloaded; j++) seen |= strcmp(loaded[j], kernels[k].object) == 0 ;
+        if (seen) continue ;
+        strcpy(loaded[nloaded++], kernels[k].object) ;
+        snprintf(path, sizeof(path), "%s/%s.o", dir, kernels[k].object) ;
+        if ((fp = fopen(path, "rb")) == NULL) continue ;
+        fclose(fp) ;
+        ThumbLoadObject(cpu, path) ;
+        }
+    ThumbBind(cpu, "Factorial", HostFactorial) ;
+    ThumbBind(cpu, "gcd", HostGCD) ;
+    ThumbMap(cpu, CELL_ADRS, 4*2*CELL_WORDS, calloc(2*CELL_WORDS, 4)) ;
+    if (!ThumbLink(cpu)) return 2 ;
+    cpu->limit = 100000000 ;
+
+    printf("%-16s %10s %10s %14s %14s %12s\n", "routine", "calls", "mismatch", "C calls/s", "emu calls/s", "M4 cyc/call") ;
+    for (int k = 0; k < KERNELS; k++)
+        {
+        KERNEL *kernel = &kernels[k] ;
+        uint32_t fn = ThumbSymbol(cpu, kernel->name) ;
+        unsigned trials = calls / kernel->scale ? calls / kernel->scale : 1 ;
+        int wanted = nnames == 0 ;
+        TALLY t ;
+
+        for (int j = 0; j < nnames; j++) wanted |= strcmp(names[j], kernel->name) == 0 ;
+        if (!wanted) continue ;
+        if (fn == 0)
+            {
+            printf("%-16s skipped: no %s/%s.o\n", kernel->name, dir, kernel->object) ;
+            continue ;
+            }
+
+        if (kernel->memory != NULL)
+            {
+            memset(&memory_tally, 0, sizeof(memory_tally)) ;
+            kernel->memory(kernel, cpu, fn, &rng, trials) ;
+            t = memory_tally ;
+            }
+        else t = RunValues(kernel, cpu, fn, &rng, trials) ;
+
+        printf("%-16s %10llu %10llu %14.0f %14.0f %12.1f\n", kernel->name, t.calls, t.mismatches,
+               t.c_seconds > 0 ? t.calls / t.c_seconds : 0, t.emu_seconds > 0 ? t.calls / t.emu_seconds : 0,
+               t.calls ? (double) t.cycles / t.calls : 0) ;
+        if (t.mismatches != 0) failed = 1 ;
+        }
+
+    ThumbDestroy(cpu) ;
+    return failed ;
+    }
+
+// -------------------------------------------------------------------------
+// Trials
+// -------------------------------------------------------------------------
+
+static void Mismatch(TALLY *t, KERNEL *k, const uint32_t *args, uint64_t want, uint64_t got, THUMB_STATUS status)
+    {
+    if (t->mismatches++ >= MAX_REPORTS) return ;
+    printf("    %s(", k->name) ;
+    for (int j = 0; j < k->nargs; j++) printf("%s0x%08X", j ? ", " : "", args[j]) ;
+    if (status != THUMB_OK) printf(") faulted: %s\n", ThumbStatusText(status)) ;
+    else printf(") = 0x%llX, reference 0x%llX\n", (unsigned long long) got, (unsigned long long) want) ;
+    }
+
+// Batches of inputs through the reference, then the same batch through the
+// interpreter, so that the native timing is not swamped by the clock reads
+static TALLY RunValues(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials)
+    {
+    static uint32_t args[BATCH][4] ;
+    static uint64_t want[BATCH] ;
+    uint64_t mask = k->result_words == 2 ? ~0ULL : 0xFFFFFFFFULL ;
+    TALLY t ;
+
+    memset(&t, 0, sizeof(t)) ;
+    while (t.calls < trials)
+        {
+        unsigned n = trials - t.calls < BATCH ? trials - t.calls : BATCH ;
+        double start ;
+
+        for (unsigned j = 0; j < n; j++) k->generate(rng, args[j]) ;
+
+        start = Now() ;
+        for (unsigned j = 0; j < n; j++) want[j] = k->reference(args[j]) ;
+        t.c_seconds += Now() - start ;
+
+        start = Now() ;
+        for (unsigned j = 0; j < n; j++)
+            {
+            uint64_t before = cpu->cycles, got ;
+            THUMB_STATUS status = ThumbCall(cpu, fn, args[j], k->nargs) ;
+
+            t.cycles += cpu->cycles - before ;
+            got = (((uint64_t) cpu->r[1] << 32) | cpu->r[0]) & mask ;
+            if (status != THUMB_OK || got != (want[j] & mask)) Mismatch(&t, k, args[j], want[j] & mask, got, status) ;
+            }
+        t.emu_seconds += Now() - start ;
+        t.calls += n ;
+        }
+
+    return t ;
+    }
+
+// CopyCell/FillCell on random 60x60 cells of a two-cell-high strip, compared
+// against a native copy of the same strip after every call
+static int CellTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials)
+    {
+    uint32_t *guest = ThumbHost(cpu, CELL_ADRS, 4*2*CELL_WORDS) ;
+    uint32_t *native = malloc(4*2*CELL_WORDS) ;
+    int copy = strcmp(k->name, "CopyCell") == 0 ;
+    TALLY *t = &memory_tally ;
+
+    for (int j = 0; j < 2*CELL_WORDS; j++) guest[j] = Random(rng) ;
+    memcpy(native, guest, 4*2*CELL_WORDS) ;
+
+    for (unsigned n = 0; n < trials; n++)
+        {
+        uint32_t dst = 60*(Random(rng) % 4) ;          // one of the four cells in the top row
+        uint32_t src = CELL_WORDS + 60*(Random(rng) % 4) ;
+        uint32_t args[2] ;
+        THUMB_STATUS status ;
+        uint64_t before = cpu->cycles ;
+        double start ;
+
+        args[0] = CELL_ADRS + 4*dst ;
+        args[1] = copy ? CELL_ADRS + 4*src : Interesting(rng) ;
+
+        start = Now() ;
+        if (copy) CopyCell(native + dst, native + src) ;
+        else FillCell(native + dst, args[1]) ;
+        t->c_seconds += Now() - start ;
+
+        start = Now() ;
+        status = ThumbCall(cpu, fn, args, 2) ;
+        t->emu_seconds += Now() - start ;
+        t->cycles += cpu->cycles - before ;
+        t->calls++ ;
+
+        if (status != THUMB_OK || memcmp(native, guest, 4*2*CELL_WORDS) != 0)
+            {
+            Mismatch(t, k, args, 0, 0, status) ;
+            memcpy(guest, native, 4*2*CELL_WORDS) ;
+            }
+
+        // Scribble on the destination again so that every copy is checked
+        if (copy) for (int j = 0; j < 60; j++) native[dst + j*CELL_STRIDE + j] = guest[dst + j*CELL_STRIDE + j] = Random(rng) ;
+        }
+
+    free(native) ;
+    return 0 ;
+    }
+
+// GetNibble/PutNibble on a random 81-nibble grid, every nibble index
+static int NibbleTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials)
+    {
+    uint32_t adrs = ThumbAlloc(cpu, NIBBLE_BYTES) ;
+    uint8_t *guest = ThumbHost(cpu, adrs, NIBBLE_BYTES) ;
+    uint8_t native[NIBBLE_BYTES] ;
+    int put = strcmp(k->name, "PutNibble") == 0 ;
+    TALLY *t = &memory_tally ;
+
+    for (int j = 0; j < NIBBLE_BYTES; j++) native[j] = guest[j] = Random(rng) ;
+
+    for (unsigned n = 0; n < trials; n++)
+        {
+        uint32_t args[3] = {adrs, Random(rng) % 81, Random(rng) & 0xF} ;
+        uint32_t want = 0 ;
+        uint64_t before = cpu->cycles ;
+        THUMB_STATUS status ;
+        double start ;
+
+        start = Now() ;
+        if (put) PutNibble(native, args[1], args[2]) ;
+        else want = GetNibble(native, args[1]) ;
+        t->c_seconds += Now() - start ;
+
+        start = Now() ;
+        status = ThumbCall(cpu, fn, args, put ? 3 : 2) ;
+        t->emu_seconds += Now() - start ;
+        t->cycles += cpu->cycles - before ;
+        t->calls++ ;
+
+        if (status != THUMB_OK || memcmp(native, guest, NIBBLE_BYTES) != 0 || (!put && cpu->r[0] != want))
+            {
+            Mismatch(t, k, args, want, cpu->r[0], status) ;
+            memcpy(guest, native, NIBBLE_BYTES) ;
+            }
+        }
+
+    return 0 ;
+    }
+
+// GetNibbles/PutNibbles on 0 to 88 nibbles of a random grid, to and from bytes at
+// any alignment; every byte of both, including those past count, must agree
+static int NibblesTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials)
+    {
+    enum {BYTES = 8*NIBBLE_WORDS + 4} ;
+    uint32_t grid = ThumbAlloc(cpu, 4*NIBBLE_WORDS + BYTES) ;
+    uint8_t *guest = ThumbHost(cpu, grid, 4*NIBBLE_WORDS + BYTES) ;
+    uint32_t native_grid[NIBBLE_WORDS + BYTES/4] ;
+    uint8_t *native = (uint8_t *) native_grid ;
+    int put = strcmp(k->name, "PutNibbles") == 0 ;
+    TALLY *t = &memory_tally ;
+
+    for (unsigned n = 0; n < trials; n++)
+        {
+        uint32_t count = Random(rng) % (8*NIBBLE_WORDS + 1) ;
+        uint32_t offset = Random(rng) % 4 ;
+        uint32_t args[3] ;
+        uint64_t before = cpu->cycles ;
+        THUMB_STATUS status ;
+        double start ;
+
+        for (int j = 0; j < sizeof(native_grid); j++) native[j] = guest[j] = Random(rng) ;
+        if (put)
+            {
+            args[0] = grid ;
+            args[1] = grid + 4*NIBBLE_WORDS + offset ;
+            }
+        else
+            {
+            args[0] = grid + 4*NIBBLE_WORDS + offset ;
+            args[1] = grid ;
+            }
+        args[2] = count ;
+
+        start = Now() ;
+        if (put) PutNibbles(native, native + 4*NIBBLE_WORDS + offset, count) ;
+        else GetNibbles(native + 4*NIBBLE_WORDS + offset, native, count) ;
+        t->c_seconds += Now() - start ;
+
+        start = Now() ;
+        status = ThumbCall(cpu, fn, args, 3) ;
+        t->emu_seconds += Now() - start ;
+        t->cycles += cpu->cycles - before ;
+        t->calls++ ;
+
+        if (status != THUMB_OK || memcmp(native, guest, sizeof(native_grid)) != 0) Mismatch(t, k, args, 0, 0, status) ;
+        }
+
+    return 0 ;
+    }
+
+// Mul32X10Array/Div32X10Array on 0 to ARRAY_WORDS words, a third of them in
+// place; the words after the end must come back unchanged
+static int ArrayTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials)
+    {
+    enum {WORDS = 2*ARRAY_WORDS + 2*ARRAY_GUARD} ;
+    uint32_t adrs = ThumbAlloc(cpu, 4*WORDS) ;
+    uint32_t *guest = ThumbHost(cpu, adrs, 4*WORDS) ;
+    uint32_t native[WORDS] ;
+    int mul = strcmp(k->name, "Mul32X10Array") == 0 ;
+    TALLY *t = &memory_tally ;
+
+    for (unsigned n = 0; n < trials; n++)
+        {
+        uint32_t count = Random(rng) % (ARRAY_WORDS + 1) ;
+        uint32_t src = ARRAY_WORDS + ARRAY_GUARD ;
+        uint32_t dst = (Random(rng) % 3 == 0) ? src : 0 ;
+        uint32_t args[3] ;
+        uint64_t before = cpu->cycles ;
+        THUMB_STATUS status ;
+        double start ;
+
+        for (int j = 0; j < WORDS; j++) native[j] = guest[j] = Interesting(rng) ;
+        args[0] = adrs + 4*dst ;
+        args[1] = adrs + 4*src ;
+        args[2] = count ;
+
+        start = Now() ;
+        if (mul) Mul32X10Array(native + dst, native + src, count) ;
+        else Div32X10Array(native + dst, native + src, count) ;
+        t->c_seconds += Now() - start ;
+
+        start = Now() ;
+        status = ThumbCall(cpu, fn, args, 3) ;
+        t->emu_seconds += Now() - start ;
+        t->cycles += cpu->cycles - before ;
+        t->calls++ ;
+
+        if (status != THUMB_OK || memcmp(native, guest, sizeof(native)) != 0) Mismatch(t, k, args, 0, 0, status) ;
+        }
+
+    return 0 ;
+    }
+
+// DivMod64X10 with its remainder stored to guest memory; the quotient and the
+// remainder must both agree
+static int RemainderTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials)
+    {
+    uint32_t adrs = ThumbAlloc(cpu, 4) ;
+    uint32_t *guest = ThumbHost(cpu, adrs, 4) ;
+    TALLY *t = &memory_tally ;
+
+    for (unsigned n = 0; n < trials; n++)
+        {
+        uint32_t args[3], native ;
+        uint64_t dividend, want, got ;
+        uint64_t before = cpu->cycles ;
+        THUMB_STATUS status ;
+        double start ;
+
+        k->generate(rng, args) ;
+        args[2] = adrs ;
+        dividend = ((uint64_t) args[1] << 32) | args[0] ;
+        *guest = ~0u ;
+
+        start = Now() ;
+        want = DivMod64X10(dividend, &native) ;
+        t->c_seconds += Now() - start ;
+
+        start = Now() ;
+        status = ThumbCall(cpu, fn, args, 3) ;
+        t->emu_seconds += Now() - start ;
+        t->cycles += cpu->cycles - before ;
+        t->calls++ ;
+
+        got = ((uint64_t) cpu->r[1] << 32) | cpu->r[0] ;
+        if (status != THUMB_OK || got != want) Mismatch(t, k, args, want, got, status) ;
+        else if (*guest != native) Mismatch(t, k, args, native, *guest, status) ;
+        }
+
+    return 0 ;
+    }
+
+// Tolerance64 with its three results stored to guest memory. Mostly arguments in
+// range, the rest just past it on either side or anywhere; out of range, the
+// results must be left alone.
+static int ToleranceTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials)
+    {
+    uint32_t adrs = ThumbAlloc(cpu, 3*8) ;
+    uint64_t *guest = ThumbHost(cpu, adrs, 3*8) ;
+    TALLY *t = &memory_tally ;
+
+    for (unsigned n = 0; n < trials; n++)
+        {
+        uint32_t args[4], ok ;
+        uint64_t native[3], before = cpu->cycles ;
+        THUMB_STATUS status ;
+        double start ;
+
+        switch (Random(rng) % 4)
+            {
+            case 0:
+                args[0] = Interesting(rng) ;
+                args[1] = Interesting(rng) ;
+                args[2] = Interesting(rng) ;
+                break ;
+            case 1:
+                args[0] = 998 + Random(rng) % 4 ;
+                args[1] = (uint32_t) (int32_t) (-4 + (int) (Random(rng) % 16)) ;
+                args[2] = 9999 + Random(rng) % 3 ;
+                break ;
+            default:
+                args[0] = Random(rng) % 1000 ;
+                args[1] = (uint32_t) (int32_t) (-2 + (int) (Random(rng) % 12)) ;
+                args[2] = Random(rng) % 10001 ;
+                break ;
+            }
+        args[3] = adrs ;
+        memset(native, 0xA5, sizeof(native)) ;
+        memset(guest, 0xA5, 3*8) ;
+
+        start = Now() ;
+        ok = Tolerance64(args[0], (int32_t) args[1], args[2], native) ;
+        t->c_seconds += Now() - start ;
+
+        start = Now() ;
+        status = ThumbCall(cpu, fn, args, 4) ;
+        t->emu_seconds += Now() - start ;
+        t->cycles += cpu->cycles - before ;
+        t->calls++ ;
+
+        if (status != THUMB_OK || cpu->r[0] != ok) Mismatch(t, k, args, ok, cpu->r[0], status) ;
+        else
+            {
+            for (int j = 0; j < 3; j++)
+                {
+                if (guest[j] != native[j])
+                    {
+                    Mismatch(t, k, args, native[j], guest[j], status) ;
+                    break ;
+                    }
+                }
+            }
+        }
+
+    return 0 ;
+    }
+
+// Bin2Bcd64 on every magnitude and the powers of ten either side; Bcd2Text on
+// the BCD of the same numbers, from one to three words of it, at every alignment.
+// Bytes around the results must not change.
+static int BcdTrials(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials)
+    {
+    int text = strcmp(k->name, "Bcd2Text") == 0 ;
+    uint32_t bcd = ThumbAlloc(cpu, 4*3), adrs = ThumbAlloc(cpu, 32) ;
+    uint8_t *guest = ThumbHost(cpu, adrs, 32) ;
+    uint32_t *words = ThumbHost(cpu, bcd, 4*3) ;
+    TALLY *t = &memory_tally ;
+
+    for (unsigned n = 0; n < trials; n++)
+        {
+        uint32_t args[3], native[3], pick = Random(rng) ;
+        uint64_t binary = ((uint64_t) Interesting(rng) << 32) | Interesting(rng), before = cpu->cycles ;
+        uint8_t want[32] ;
+        THUMB_STATUS status ;
+        double start ;
+        char *end = NULL ;
+
+        if (pick & 1) binary >>= (pick >> 1) % 64 ;
+        else if (pick & 2)
+            {
+            binary = 1 ;
+            for (unsigned p = (pick >> 2) % 20; p > 0; p--) binary *= 10 ;
+            binary += (pick >> 8) % 3 - 1 ;
+            }
+        memset(want, 0xA5, sizeof(want)) ;
+        memset(guest, 0xA5, 32) ;
+
+        if (text)
+            {
+            Bin2Bcd64(binary, native) ;
+            memcpy(words, native, sizeof(native)) ;
+            args[0] = adrs + 4 + (pick >> 16) % 4 ;
+            args[1] = bcd ;
+            args[2] = 1 + (pick >> 20) % 3 ;
+            start = Now() ;
+            end = Bcd2Text((char *) want + args[0] - adrs, native, args[2]) ;
+            t->c_seconds += Now() - start ;
+            }
+        else
+            {
+            args[0] = (uint32_t) binary ;
+            args[1] = (uint32_t) (binary >> 32) ;
+            args[2] = adrs + 4 ;
+            start = Now() ;
+            Bin2Bcd64(binary, (uint32_t *) (want + 4)) ;
+            t->c_seconds += Now() - start ;
+            }
+
+        start = Now() ;
+        status = ThumbCall(cpu, fn, args, 3) ;
+        t->emu_seconds += Now() - start ;
+        t->cycles += cpu->cycles - before ;
+        t->calls++ ;
+
+        if (status != THUMB_OK || memcmp(want, guest, sizeof(want)) != 0) Mismatch(t, k, args, binary, 0, status) ;
+        else if (text && cpu->r[0] != adrs + (end - (char *) want)) Mismatch(t, k, args, adrs + (end - (char *) want), cpu->r[0], status) ;
+        }
+
+    return 0 ;
+    }
+
+// -------------------------------------------------------------------------
+// Helpers
+// -------------------------------------------------------------------------
+
+static void HostFactorial(THUMB_CPU *cpu)
+    {
+    cpu->r[0] = Factorial(cpu->r[0]) ;
+    }
+
+static void HostGCD(THUMB_CPU *cpu)
+    {
+    cpu->r[0] = gcd(cpu->r[0], cpu->r[1]) ;
+    }
+
+static double Now(void)
+    {
+    struct timespec ts ;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return ts.tv_sec + 1e-9 * ts.tv_nsec ;
+    }
+
+// xorshift64*
+static uint32_t Random(RANDOM *rng)
+    {
+    rng->state ^= rng->state >> 12 ;
+    rng->state ^= rng->state << 25 ;
+    rng->state ^= rng->state >> 27 ;
+    return (uint32_t) ((rng->state * 0x2545F4914F6CDD1DULL) >> 32) ;
+    }
+
+// An edge value, a random magnitude, or a uniformly random word
+static uint32_t Interesting(RANDOM *rng)
+    {
+    uint32_t pick = Random(rng) ;
+
+    switch (pick & 3)
+        {
+        case 0:  return edges[(pick >> 8) % (sizeof(edges) / sizeof(edges[0]))] + ((pick >> 2) & 1 ? (pick >> 3 & 1 ? 1 : -1) : 0) ;
+        case 1:  return Random(rng) >> ((pick >> 8) % 32) ;
+        default: return Random(rng) ;
+        }
+    }
@@ -0,0 +1,168 @@
+/*
+    glyphbench: ../Common/glyphs.c against DisplayStringAt() on the text the labs
+    redraw most often.
+
+        glyphbench [-n calls] [-s seed]
+
+    Each case draws the same random strings both ways into a cleared frame buffer,
+    checks that the pixels agree and reports nanoseconds per character for each and
+    the speed-up. The "cold" case empties the glyph cache before every string, so
+    it measures the cost of expanding the glyphs as well; the "thrash" case cycles
+    through more colors than the cache holds. The exit status is 1 if any pixel
+    differs.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "graphics.h"
+#include "glyphs.h"
+#include "Host.h"
+
+#define TEXT_SIZE           32
+#define FRAME_BYTES         (HOST_FRAME_WORDS * sizeof(uint32_t))
+
+typedef struct
+    {
+    const char *            name ;
+    HOST_FONT *             font ;
+    const char *            format ;        // '#' is replaced by a random digit
+    int                     colors ;        // foreground colors to cycle through
+    int                     cold ;          // GlyphFlush() before every string
+    } CASE ;
+
+extern void                 BSP_LCD_SetFont(HOST_FONT *Font) ;
+
+static void                 Draw(CASE *c, char *text, int n, int glyphs) ;
+static void                 Generate(CASE *c, char *text) ;
+static uint64_t             Random(void) ;
+static double               Seconds(void) ;
+static void                 Usage(void) ;
+
+static uint64_t             random_state = 88172645463325252ULL ;
+
+static const uint32_t       palette[] =
+    {
+    COLOR_BLACK, COLOR_BLUE, COLOR_RED, COLOR_DARKGREEN, COLOR_DARKMAGENTA,
+    COLOR_DARKCYAN, COLOR_BROWN, COLOR_DARKGRAY
+    } ;
+
+static CASE                 cases[] =
+    {
+    {"Lab 6 status",        &Font12,    "Total Moves: ####",        1,  0},
+    {"Lab 7 report",        &Font12,    "  Elapsed:##.##s",         1,  0},
+    {"Lab 5 readout",       &Font16,    "Temp: ##.# C",             1,  0},
+    {"Lab 7 digit",         &Font24,    "#",                        2,  0},
+    {"widget cell",         &Font16,    "#",                        1,  0},
+    {"cold",                &Font12,    "Total Moves: ####",        1,  1},
+    {"thrash",              &Font24,    "####",                     8,  0}
+    } ;
+
+int main(int argc, char **argv)
+    {
+    unsigned long calls = 100000 ;
+    unsigned long mismatches = 0 ;
+    uint32_t *frame = HostFrameBuffer() ;
+    uint32_t *expect = malloc(FRAME_BYTES) ;
+    char (*text)[TEXT_SIZE] ;
+
+    for (int k = 1; k < argc; k++)
+        {
+        if (strcmp(argv[k], "-n") == 0 && k + 1 < argc) calls = strtoul(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-s") == 0 && k + 1 < argc) random_state = strtoull(argv[++k], NULL, 0) | 1 ;
+        else Usage() ;
+        }
+    if (calls == 0) Usage() ;
+    text = malloc(calls * TEXT_SIZE) ;
+
+    printf("%-16s %10s %10s %12s %12s %8s\n", "case", "calls", "mismatch", "glyph ns/ch", "string ns/ch", "speedup") ;
+    for (CASE *c = cases; c < cases + sizeof(cases)/sizeof(cases[0]); c++)
+        {
+        unsigned long errors = 0 ;
+        unsigned long chars = 0 ;
+        double strt, ours_s, theirs_s ;
+
+        for (unsigned long n = 0; n < calls; n++)
+            {
+            Generate(c, text[n]) ;
+            chars += strlen(text[n]) ;
+            }
+
+        BSP_LCD_SetFont(c->font) ;
+        GlyphFlush() ;
+        for (unsigned long n = 0; n < calls && n < 1000; n++)
+            {
+            SetBackground(COLOR_LIGHTGRAY) ;
+            ClearDisplay() ;
+            Draw(c, text[n], n, 0) ;
+            memcpy(expect, frame, FRAME_BYTES) ;
+
+            SetBackground(COLOR_LIGHTGRAY) ;
+            ClearDisplay() ;
+            Draw(c, text[n], n, 1) ;
+            if (memcmp(expect, frame, FRAME_BYTES) == 0) continue ;
+            if (errors++ < 3) printf("    \"%s\" differs\n", text[n]) ;
+            }
+
+        strt = Seconds() ;
+        for (unsigned long n = 0; n < calls; n++) Draw(c, text[n], n, 1) ;
+        ours_s = Seconds() - strt ;
+
+        strt = Seconds() ;
+        for (unsigned long n = 0; n < calls; n++) Draw(c, text[n], n, 0) ;
+        theirs_s = Seconds() - strt ;
+
+        printf("%-16s %10lu %10lu %12.1f %12.1f %7.1fx\n", c->name, calls, errors,
+               1e9 * ours_s / chars, 1e9 * theirs_s / chars, theirs_s / ours_s) ;
+        mismatches += errors ;
+        }
+
+    free(text) ;
+    free(expect) ;
+    return mismatches != 0 ;
+    }
+
+// Each string goes to its own place on the screen in its own color, the same for both
+static void Draw(CASE *c, char *text, int n, int glyphs)
+    {
+    int x = (n * 37) % (XPIXELS - c->font->Width) ;
+    int y = (n * 53) % (YPIXELS - c->font->Height) ;
+
+    if (c->cold && glyphs) GlyphFlush() ;
+    SetForeground(palette[n % c->colors]) ;
+    SetBackground(COLOR_WHITE) ;
+    if (glyphs) GlyphString(x, y, text) ;
+    else DisplayStringAt(x, y, (uint8_t *) text) ;
+    }
+
+static void Generate(CASE *c, char *text)
+    {
+    const char *f = c->format ;
+
+    for (; *f != '\0'; f++) *text++ = (*f == '#') ? '0' + Random() % 10 : *f ;
+    *text = '\0' ;
+    }
+
+static uint64_t Random(void)
+    {
+    random_state ^= random_state << 13 ;
+    random_state ^= random_state >> 7 ;
+    random_state ^= random_state << 17 ;
+    return random_state ;
+    }
+
+static double Seconds(void)
+    {
+    struct timespec ts ;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return ts.tv_sec + 1e-9 * ts.tv_nsec ;
+    }
+
+static void Usage(void)
+    {
+    fprintf(stderr, "usage: glyphbench [-n calls] [-s seed]\n") ;
+    exit(1) ;
+    }
@@ -0,0 +1,94 @@
+/*
+    Fonts for the host stand-in. The board's run-time library uses the STM Cube fonts;
+    here a single 5x7 glyph set is scaled into each of the five cell sizes at start-up.
+    Tables use the same layout as the STM fonts: Height rows per character, each row
+    (Width + 7)/8 bytes, most-significant bit leftmost, characters ' ' through '~'.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "Host.h"
+
+#define FIRST_CHAR          ' '
+#define LAST_CHAR           '~'
+#define CHARS               (LAST_CHAR - FIRST_CHAR + 1)
+
+#define TABLE_SIZE(w, h)    (CHARS * (h) * (((w) + 7) / 8))
+
+// Classic 5x7 glyphs, one byte per column, bit 0 is the top row
+static const uint8_t        glyphs[CHARS][5] =
+    {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x08,0x2A,0x1C,0x2A,0x08}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},
+    {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06},
+    {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x49,0x49,0x7A},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x0C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},
+    {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x07,0x08,0x70,0x08,0x07}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00},
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},
+    {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x0C,0x52,0x52,0x52,0x3E},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},
+    {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x08,0x04,0x08,0x10,0x08}
+    } ;
+
+static uint8_t              table8[TABLE_SIZE(5, 8)] ;
+static uint8_t              table12[TABLE_SIZE(7, 12)] ;
+static uint8_t              table16[TABLE_SIZE(11, 16)] ;
+static uint8_t              table20[TABLE_SIZE(14, 20)] ;
+static uint8_t              table24[TABLE_SIZE(17, 24)] ;
+
+HOST_FONT                   Font8  = {table8,   5,  8} ;
+HOST_FONT                   Font12 = {table12,  7, 12} ;
+HOST_FONT                   Font16 = {table16, 11, 16} ;
+HOST_FONT                   Font20 = {table20, 14, 20} ;
+HOST_FONT                   Font24 = {table24, 17, 24} ;
+
+// Nearest-neighbor scale of each 5x7 glyph into a box inset from the cell edges
+static void BuildTable(HOST_FONT *font, uint8_t *table)
+    {
+    unsigned bytes = (font->Width + 7) / 8 ;
+    unsigned xoff = (font->Width > 5) ? 1 : 0 ;
+    unsigned yoff = (font->Height > 8) ? font->Height / 6 : 0 ;
+    unsigned boxw = font->Width - 2*xoff ;
+    unsigned boxh = (font->Height > 8) ? font->Height - 2*yoff - font->Height / 8 : 7 ;
+
+    memset(table, 0, TABLE_SIZE(font->Width, font->Height)) ;
+    for (unsigned c = 0; c < CHARS; c++)
+        {
+        uint8_t *rows = table + c * font->Height * bytes ;
+
+        for (unsigned y = 0; y < boxh; y++)
+            {
+            for (unsigned x = 0; x < boxw; x++)
+                {
+                unsigned gx = (x * 5) / boxw ;
+                unsigned gy = (y * 7) / boxh ;
+                unsigned px = x + xoff ;
+
+                if ((glyphs[c][gx] >> gy) & 1) rows[(y + yoff)*bytes + px/8] |= 0x80 >> (px % 8) ;
+                }
+            }
+        }
+    }
+
+void HostInitializeFonts(void)
+    {
+    BuildTable(&Font8,  table8) ;
+    BuildTable(&Font12, table12) ;
+    BuildTable(&Font16, table16) ;
+    BuildTable(&Font20, table20) ;
+    BuildTable(&Font24, table24) ;
+    }
@@ -0,0 +1,163 @@
+/*
+    Host stand-in for the graphics portion of the run-time library. Drawing follows the
+    conventions of the STM Cube LCD driver used on the board: text is drawn opaque in
+    the foreground/background colors, and DrawRect() puts the right and bottom edges at
+    x + width and y + height.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "graphics.h"
+#include "Host.h"
+
+#define FRAME               ((uint32_t *) HOST_FRAME_ADRS)
+
+static uint32_t             foreground = COLOR_BLACK ;
+static uint32_t             background = COLOR_WHITE ;
+static HOST_FONT *          font = &Font12 ;
+static int                  header_rows = 0 ;
+static int                  footer_rows = 0 ;
+
+uint32_t *HostFrameBuffer(void)
+    {
+    return FRAME ;
+    }
+
+HOST_FONT *HostGetFont(void)
+    {
+    return font ;
+    }
+
+void BSP_LCD_SetFont(HOST_FONT *Font)
+    {
+    font = Font ;
+    }
+
+HOST_FONT *BSP_LCD_GetFont(void)
+    {
+    return font ;
+    }
+
+void SetColor(uint32_t color)       { foreground = color ; }
+void SetForeground(uint32_t color)  { foreground = color ; }
+void SetBackground(uint32_t color)  { background = color ; }
+uint32_t GetForeground(void)        { return foreground ; }
+uint32_t GetBackground(void)        { return background ; }
+
+void DrawPixel(uint16_t x, uint16_t y, uint32_t color)
+    {
+    if (x < XPIXELS && y < YPIXELS) FRAME[x + XPIXELS*y] = color ;
+    }
+
+void HostSetMargins(int header, int footer)
+    {
+    header_rows = header ;
+    footer_rows = footer ;
+    }
+
+// Like the board, leave the header and footer drawn by InitializeHardware alone
+void ClearDisplay(void)
+    {
+    uint32_t *px = FRAME + XPIXELS*header_rows ;
+    int words = XPIXELS*(YPIXELS - header_rows - footer_rows) ;
+
+    for (int n = 0; n < words; n++) *px++ = background ;
+    }
+
+void FillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+    {
+    unsigned xmax = x + width ;
+    unsigned ymax = y + height ;
+
+    if (xmax > XPIXELS) xmax = XPIXELS ;
+    if (ymax > YPIXELS) ymax = YPIXELS ;
+    for (unsigned row = y; row < ymax; row++)
+        {
+        uint32_t *px = FRAME + XPIXELS*row ;
+        for (unsigned col = x; col < xmax; col++) px[col] = foreground ;
+        }
+    }
+
+void DrawHLine(uint16_t x, uint16_t y, uint16_t length)
+    {
+    FillRect(x, y, length, 1) ;
+    }
+
+void DrawVLine(uint16_t x, uint16_t y, uint16_t length)
+    {
+    FillRect(x, y, 1, length) ;
+    }
+
+void DrawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+    {
+    DrawHLine(x, y, width) ;
+    DrawHLine(x, y + height, width) ;
+    DrawVLine(x, y, height) ;
+    DrawVLine(x + width, y, height) ;
+    }
+
+void DrawLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+    {
+    int dx =  abs((int) x2 - (int) x1), sx = x1 < x2 ? 1 : -1 ;
+    int dy = -abs((int) y2 - (int) y1), sy = y1 < y2 ? 1 : -1 ;
+    int err = dx + dy ;
+    int x = x1, y = y1 ;
+
+    for (;;)
+        {
+        DrawPixel(x, y, foreground) ;
+        if (x == x2 && y == y2) break ;
+        if (2*err >= dy) { err += dy ; x += sx ; }
+        if (2*err <= dx) { err += dx ; y += sy ; }
+        }
+    }
+
+void DisplayChar(uint16_t x, uint16_t y, uint8_t c)
+    {
+    unsigned bytes = (font->Width + 7) / 8 ;
+    const uint8_t *bits ;
+
+    if (c < ' ' || c > '~') c = ' ' ;
+    bits = font->table + (c - ' ') * font->Height * bytes ;
+
+    for (unsigned row = 0; row < font->Height; row++, bits += bytes)
+        {
+        for (unsigned col = 0; col < font->Width; col++)
+            {
+            int on = (bits[col / 8] >> (7 - col % 8)) & 1 ;
+            DrawPixel(x + col, y + row, on ? foreground : background) ;
+            }
+        }
+    }
+
+void DisplayStringAt(uint16_t x, uint16_t y, uint8_t *text)
+    {
+    while (*text != '\0' && x + font->Width <= XPIXELS)
+        {
+        DisplayChar(x, y, *text++) ;
+        x += font->Width ;
+        }
+    }
+
+int HostDumpFrame(const char *path)
+    {
+    FILE *fp = fopen(path, "wb") ;
+    uint32_t *px = FRAME ;
+
+    if (fp == NULL)
+        {
+        perror(path) ;
+        return 0 ;
+        }
+
+    fprintf(fp, "P6\n%d %d\n255\n", XPIXELS, YPIXELS) ;
+    for (int n = 0; n < HOST_FRAME_WORDS; n++, px++)
+        {
+        fputc((*px >> 16) & 0xFF, fp) ;
+        fputc((*px >>  8) & 0xFF, fp) ;
+        fputc((*px >>  0) & 0xFF, fp) ;
+        }
+
+    return fclose(fp) == 0 ;
+    }
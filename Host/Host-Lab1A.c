@@ -0,0 +1,18 @@
+/*
+    C equivalents of the Lab 1A assembly functions (Lab1A-Calculator.s) so that the
+    calculator can be built and run with the host stand-in. Lab1A-Main.c declares these
+    as plain externs rather than providing weak references of its own.
+*/
+
+int Addition(int op1, int op2)          { return op1 + op2 ; }
+int Subtraction(int op1, int op2)       { return op1 - op2 ; }
+int Multiplication(int op1, int op2)    { return op1 * op2 ; }
+
+// SDIV on the Cortex-M4 returns 0 for a zero divisor (divide-by-zero trap disabled)
+// and wraps 0x80000000 / -1 back to 0x80000000 rather than trapping
+int Division(int op1, int op2)
+    {
+    if (op2 == 0) return 0 ;
+    if (op2 == -1) return (int) (0u - (unsigned) op1) ;
+    return op1 / op2 ;
+    }
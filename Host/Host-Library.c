@@ -0,0 +1,374 @@
+/*
+    Host stand-in for the run-time library: start-up, the memory-mapped peripheral
+    regions the lab programs touch directly, the cycle counter, the random number
+    generator and the blue push button.
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "library.h"
+#include "graphics.h"
+#include "touch.h"
+#include "Host.h"
+
+typedef struct
+    {
+    uintptr_t               base ;
+    size_t                  size ;
+    char *                  name ;
+    } REGION ;
+
+typedef struct
+    {
+    uint32_t                SR ;
+    uint32_t                CR[2] ;
+    uint32_t                SMPR[2] ;
+    uint32_t                JOFR[4] ;
+    uint32_t                HTR ;
+    uint32_t                LTR ;
+    uint32_t                SQR[3] ;
+    uint32_t                JSQR ;
+    uint32_t                JDR[4] ;
+    uint32_t                DR ;
+    } ADC_CHANNEL ;
+
+typedef struct
+    {
+    int16_t                 VREFIN_CAL ;
+    int16_t                 TEMP_3V3_030C ;
+    int16_t                 TEMP_3V3_110C ;
+    } ADC_CAL ;
+
+#define ADC1                ((volatile ADC_CHANNEL *)   0x40012000)
+#define CALIBRATION         ((volatile ADC_CAL *)       0x1FFF7A2A)
+#define DWT_CYCCNT          ((volatile uint32_t *)      0xE0001004)
+#define GPIOG_ODR           ((volatile uint32_t *)      0x40021814)
+#define TIM7_CR1            ((volatile uint32_t *)      0x40001400)
+#define TIM7_DIER           ((volatile uint32_t *)      0x4000140C)
+#define TIM7_SR             ((volatile uint32_t *)      0x40001410)
+#define TIM7_PSC            ((volatile uint32_t *)      0x40001428)
+#define TIM7_ARR            ((volatile uint32_t *)      0x4000142C)
+#define NVIC_ISER1          ((volatile uint32_t *)      0xE000E104)
+
+#define ADC_EOC             (1 << 1)
+#define ADC_SWSTART         (1 << 30)
+#define ADC_IN17            17
+#define ADC_IN18            18
+
+#define CAL_VREFIN          1520
+#define CAL_030C            930
+#define CAL_110C            1200
+
+#define LED_GRN             (1 << 13)
+#define LED_RED             (1 << 14)
+
+#define TIM_CEN             (1 << 0)
+#define TIM_UIE             (1 << 0)
+#define TIM_UIF             (1 << 0)
+#define TIM7_ISER1          (1 << (55 - 32))
+#define TIM7_CLOCK_MHZ      84
+
+#define IDLE_EXIT_NS        500000000ULL
+
+static void                 EmitProfile(char *line) ;
+static void                 MapRegions(void) ;
+static void                 SimulateADC(uint64_t now) ;
+static int                  SimulateTimer(uint64_t now) ;
+static void                 Shutdown(void) ;
+
+static REGION               regions[] =
+    {
+    {0x1FFF7000, 0x00001000, "system memory (calibration)"},
+    {0x40000000, 0x00030000, "APB/AHB1 peripherals"},
+    {0xD0000000, 0x00100000, "SDRAM (frame buffer)"},
+    {0xE0000000, 0x00010000, "system control space"}
+    } ;
+
+static uint64_t             start_ns ;
+static uint64_t             timeout_ns ;
+static uint32_t             random_state = 2463534242u ;
+static uint32_t             leds = 0 ;
+static int                  initialized = 0 ;
+static FILE *               profile = NULL ;
+static int                  scripted = 0 ;
+static int                  in_interrupt = 0 ;
+static uint64_t             timer_due = 0 ;
+static uint64_t             idle_since = 0 ;
+
+// Only programs linked with ../Common/profile.c have regions to report
+extern void                 ProfileCSV(void (*Emit)(char *line)) __attribute__((weak)) ;
+
+// Only programs linked with ../Common/timers.c have a timer interrupt to take
+extern void                 TIM7_IRQHandler(void) __attribute__((weak)) ;
+
+__attribute__((constructor)) static void HostStartup(void)
+    {
+    char *env ;
+
+    MapRegions() ;
+    HostInitializeFonts() ;
+
+    CALIBRATION->VREFIN_CAL    = CAL_VREFIN ;
+    CALIBRATION->TEMP_3V3_030C = CAL_030C ;
+    CALIBRATION->TEMP_3V3_110C = CAL_110C ;
+
+    start_ns = HostNanoseconds() ;
+
+    if ((env = getenv("HOST_SEED")) != NULL && *env != '\0')
+        {
+        random_state = (uint32_t) strtoul(env, NULL, 0) ;
+        if (random_state == 0) random_state = 1 ;
+        }
+    if ((env = getenv("HOST_TIMEOUT")) != NULL) timeout_ns = 1000000ULL * strtoull(env, NULL, 0) ;
+    if ((env = getenv("HOST_SCRIPT")) != NULL && *env != '\0')
+        {
+        HostScriptLoad(env) ;
+        scripted = 1 ;
+        }
+
+    atexit(Shutdown) ;
+    }
+
+void InitializeHardware(char *header, char *footer)
+    {
+    extern void BSP_LCD_SetFont(HOST_FONT *) ;
+    HOST_FONT *font ;
+    int x ;
+
+    memset(HostFrameBuffer(), 0xFF, 4*HOST_FRAME_WORDS) ;
+
+    if (header != NULL)
+        {
+        font = (16 + 11*strlen(header) <= XPIXELS) ? &Font16 : &Font12 ;
+        SetForeground(COLOR_BLUE) ;
+        FillRect(0, 0, XPIXELS, 48) ;
+        BSP_LCD_SetFont(font) ;
+        SetForeground(COLOR_WHITE) ;
+        SetBackground(COLOR_BLUE) ;
+        x = (XPIXELS - (int) (font->Width*strlen(header))) / 2 ;
+        DisplayStringAt(x < 0 ? 0 : x, (48 - font->Height) / 2, (uint8_t *) header) ;
+        }
+
+    if (footer != NULL)
+        {
+        font = &Font12 ;
+        SetForeground(COLOR_BLUE) ;
+        FillRect(0, YPIXELS - 16, XPIXELS, 16) ;
+        BSP_LCD_SetFont(font) ;
+        SetForeground(COLOR_WHITE) ;
+        SetBackground(COLOR_BLUE) ;
+        x = (XPIXELS - (int) (font->Width*strlen(footer))) / 2 ;
+        DisplayStringAt(x < 0 ? 0 : x, YPIXELS - 14, (uint8_t *) footer) ;
+        }
+
+    HostSetMargins(header != NULL ? 48 : 0, footer != NULL ? 16 : 0) ;
+    BSP_LCD_SetFont(&Font12) ;
+    SetForeground(COLOR_BLACK) ;
+    SetBackground(COLOR_WHITE) ;
+    initialized = 1 ;
+    }
+
+uint64_t HostNanoseconds(void)
+    {
+    struct timespec ts ;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return 1000000000ULL * ts.tv_sec + ts.tv_nsec ;
+    }
+
+uint32_t GetClockCycleCount(void)
+    {
+    uint64_t elapsed = HostNanoseconds() - start_ns ;
+    uint32_t cycles = (uint32_t) ((elapsed * HOST_CPU_MHZ) / 1000) ;
+
+    *DWT_CYCCNT = cycles ;
+    HostPoll() ;
+    return cycles ;
+    }
+
+uint32_t GetRandomNumber(void)
+    {
+    // Marsaglia xorshift32: deterministic for a given HOST_SEED
+    random_state ^= random_state << 13 ;
+    random_state ^= random_state >> 17 ;
+    random_state ^= random_state << 5 ;
+    return random_state ;
+    }
+
+int PushButtonPressed(void)
+    {
+    HostPoll() ;
+    return HostButtonDown() ;
+    }
+
+void WaitForPushButton(void)
+    {
+    const struct timespec nap = {0, 1000000} ;
+
+    while (!PushButtonPressed())
+        {
+        if (HostScriptDone()) HostExit(0) ;
+        nanosleep(&nap, NULL) ;
+        }
+    while (PushButtonPressed()) nanosleep(&nap, NULL) ;
+    }
+
+void CallReturnOverhead(void)
+    {
+    }
+
+unsigned CountCycles(void *function, void *iparams, void *fparams, void *results)
+    {
+    typedef uint32_t (*KERNEL)(uint32_t, uint32_t, uint32_t, uint32_t, float, float, float, float) ;
+    uint32_t *ip = (uint32_t *) iparams ;
+    float *fp = (float *) fparams ;
+    uint32_t *rp = (uint32_t *) results ;
+    uint32_t strt, stop, rtn ;
+
+    strt = GetClockCycleCount() ;
+    rtn = ((KERNEL) function)(ip[0], ip[1], ip[2], ip[3], fp[0], fp[1], fp[2], fp[3]) ;
+    stop = GetClockCycleCount() ;
+    if (rp != NULL) rp[0] = rtn ;
+
+    return stop - strt ;
+    }
+
+void HostPoll(void)
+    {
+    uint64_t now = HostNanoseconds() - start_ns ;
+
+    if (!SimulateTimer(now)) HostScriptPoll(now / 1000000) ;
+    SimulateADC(now) ;
+
+    if (initialized && (*GPIOG_ODR & (LED_GRN | LED_RED)) != leds)
+        {
+        leds = *GPIOG_ODR & (LED_GRN | LED_RED) ;
+        fprintf(stderr, "host: LEDs green=%d red=%d\n", (leds & LED_GRN) != 0, (leds & LED_RED) != 0) ;
+        }
+
+    if (timeout_ns != 0 && now >= timeout_ns) HostExit(0) ;
+    }
+
+// WFI: sleep until the next timer interrupt is due and take it. Once a script has
+// run out, a program that keeps going back to sleep exits as if "quit" had been given.
+void HostWaitForInterrupt(void)
+    {
+    uint64_t now = HostNanoseconds() - start_ns ;
+    uint64_t wake = (timer_due > now) ? timer_due : now + 1000000 ;
+    struct timespec nap ;
+
+    if (scripted && HostScriptDone())
+        {
+        if (idle_since == 0) idle_since = now ;
+        else if (now - idle_since >= IDLE_EXIT_NS) HostExit(0) ;
+        }
+
+    nap.tv_sec = (wake - now) / 1000000000 ;
+    nap.tv_nsec = (wake - now) % 1000000000 ;
+    nanosleep(&nap, NULL) ;
+    HostPoll() ;
+    }
+
+void HostExit(int status)
+    {
+    exit(status) ;
+    }
+
+static void Shutdown(void)
+    {
+    char *path = getenv("HOST_DUMP") ;
+
+    if (path != NULL && *path != '\0') HostDumpFrame(path) ;
+
+    path = getenv("HOST_PROFILE") ;
+    if (ProfileCSV != NULL && path != NULL && *path != '\0')
+        {
+        if ((profile = fopen(path, "w")) == NULL) perror(path) ;
+        else
+            {
+            ProfileCSV(EmitProfile) ;
+            fclose(profile) ;
+            }
+        }
+    fflush(stdout) ;
+    }
+
+static void EmitProfile(char *line)
+    {
+    fputs(line, profile) ;
+    }
+
+static void MapRegions(void)
+    {
+    REGION *region = regions ;
+
+    for (int which = 0; which < sizeof(regions)/sizeof(regions[0]); which++, region++)
+        {
+        void *adrs = mmap((void *) region->base, region->size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) ;
+
+        if (adrs == (void *) region->base) continue ;
+        fprintf(stderr, "host: cannot map %s at 0x%08lX\n", region->name, (unsigned long) region->base) ;
+        exit(255) ;
+        }
+    }
+
+// TIM7 update interrupts at the rate its prescaler and reload registers ask for. Late
+// ones are all taken on the next poll, and the script advances a tick at a time with
+// them, so the interrupt handler sees scripted input at the same tick on every run.
+// Returns 1 while the timer is running (the script is then advanced only here).
+static int SimulateTimer(uint64_t now)
+    {
+    uint64_t period ;
+
+    if (TIM7_IRQHandler == NULL) return 0 ;
+    if (in_interrupt) return 1 ;
+    if (!(*TIM7_CR1 & TIM_CEN) || !(*TIM7_DIER & TIM_UIE) || !(*NVIC_ISER1 & TIM7_ISER1))
+        {
+        timer_due = 0 ;
+        return 0 ;
+        }
+
+    period = (uint64_t) (*TIM7_PSC + 1) * (*TIM7_ARR + 1) * 1000 / TIM7_CLOCK_MHZ ;
+    if (timer_due == 0) timer_due = now + period ;
+
+    in_interrupt = 1 ;
+    while (now >= timer_due)
+        {
+        HostScriptPoll(timer_due / 1000000) ;
+        *TIM7_SR |= TIM_UIF ;
+        TIM7_IRQHandler() ;
+        timer_due += period ;
+        }
+    in_interrupt = 0 ;
+    return 1 ;
+    }
+
+// The lab programs start a conversion and then poll the status register, so a
+// conversion simply completes the next time the program looks at the clock.
+static void SimulateADC(uint64_t now)
+    {
+    int32_t reading ;
+
+    if ((ADC1->CR[1] & ADC_SWSTART) == 0) return ;
+
+    if (ADC1->SQR[2] == ADC_IN17) reading = CAL_VREFIN ;
+    else if (ADC1->SQR[2] == ADC_IN18)
+        {
+        // Slow triangle wave between about 24C and 28C plus a little noise
+        int32_t phase = (int32_t) ((now / 10000000) % 400) ;
+        int32_t degX100 = 2400 + (phase < 200 ? 2*phase : 2*(400 - phase)) ;
+        reading = CAL_030C + ((degX100 - 3000) * (CAL_110C - CAL_030C)) / 8000 ;
+        reading += (int32_t) ((now / 1000) % 3) - 1 ;
+        }
+    else reading = 0 ;
+
+    ADC1->DR = reading ;
+    ADC1->SR |= ADC_EOC ;
+    ADC1->CR[1] &= ~ADC_SWSTART ;
+    }
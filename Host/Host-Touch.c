@@ -0,0 +1,163 @@
+/*
+    Host stand-in for the touch screen and the scripted input source that drives both
+    the touch screen and the blue push button. The script format is described in Host.h.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "touch.h"
+#include "Host.h"
+
+typedef enum {EV_TOUCH, EV_RELEASE, EV_BTN_DOWN, EV_BTN_UP, EV_DUMP, EV_QUIT} EVENT_TYPE ;
+
+typedef struct
+    {
+    uint32_t                delay ;     // msec after previous event took effect
+    EVENT_TYPE              type ;
+    int                     x ;
+    int                     y ;
+    char *                  path ;
+    } SCRIPT_EVENT ;
+
+static SCRIPT_EVENT *       script = NULL ;
+static int                  events = 0 ;
+static int                  next = 0 ;
+static uint64_t             due = 0 ;
+static int                  touched = 0 ;
+static int                  touch_x = 0 ;
+static int                  touch_y = 0 ;
+static int                  button = 0 ;
+
+static void                 Append(uint32_t delay, EVENT_TYPE type, int x, int y, char *path) ;
+
+void HostScriptLoad(const char *path)
+    {
+    FILE *fp = fopen(path, "r") ;
+    char line[300] ;
+    int lineno = 0 ;
+
+    if (fp == NULL)
+        {
+        perror(path) ;
+        exit(255) ;
+        }
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+        {
+        char cmd[20], arg[256] ;
+        unsigned delay ;
+        int x, y, n ;
+
+        lineno++ ;
+        if (strchr(line, '#') != NULL) *strchr(line, '#') = '\0' ;
+        n = sscanf(line, "%u %19s %255s", &delay, cmd, arg) ;
+        if (n <= 0) continue ;
+
+        if (n >= 2 && strcmp(cmd, "touch") == 0 && sscanf(line, "%*u %*s %d %d", &x, &y) == 2)
+            {
+            Append(delay, EV_TOUCH, x, y, NULL) ;
+            }
+        else if (n == 2 && strcmp(cmd, "release") == 0) Append(delay, EV_RELEASE, 0, 0, NULL) ;
+        else if (n == 2 && strcmp(cmd, "button") == 0)
+            {
+            Append(delay, EV_BTN_DOWN, 0, 0, NULL) ;
+            Append(100, EV_BTN_UP, 0, 0, NULL) ;
+            }
+        else if (n == 3 && strcmp(cmd, "button") == 0 && strcmp(arg, "down") == 0) Append(delay, EV_BTN_DOWN, 0, 0, NULL) ;
+        else if (n == 3 && strcmp(cmd, "button") == 0 && strcmp(arg, "up") == 0) Append(delay, EV_BTN_UP, 0, 0, NULL) ;
+        else if (n == 3 && strcmp(cmd, "dump") == 0) Append(delay, EV_DUMP, 0, 0, strdup(arg)) ;
+        else if (n == 2 && strcmp(cmd, "quit") == 0) Append(delay, EV_QUIT, 0, 0, NULL) ;
+        else
+            {
+            fprintf(stderr, "%s:%d: bad script line\n", path, lineno) ;
+            exit(255) ;
+            }
+        }
+
+    fclose(fp) ;
+    if (events > 0) due = script[0].delay ;
+    }
+
+void HostScriptPoll(uint64_t now)
+    {
+    while (next < events && now >= due)
+        {
+        SCRIPT_EVENT *event = &script[next++] ;
+
+        switch (event->type)
+            {
+            case EV_TOUCH:
+                touched = 1 ;
+                touch_x = event->x ;
+                touch_y = event->y ;
+                break ;
+            case EV_RELEASE:
+                touched = 0 ;
+                break ;
+            case EV_BTN_DOWN:
+                button = 1 ;
+                break ;
+            case EV_BTN_UP:
+                button = 0 ;
+                break ;
+            case EV_DUMP:
+                HostDumpFrame(event->path) ;
+                break ;
+            case EV_QUIT:
+                HostExit(0) ;
+                break ;
+            }
+
+        if (next < events) due = now + script[next].delay ;
+        }
+    }
+
+int HostScriptDone(void)
+    {
+    return next >= events && !button ;
+    }
+
+int HostButtonDown(void)
+    {
+    return button ;
+    }
+
+int HostTouchDown(int *x, int *y)
+    {
+    if (x != NULL) *x = touch_x ;
+    if (y != NULL) *y = touch_y ;
+    return touched ;
+    }
+
+void TS_Init(void)
+    {
+    }
+
+int TS_Touched(void)
+    {
+    HostPoll() ;
+    return touched ;
+    }
+
+int TS_GetX(void)
+    {
+    return touch_x ;
+    }
+
+int TS_GetY(void)
+    {
+    return touch_y ;
+    }
+
+static void Append(uint32_t delay, EVENT_TYPE type, int x, int y, char *path)
+    {
+    script = realloc(script, (events + 1) * sizeof(SCRIPT_EVENT)) ;
+    script[events].delay = delay ;
+    script[events].type = type ;
+    script[events].x = x ;
+    script[events].y = y ;
+    script[events].path = path ;
+    events++ ;
+    }
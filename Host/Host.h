@@ -0,0 +1,71 @@
+/*
+    Host-only services behind the library.h/graphics.h/touch.h stand-ins.
+
+    Environment variables read at start-up:
+
+        HOST_SCRIPT=<file>      Scripted touch screen / push button input (see below)
+        HOST_DUMP=<file.ppm>    Frame buffer written here when the program exits
+        HOST_TIMEOUT=<msec>     Exit after this much run time (0 = never)
+        HOST_SEED=<number>      Seed for GetRandomNumber() (default is fixed)
+        HOST_PROFILE=<file.csv> Profiler regions (profile.h) written here at exit
+
+    Each line of a script is "<msec> <command> [args]", where <msec> is the delay
+    after the previous line took effect. Blank lines and '#' comments are ignored.
+
+        touch <x> <y>           Finger down (or moved) at x,y
+        release                 Finger lifted
+        button                  Blue push button pressed for 100 msec
+        button down|up          Blue push button held / let go
+        dump <file.ppm>         Write the frame buffer as a binary PPM image
+        quit                    Exit the program
+
+    A program that blocks in WaitForPushButton() after the last line of the script
+    has taken effect exits as if "quit" had been given. So does one that has spent
+    half a second going back to sleep in WFI (HostWaitForInterrupt) since then.
+
+    Programs linked with ../Common/timers.c get the TIM7 update interrupt that module
+    programs, taken at the rate of its prescaler and reload registers whenever the
+    program calls into the library or sleeps. While the timer runs, the script steps
+    forward with its interrupts, so scripted input lands on the same tick every run.
+*/
+
+#ifndef __HOST_H
+#define __HOST_H
+
+#include <stdint.h>
+
+#define HOST_CPU_MHZ        168
+
+#define HOST_FRAME_ADRS     0xD0000000
+#define HOST_FRAME_WORDS    (240*320)
+
+typedef struct
+    {
+    const uint8_t *         table ;
+    const uint16_t          Width ;
+    const uint16_t          Height ;
+    } HOST_FONT ;
+
+extern HOST_FONT            Font8, Font12, Font16, Font20, Font24 ;
+
+// Host-Library.c
+void                        HostExit(int status) ;
+uint64_t                    HostNanoseconds(void) ;
+void                        HostPoll(void) ;
+void                        HostWaitForInterrupt(void) ;
+
+// Host-Graphics.c
+uint32_t *                  HostFrameBuffer(void) ;
+HOST_FONT *                 HostGetFont(void) ;
+int                         HostDumpFrame(const char *path) ;
+void                        HostInitializeFonts(void) ;
+void                        HostSetMargins(int header, int footer) ;
+
+// Host-Touch.c
+int                         HostButtonDown(void) ;
+int                         HostScriptDone(void) ;
+void                        HostScriptLoad(const char *path) ;
+void                        HostScriptPoll(uint64_t now) ;
+int                         HostTouchDown(int *x, int *y) ;
+
+#endif
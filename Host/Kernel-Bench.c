@@ -0,0 +1,654 @@
+/*
+    kernelbench: every lab kernel, in both its versions, on the inputs the labs
+    actually give it, with the results as JSON for tracking across changes.
+
+        kernelbench [-n calls] [-s seed] [-d objdir] [kernel...] > bench.json
+
+    The reference version of a kernel is the lab's __attribute__((weak)) C function,
+    linked in from the lab main program with main() renamed (as for fuzz). It runs
+    natively and reports calls per second and nanoseconds per call on this machine.
+
+    The implementation is the lab's assembly routine from objdir (default build/arm,
+    see "make objects"). It runs in the Thumb-2 interpreter and reports the modelled
+    Cortex-M4 cycles per call, the calls per second that makes at HOST_CPU_MHZ, and
+    how many calls per second the interpreter itself managed. Lab 2 has no assembly:
+    its implementation is the C in Lab2B-Implementation.c, built with its functions
+    renamed Impl..., and it runs natively like the references. An implementation
+    whose object is missing is reported as null.
+
+    Div32X10Array and Mul32X10Array also report a "scalar_loop": the same buffer put
+    through Div32X10/Mul32X10 one BL at a time by Bench-Loops.s, the code the array
+    routines replace. So do GetNibbles and PutNibbles, whose loop is 81 calls of
+    GetNibble/PutNibble. Div64X10 and DivMod64X10 report a "libcall" instead: the
+    general 64-bit division that "ohms/10" compiles to, as Bench-Loops.s models it.
+    Lab 3's calls back into Factorial and gcd run natively and are charged as one
+    host call (THUMB_TIMING).
+
+    Inputs follow each lab's use rather than the edge values fuzz looks for: 16-bit
+    calculator operands, factorials that fit in 32 bits, the temperature sensor's
+    calibration and readings, whole 60x60 cells, nibble scans of a Sudoku grid and
+    resistor color codes. Both versions get the same inputs. Native times include an
+    indirect call per kernel call, so they are upper bounds for the smallest kernels.
+
+    Correctness is fuzz's job; this only times. The exit status is 2 if the objects
+    cannot be linked, otherwise 0.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Thumb.h"
+
+#define BATCH               4096
+#define CPU_MHZ             168                 // HOST_CPU_MHZ, the board's core clock
+
+#define NIBBLE_BYTES        41                  // 81 nibbles: one Sudoku grid
+#define NIBBLE_WORDS        11                  // the grid as Lab 7 stores it, storage[WORDS]
+#define CELLS               81
+#define CELL_STRIDE         240                 // Lab 6 cells live in the frame buffer
+#define CELL_WORDS          (60*CELL_STRIDE)
+#define CELL_ADRS           0xD0000000u
+#define ARRAY_WORDS         64                  // readings per Div32X10Array/Mul32X10Array call
+
+typedef struct
+    {
+    uint64_t                state ;
+    } RANDOM ;
+
+typedef struct
+    {
+    const char *            name ;
+    const char *            object ;            // assembly object, or NULL for Lab 2
+    int                     lab ;
+    const char *            inputs ;
+    int                     nargs ;
+    unsigned                scale ;             // run calls/scale of them (slow kernels)
+    void                    (*Generate)(RANDOM *rng, uint32_t *args, unsigned n) ;
+    uint64_t                (*Reference)(const uint32_t *args) ;
+    uint64_t                (*Native)(const uint32_t *args) ;      // Lab 2 implementation
+    void                    (*Guest)(const uint32_t *args, uint32_t *guest) ;
+    const char *            loop ;              // Bench-Loops.s baseline, if any
+    const char *            baseline ;          // its JSON name, "scalar_loop" if NULL
+    } KERNEL ;
+
+typedef struct
+    {
+    unsigned long long      calls ;
+    double                  seconds ;
+    unsigned long long      cycles ;            // emulated only
+    } TALLY ;
+
+// The C references, from the lab main programs and Host-Lab1A.c
+extern int                  Addition(int, int), Subtraction(int, int), Multiplication(int, int), Division(int, int) ;
+extern void                 Bits2HexString(uint8_t bits, char string[]) ;
+extern void                 Bits2OctalString(uint8_t bits, char string[]) ;
+extern void                 Bits2SignMagString(uint8_t bits, char string[]) ;
+extern void                 Bits2TwosCompString(uint8_t bits, char string[]) ;
+extern void                 Bits2UnsignedString(uint8_t bits, char string[]) ;
+extern int32_t              Return32Bits(void) ;
+extern int64_t              Return64Bits(void) ;
+extern uint8_t              Add8Bits(uint8_t x, uint8_t y) ;
+extern uint32_t             FactSum32(uint32_t x, uint32_t y) ;
+extern uint32_t             XPlusGCD(uint32_t x, uint32_t y, uint32_t z) ;
+extern uint32_t             Factorial(uint32_t n) ;
+extern uint32_t             gcd(uint32_t u1, uint32_t u2) ;
+extern int32_t              MxPlusB(int32_t x, int32_t mtop, int32_t mbtm, int32_t b) ;
+extern void                 CopyCell(uint32_t *dst, uint32_t *src) ;
+extern void                 FillCell(uint32_t *dst, uint32_t pixel) ;
+extern uint32_t             GetNibble(void *nibbles, uint32_t which) ;
+extern void                 PutNibble(void *nibbles, uint32_t which, uint32_t value) ;
+extern void                 GetNibbles(uint8_t *bytes, void *nibbles, uint32_t count) ;
+extern void                 PutNibbles(void *nibbles, uint8_t *bytes, uint32_t count) ;
+extern uint32_t             Mul32X10(uint32_t multiplicand) ;
+extern uint64_t             Mul64X10(uint64_t multiplicand) ;
+extern uint32_t             Div32X10(uint32_t dividend) ;
+extern uint64_t             Div64X10(uint64_t dividend) ;
+extern uint64_t             DivMod64X10(uint64_t dividend, uint32_t *remainder) ;
+extern uint32_t             Tolerance64(uint32_t digits, int32_t exponent, uint32_t hundredths, uint64_t values[3]) ;
+extern void                 Mul32X10Array(uint32_t *dst, uint32_t *src, uint32_t count) ;
+extern void                 Div32X10Array(uint32_t *dst, uint32_t *src, uint32_t count) ;
+extern uint64_t             Bin2Bcd32(uint32_t binary) ;
+extern void                 Bin2Bcd64(uint64_t binary, uint32_t bcd[3]) ;
+extern char *               Bcd2Text(char *text, const uint32_t bcd[], unsigned words) ;
+
+// Lab2B-Implementation.c, renamed by the Makefile
+extern void                 ImplBits2HexString(uint8_t bits, char string[]) ;
+extern void                 ImplBits2OctalString(uint8_t bits, char string[]) ;
+extern void                 ImplBits2SignMagString(uint8_t bits, char string[]) ;
+extern void                 ImplBits2TwosCompString(uint8_t bits, char string[]) ;
+extern void                 ImplBits2UnsignedString(uint8_t bits, char string[]) ;
+
+static double               Now(void) ;
+static uint32_t             Random(RANDOM *rng) ;
+static TALLY                RunNative(KERNEL *k, uint64_t (*Function)(const uint32_t *), RANDOM *rng, unsigned trials) ;
+static TALLY                RunEmulated(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials) ;
+static void                 PrintTally(const char *label, TALLY *t, int emulated, int comma) ;
+static void                 HostFactorial(THUMB_CPU *cpu) ;
+static void                 HostGCD(THUMB_CPU *cpu) ;
+
+static uint32_t             native_cells[2*CELL_WORDS] ;
+static uint32_t             native_grid[NIBBLE_WORDS] ;
+static uint32_t             guest_grid ;
+static uint8_t              native_board[CELLS] ;
+static uint32_t             guest_board ;
+static uint32_t             native_array[2*ARRAY_WORDS] ;
+static uint32_t             guest_array ;
+static uint32_t             native_bcd[ARRAY_WORDS][2] ;
+static uint32_t             guest_bcd ;
+static char                 string[24] ;
+
+// -------------------------------------------------------------------------
+// Inputs: n is the call's position in the run, for kernels used in sequence
+// -------------------------------------------------------------------------
+
+// Lab 1: keypad operands fit in 16 bits; never divide by zero
+static void Operands(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = (uint32_t) (int32_t) (int16_t) Random(rng) ;
+    do args[1] = (uint32_t) (int32_t) (int16_t) Random(rng) ;
+    while (args[1] == 0) ;
+    }
+
+// Lab 2: the eight switches
+static void Switches(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = Random(rng) & 0xFF ;
+    }
+
+static void Bytes(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = Random(rng) & 0xFF ;
+    args[1] = Random(rng) & 0xFF ;
+    }
+
+// Lab 3: (x + y)! must fit in 32 bits
+static void FactorialSum(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = Random(rng) % 7 ;
+    args[1] = Random(rng) % 7 ;
+    }
+
+static void GCDOperands(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = Random(rng) % 100 ;
+    args[1] = 1 + Random(rng) % 1000 ;
+    args[2] = 1 + Random(rng) % 1000 ;
+    }
+
+// Lab 5: half the calls rescale a calibration value by Vref, half convert a reading
+static void Sensor(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    uint32_t vref = 1480 + Random(rng) % 80 ;
+
+    if (n & 1)
+        {
+        args[0] = 900 + Random(rng) % 330 ;
+        args[1] = vref ;
+        args[2] = 1520 ;
+        args[3] = 0 ;
+        }
+    else
+        {
+        args[0] = (uint32_t) ((int32_t) (Random(rng) % 600) - 100) ;
+        args[1] = 8000 ;
+        args[2] = 260 + Random(rng) % 20 ;
+        args[3] = 3000 ;
+        }
+    }
+
+// Lab 6: one of the four cells of the top row, from one of the row below
+static void Cells(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = 60*(Random(rng) % 4) ;
+    args[1] = CELL_WORDS + 60*(Random(rng) % 4) ;
+    }
+
+// Lab 7: the solver walks the grid cell by cell
+static void Scan(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = 0 ;
+    args[1] = n % 81 ;
+    args[2] = 1 + Random(rng) % 9 ;
+    }
+
+// The whole grid, unpacked or packed
+static void Board(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = CELLS ;
+    }
+
+// Lab 8: the first color band, 10^ZEROES(third band) and percent x ohms/10
+static void Digit(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = Random(rng) % 10 ;
+    }
+
+static void Power(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    uint64_t power = 1 ;
+
+    for (unsigned k = Random(rng) % 12; k > 0; k--) power *= 10 ;
+    args[0] = (uint32_t) power ;
+    args[1] = (uint32_t) (power >> 32) ;
+    }
+
+static void Tolerance(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    static const uint32_t percent[] = {1, 2, 5, 10, 20} ;
+    uint64_t ohms = 10 + Random(rng) % 90 ;
+
+    for (unsigned k = Random(rng) % 10; k > 0; k--) ohms *= 10 ;
+    args[0] = percent[Random(rng) % 5] * (uint32_t) (ohms / 10) ;
+    }
+
+// Resistances from two bands and a multiplier of up to 10^11
+static void Ohms(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    uint64_t ohms = 10 + Random(rng) % 90 ;
+
+    for (unsigned k = Random(rng) % 12; k > 0; k--) ohms *= 10 ;
+    args[0] = (uint32_t) ohms ;
+    args[1] = (uint32_t) (ohms >> 32) ;
+    }
+
+// The four bands as DisplayValues passes them: two digits, one of the ten
+// multipliers and one of the nine tolerances
+static void Bands(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    static const uint32_t hundredths[] = {5, 10, 25, 50, 100, 200, 500, 1000, 2000} ;
+
+    args[0] = 10 + Random(rng) % 90 ;
+    args[1] = Random(rng) % 10 ;
+    args[2] = hundredths[Random(rng) % 9] ;
+    }
+
+// Decimal conversion: each call divides the previous quotient, starting over
+// from a random 64-bit value when it reaches zero
+static void Digits(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    static uint64_t value ;
+
+    if (n == 0 || value == 0) value = ((uint64_t) Random(rng) << 32) | Random(rng) ;
+    args[0] = (uint32_t) value ;
+    args[1] = (uint32_t) (value >> 32) ;
+    value /= 10 ;
+    }
+
+// Lab 1's display: a 16-bit result
+static void Display(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = Random(rng) & 0xFFFF ;
+    }
+
+// 64-bit values of every length
+static void Magnitude(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    uint64_t value = (((uint64_t) Random(rng) << 32) | Random(rng)) >> Random(rng) % 64 ;
+
+    args[0] = (uint32_t) value ;
+    args[1] = (uint32_t) (value >> 32) ;
+    }
+
+// One of the readings, already in BCD
+static void Reading(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = Random(rng) % ARRAY_WORDS ;
+    }
+
+// A buffer of readings, filled once in main()
+static void Readings(RANDOM *rng, uint32_t *args, unsigned n)
+    {
+    args[0] = ARRAY_WORDS ;
+    }
+
+// -------------------------------------------------------------------------
+// Native adapters and guest argument translation
+// -------------------------------------------------------------------------
+
+static uint64_t RefAddition(const uint32_t *a)          { return (uint32_t) Addition(a[0], a[1]) ; }
+static uint64_t RefSubtraction(const uint32_t *a)       { return (uint32_t) Subtraction(a[0], a[1]) ; }
+static uint64_t RefMultiplication(const uint32_t *a)    { return (uint32_t) Multiplication(a[0], a[1]) ; }
+static uint64_t RefDivision(const uint32_t *a)          { return (uint32_t) Division(a[0], a[1]) ; }
+static uint64_t RefHex(const uint32_t *a)               { Bits2HexString(a[0], string) ; return string[0] ; }
+static uint64_t RefOctal(const uint32_t *a)             { Bits2OctalString(a[0], string) ; return string[0] ; }
+static uint64_t RefSignMag(const uint32_t *a)           { Bits2SignMagString(a[0], string) ; return string[0] ; }
+static uint64_t RefTwosComp(const uint32_t *a)          { Bits2TwosCompString(a[0], string) ; return string[0] ; }
+static uint64_t RefUnsigned(const uint32_t *a)          { Bits2UnsignedString(a[0], string) ; return string[0] ; }
+static uint64_t ImplHex(const uint32_t *a)              { ImplBits2HexString(a[0], string) ; return string[0] ; }
+static uint64_t ImplOctal(const uint32_t *a)            { ImplBits2OctalString(a[0], string) ; return string[0] ; }
+static uint64_t ImplSignMag(const uint32_t *a)          { ImplBits2SignMagString(a[0], string) ; return string[0] ; }
+static uint64_t ImplTwosComp(const uint32_t *a)         { ImplBits2TwosCompString(a[0], string) ; return string[0] ; }
+static uint64_t ImplUnsigned(const uint32_t *a)         { ImplBits2UnsignedString(a[0], string) ; return string[0] ; }
+static uint64_t RefReturn32Bits(const uint32_t *a)      { return (uint32_t) Return32Bits() ; }
+static uint64_t RefReturn64Bits(const uint32_t *a)      { return (uint64_t) Return64Bits() ; }
+static uint64_t RefAdd8Bits(const uint32_t *a)          { return Add8Bits(a[0], a[1]) ; }
+static uint64_t RefFactSum32(const uint32_t *a)         { return FactSum32(a[0], a[1]) ; }
+static uint64_t RefXPlusGCD(const uint32_t *a)          { return XPlusGCD(a[0], a[1], a[2]) ; }
+static uint64_t RefMxPlusB(const uint32_t *a)           { return (uint32_t) MxPlusB(a[0], a[1], a[2], a[3]) ; }
+static uint64_t RefCopyCell(const uint32_t *a)          { CopyCell(native_cells + a[0], native_cells + a[1]) ; return 0 ; }
+static uint64_t RefFillCell(const uint32_t *a)          { FillCell(native_cells + a[0], a[1]) ; return 0 ; }
+static uint64_t RefGetNibble(const uint32_t *a)         { return GetNibble(native_grid, a[1]) ; }
+static uint64_t RefPutNibble(const uint32_t *a)         { PutNibble(native_grid, a[1], a[2]) ; return 0 ; }
+static uint64_t RefGetNibbles(const uint32_t *a)        { GetNibbles(native_board, native_grid, a[0]) ; return native_board[0] ; }
+static uint64_t RefPutNibbles(const uint32_t *a)        { PutNibbles(native_grid, native_board, a[0]) ; return native_grid[0] ; }
+static uint64_t RefMul32X10(const uint32_t *a)          { return Mul32X10(a[0]) ; }
+static uint64_t RefMul64X10(const uint32_t *a)          { return Mul64X10(((uint64_t) a[1] << 32) | a[0]) ; }
+static uint64_t RefDiv32X10(const uint32_t *a)          { return Div32X10(a[0]) ; }
+static uint64_t RefDiv64X10(const uint32_t *a)          { return Div64X10(((uint64_t) a[1] << 32) | a[0]) ; }
+static uint64_t RefDivMod64X10(const uint32_t *a)       { uint32_t r ; return DivMod64X10(((uint64_t) a[1] << 32) | a[0], &r) + r ; }
+static uint64_t RefTolerance64(const uint32_t *a)       { uint64_t v[3] ; Tolerance64(a[0], a[1], a[2], v) ; return v[1] + v[2] ; }
+static uint64_t RefBin2Bcd32(const uint32_t *a)         { return Bin2Bcd32(a[0]) ; }
+static uint64_t RefBin2Bcd64(const uint32_t *a)         { Bin2Bcd64(((uint64_t) a[1] << 32) | a[0], native_array + ARRAY_WORDS) ; return native_array[ARRAY_WORDS] ; }
+static uint64_t RefBcd2Text(const uint32_t *a)          { return Bcd2Text(string, native_bcd[a[0]], 2) - string ; }
+static uint64_t RefMul32X10Array(const uint32_t *a)     { Mul32X10Array(native_array + ARRAY_WORDS, native_array, a[0]) ; return 0 ; }
+static uint64_t RefDiv32X10Array(const uint32_t *a)     { Div32X10Array(native_array + ARRAY_WORDS, native_array, a[0]) ; return 0 ; }
+
+static void GuestCells(const uint32_t *a, uint32_t *g)  { g[0] = CELL_ADRS + 4*a[0] ; g[1] = CELL_ADRS + 4*a[1] ; }
+static void GuestFill(const uint32_t *a, uint32_t *g)   { g[0] = CELL_ADRS + 4*a[0] ; g[1] = a[1] ; }
+static void GuestGrid(const uint32_t *a, uint32_t *g)   { g[0] = guest_grid ; g[1] = a[1] ; g[2] = a[2] ; }
+static void GuestBoard(const uint32_t *a, uint32_t *g)  { g[0] = guest_board ; g[1] = guest_grid ; g[2] = a[0] ; }
+static void GuestPack(const uint32_t *a, uint32_t *g)   { g[0] = guest_grid ; g[1] = guest_board ; g[2] = a[0] ; }
+static void GuestArray(const uint32_t *a, uint32_t *g)  { g[0] = guest_array + 4*ARRAY_WORDS ; g[1] = guest_array ; g[2] = a[0] ; }
+static void GuestRemainder(const uint32_t *a, uint32_t *g) { g[0] = a[0] ; g[1] = a[1] ; g[2] = guest_array + 4*ARRAY_WORDS ; }
+static void GuestValues(const uint32_t *a, uint32_t *g) { g[0] = a[0] ; g[1] = a[1] ; g[2] = a[2] ; g[3] = guest_array + 4*ARRAY_WORDS ; }
+static void GuestBcd(const uint32_t *a, uint32_t *g)    { g[0] = guest_array + 4*ARRAY_WORDS ; g[1] = guest_bcd + 8*a[0] ; g[2] = 2 ; }
+
+static KERNEL               kernels[] =
+    {
+    {"Addition",            "Lab1A-Calculator",     1, "16-bit operands",           2,    1, Operands,      RefAddition},
+    {"Subtraction",         "Lab1A-Calculator",     1, "16-bit operands",           2,    1, Operands,      RefSubtraction},
+    {"Multiplication",      "Lab1A-Calculator",     1, "16-bit operands",           2,    1, Operands,      RefMultiplication},
+    {"Division",            "Lab1A-Calculator",     1, "16-bit operands, nonzero",  2,    1, Operands,      RefDivision},
+    {"Bits2HexString",      NULL,                   2, "any byte",                  1,    1, Switches,      RefHex,         ImplHex},
+    {"Bits2OctalString",    NULL,                   2, "any byte",                  1,    1, Switches,      RefOctal,       ImplOctal},
+    {"Bits2SignMagString",  NULL,                   2, "any byte",                  1,    1, Switches,      RefSignMag,     ImplSignMag},
+    {"Bits2TwosCompString", NULL,                   2, "any byte",                  1,    1, Switches,      RefTwosComp,    ImplTwosComp},
+    {"Bits2UnsignedString", NULL,                   2, "any byte",                  1,    1, Switches,      RefUnsigned,    ImplUnsigned},
+    {"Return32Bits",        "Lab3B-Implementation", 3, "none",                      0,    1, Switches,      RefReturn32Bits},
+    {"Return64Bits",        "Lab3B-Implementation", 3, "none",                      0,    1, Switches,      RefReturn64Bits},
+    {"Add8Bits",            "Lab3B-Implementation", 3, "any bytes",                 2,    1, Bytes,         RefAdd8Bits},
+    {"FactSum32",           "Lab3B-Implementation", 3, "x, y < 7",                  2,    1, FactorialSum,  RefFactSum32},
+    {"XPlusGCD",            "Lab3B-Implementation", 3, "x < 100, y, z <= 1000",     3,   10, GCDOperands,   RefXPlusGCD},
+    {"MxPlusB",             "Lab5C-Implementation", 5, "Vref rescale and reading",  4,    1, Sensor,        RefMxPlusB},
+    {"CopyCell",            "Lab6C-Implementation", 6, "60x60 cell, stride 240",    2, 1000, Cells,         RefCopyCell,    NULL,   GuestCells},
+    {"FillCell",            "Lab6C-Implementation", 6, "60x60 cell, stride 240",    2, 1000, Cells,         RefFillCell,    NULL,   GuestFill},
+    {"GetNibble",           "Lab7C-Implementation", 7, "grid scan 0..80",           2,    1, Scan,          RefGetNibble,   NULL,   GuestGrid},
+    {"PutNibble",           "Lab7C-Implementation", 7, "grid scan 0..80, 1..9",     3,    1, Scan,          RefPutNibble,   NULL,   GuestGrid},
+    {"GetNibbles",          "Lab7C-Implementation", 7, "whole grid, 81 cells",      3,   81, Board,         RefGetNibbles,      NULL,   GuestBoard, "GetNibblesLoop"},
+    {"PutNibbles",          "Lab7C-Implementation", 7, "whole grid, 81 cells",      3,   81, Board,         RefPutNibbles,      NULL,   GuestPack,  "PutNibblesLoop"},
+    {"Mul32X10",            "Lab8C-Resistors",      8, "first band digit",          1,    1, Digit,         RefMul32X10},
+    {"Mul64X10",            "Lab8C-Resistors",      8, "10^k, k < 12",              2,    1, Power,         RefMul64X10},
+    {"Div32X10",            "Lab8C-Resistors",      8, "percent x ohms/10",         1,    1, Tolerance,     RefDiv32X10},
+    {"Div64X10",            "Lab8C-Resistors",      8, "ohms, 10..99 x 10^k",       2,    1, Ohms,          RefDiv64X10,        NULL,   NULL,       "Div64X10Call",     "libcall"},
+    {"DivMod64X10",         "Lab8C-Resistors",      8, "64-bit, digit by digit",    3,    1, Digits,        RefDivMod64X10,     NULL,   GuestRemainder, "DivMod64X10Call", "libcall"},
+    {"Tolerance64",         "Lab8C-Resistors",      8, "four color bands",          4,    1, Bands,         RefTolerance64,     NULL,   GuestValues},
+    {"Mul32X10Array",       "Lab8C-Resistors",      8, "64 readings per call",      3,   64, Readings,      RefMul32X10Array,   NULL,   GuestArray, "Mul32X10Loop"},
+    {"Div32X10Array",       "Lab8C-Resistors",      8, "64 readings per call",      3,   64, Readings,      RefDiv32X10Array,   NULL,   GuestArray, "Div32X10Loop"},
+    {"Bin2Bcd32",           "bcd",                  1, "16-bit results",            1,    1, Display,       RefBin2Bcd32,       NULL,   NULL,       "Bin2Bcd32Loop",    "digit_loop"},
+    {"Bin2Bcd64",           "bcd",                  1, "64-bit, every length",      3,    1, Magnitude,     RefBin2Bcd64,       NULL,   GuestRemainder, "Bin2Bcd64Loop", "digit_loop"},
+    {"Bcd2Text",            "bcd",                  1, "readings < 100000 in BCD",  3,    1, Reading,       RefBcd2Text,        NULL,   GuestBcd},
+    } ;
+
+#define KERNELS             (sizeof(kernels) / sizeof(kernels[0]))
+
+int main(int argc, char **argv)
+    {
+    const char *dir = "build/arm" ;
+    unsigned long long calls = 1000000 ;
+    RANDOM rng = {0x9E3779B97F4A7C15ULL} ;
+    uint64_t seed = rng.state ;
+    char **names = NULL ;
+    int nnames = 0, first = 1 ;
+    char loaded[KERNELS][64] ;
+    int nloaded = 0 ;
+    THUMB_CPU *cpu = ThumbCreate() ;
+    char path[512] ;
+    FILE *fp ;
+
+    for (int k = 1; k < argc; k++)
+        {
+        if (strcmp(argv[k], "-n") == 0 && k + 1 < argc) calls = strtoull(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-s") == 0 && k + 1 < argc) seed = rng.state = strtoull(argv[++k], NULL, 0) | 1 ;
+        else if (strcmp(argv[k], "-d") == 0 && k + 1 < argc) dir = argv[++k] ;
+        else if (argv[k][0] == '-')
+            {
+            fprintf(stderr, "usage: kernelbench [-n calls] [-s seed] [-d objdir] [kernel...]\n") ;
+            return 2 ;
+            }
+        else
+            {
+            names = &argv[k] ;
+            nnames = argc - k ;
+            break ;
+            }
+        }
+
+    // Every object once, then link them as a unit; Lab 3 calls back into C
+    for (int k = 0; k < KERNELS; k++)
+        {
+        int seen = 0 ;
+
+        if (kernels[k].object == NULL) continue ;
+        for (int j = 0; j < nloaded; j++) seen |= strcmp(loaded[j], kernels[k].object) == 0 ;
+        if (seen) continue ;
+        strcpy(loaded[nloaded++], kernels[k].object) ;
+        snprintf(path, sizeof(path), "%s/%s.o", dir, kernels[k].object) ;
+        if ((fp = fopen(path, "rb")) == NULL) continue ;
+        fclose(fp) ;
+        ThumbLoadObject(cpu, path) ;
+        }
+    snprintf(path, sizeof(path), "%s/Bench-Loops.o", dir) ;
+    if ((fp = fopen(path, "rb")) != NULL)
+        {
+        fclose(fp) ;
+        ThumbLoadObject(cpu, path) ;
+        }
+    ThumbBind(cpu, "Factorial", HostFactorial) ;
+    ThumbBind(cpu, "gcd", HostGCD) ;
+    ThumbMap(cpu, CELL_ADRS, 4*2*CELL_WORDS, calloc(2*CELL_WORDS, 4)) ;
+    if (!ThumbLink(cpu)) return 2 ;
+    cpu->limit = 100000000 ;
+    guest_grid = ThumbAlloc(cpu, 4*NIBBLE_WORDS) ;
+    guest_board = ThumbAlloc(cpu, CELLS) ;
+    for (int j = 0; j < CELLS; j++) native_board[j] = ((uint8_t *) ThumbHost(cpu, guest_board, CELLS))[j] = Random(&rng) % 10 ;
+    guest_array = ThumbAlloc(cpu, 4*2*ARRAY_WORDS) ;
+    guest_bcd = ThumbAlloc(cpu, sizeof(native_bcd)) ;
+    for (int j = 0; j < ARRAY_WORDS; j++)
+        {
+        uint64_t bcd ;
+
+        native_array[j] = Random(&rng) % 100000 ;
+        ThumbWrite32(cpu, guest_array + 4*j, native_array[j]) ;
+        bcd = Bin2Bcd32(native_array[j]) ;
+        native_bcd[j][0] = (uint32_t) bcd ;
+        native_bcd[j][1] = (uint32_t) (bcd >> 32) ;
+        ThumbWrite32(cpu, guest_bcd + 8*j, native_bcd[j][0]) ;
+        ThumbWrite32(cpu, guest_bcd + 8*j + 4, native_bcd[j][1]) ;
+        }
+
+    printf("{\n") ;
+    printf("  \"seed\": %llu,\n", (unsigned long long) seed) ;
+    printf("  \"calls\": %llu,\n", calls) ;
+    printf("  \"cpu_mhz\": %d,\n", CPU_MHZ) ;
+    printf("  \"objects\": \"%s\",\n", dir) ;
+    printf("  \"kernels\": [") ;
+    for (int k = 0; k < KERNELS; k++)
+        {
+        KERNEL *kernel = &kernels[k] ;
+        unsigned trials = calls / kernel->scale ? calls / kernel->scale : 1 ;
+        uint32_t fn = kernel->object != NULL ? ThumbSymbol(cpu, kernel->name) : 0 ;
+        int wanted = nnames == 0 ;
+        RANDOM inputs ;
+        TALLY t ;
+
+        for (int j = 0; j < nnames; j++) wanted |= strcmp(names[j], kernel->name) == 0 ;
+        if (!wanted) continue ;
+
+        printf("%s\n    {\n", first ? "" : ",") ;
+        printf("      \"name\": \"%s\",\n", kernel->name) ;
+        printf("      \"lab\": %d,\n", kernel->lab) ;
+        printf("      \"inputs\": \"%s\",\n", kernel->inputs) ;
+        first = 0 ;
+
+        // Both versions see the same sequence of inputs
+        inputs = rng ;
+        t = RunNative(kernel, kernel->Reference, &inputs, trials) ;
+        PrintTally("reference", &t, 0, 1) ;
+
+        inputs = rng ;
+        if (kernel->Native != NULL)
+            {
+            t = RunNative(kernel, kernel->Native, &inputs, trials) ;
+            PrintTally("implementation", &t, 0, kernel->loop != NULL) ;
+            }
+        else if (fn != 0)
+            {
+            t = RunEmulated(kernel, cpu, fn, &inputs, trials) ;
+            PrintTally("implementation", &t, 1, kernel->loop != NULL) ;
+            }
+        else printf("      \"implementation\": null%s\n", kernel->loop != NULL ? "," : "") ;
+
+        if (kernel->loop != NULL)
+            {
+            uint32_t loop = ThumbSymbol(cpu, kernel->loop) ;
+
+            inputs = rng ;
+            if (loop != 0 && fn != 0)
+                {
+                t = RunEmulated(kernel, cpu, loop, &inputs, trials) ;
+                PrintTally(kernel->baseline ? kernel->baseline : "scalar_loop", &t, 1, 0) ;
+                }
+            else printf("      \"%s\": null\n", kernel->baseline ? kernel->baseline : "scalar_loop") ;
+            }
+        printf("    }") ;
+        rng = inputs ;
+        }
+    printf("\n  ]\n}\n") ;
+
+    ThumbDestroy(cpu) ;
+    return 0 ;
+    }
+
+// -------------------------------------------------------------------------
+// Runs
+// -------------------------------------------------------------------------
+
+// Batches of inputs generated up front, so that the timing is not swamped by
+// the generator and the clock reads
+static TALLY RunNative(KERNEL *k, uint64_t (*Function)(const uint32_t *), RANDOM *rng, unsigned trials)
+    {
+    static uint32_t args[BATCH][4] ;
+    volatile uint64_t sink = 0 ;
+    TALLY t ;
+
+    memset(&t, 0, sizeof(t)) ;
+    while (t.calls < trials)
+        {
+        unsigned n = trials - t.calls < BATCH ? trials - t.calls : BATCH ;
+        uint64_t sum = 0 ;
+        double start ;
+
+        for (unsigned j = 0; j < n; j++) k->Generate(rng, args[j], t.calls + j) ;
+
+        start = Now() ;
+        for (unsigned j = 0; j < n; j++) sum += Function(args[j]) ;
+        t.seconds += Now() - start ;
+        t.calls += n ;
+        sink += sum ;
+        }
+
+    return t ;
+    }
+
+static TALLY RunEmulated(KERNEL *k, THUMB_CPU *cpu, uint32_t fn, RANDOM *rng, unsigned trials)
+    {
+    static uint32_t args[BATCH][4] ;
+    TALLY t ;
+
+    memset(&t, 0, sizeof(t)) ;
+    while (t.calls < trials)
+        {
+        unsigned n = trials - t.calls < BATCH ? trials - t.calls : BATCH ;
+        uint64_t before = cpu->cycles ;
+        THUMB_STATUS status = THUMB_OK ;
+        double start ;
+        unsigned j ;
+
+        for (j = 0; j < n; j++)
+            {
+            uint32_t logical[4] ;
+
+            k->Generate(rng, logical, t.calls + j) ;
+            if (k->Guest != NULL) k->Guest(logical, args[j]) ;
+            else memcpy(args[j], logical, sizeof(logical)) ;
+            }
+
+        start = Now() ;
+        for (j = 0; j < n && status == THUMB_OK; j++) status = ThumbCall(cpu, fn, args[j], k->nargs) ;
+        t.seconds += Now() - start ;
+        t.cycles += cpu->cycles - before ;
+        t.calls += j ;
+
+        if (status != THUMB_OK)
+            {
+            fprintf(stderr, "kernelbench: %s faulted: %s\n", k->name, ThumbStatusText(status)) ;
+            break ;
+            }
+        }
+
+    return t ;
+    }
+
+static void PrintTally(const char *label, TALLY *t, int emulated, int comma)
+    {
+    printf("      \"%s\": {\n", label) ;
+    printf("        \"mode\": \"%s\",\n", emulated ? "emulated" : "native") ;
+    printf("        \"calls\": %llu,\n", t->calls) ;
+    if (emulated)
+        {
+        double cycles = t->calls ? (double) t->cycles / t->calls : 0 ;
+
+        printf("        \"cycles_per_call\": %.1f,\n", cycles) ;
+        printf("        \"calls_per_sec\": %.0f,\n", cycles > 0 ? 1e6 * CPU_MHZ / cycles : 0) ;
+        printf("        \"emulator_calls_per_sec\": %.0f\n", t->seconds > 0 ? t->calls / t->seconds : 0) ;
+        }
+    else
+        {
+        printf("        \"ns_per_call\": %.2f,\n", t->calls ? 1e9 * t->seconds / t->calls : 0) ;
+        printf("        \"calls_per_sec\": %.0f\n", t->seconds > 0 ? t->calls / t->seconds : 0) ;
+        }
+    printf("      }%s\n", comma ? "," : "") ;
+    }
+
+// -------------------------------------------------------------------------
+// Helpers
+// -------------------------------------------------------------------------
+
+static void HostFactorial(THUMB_CPU *cpu)
+    {
+    cpu->r[0] = Factorial(cpu->r[0]) ;
+    }
+
+static void HostGCD(THUMB_CPU *cpu)
+    {
+    cpu->r[0] = gcd(cpu->r[0], cpu->r[1]) ;
+    }
+
+static double Now(void)
+    {
+    struct timespec ts ;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return ts.tv_sec + 1e-9 * ts.tv_nsec ;
+    }
+
+// xorshift64*
+static uint32_t Random(RANDOM *rng)
+    {
+    rng->state ^= rng->state >> 12 ;
+    rng->state ^= rng->state << 25 ;
+    rng->state ^= rng->state >> 27 ;
+    return (uint32_t) ((rng->state * 0x2545F4914F6CDD1DULL) >> 32) ;
+    }
@@ -0,0 +1,312 @@
+/*
+    sweep: Mul32X10 and Div32X10 from Lab8C-Resistors.s on every 32-bit input, and
+    Mul64X10 on a stratified sample of 64-bit inputs, spread over every core.
+
+        sweep [-j threads] [-n samples] [-r first:last] [-d objdir] [kernel...]
+
+    Each thread has its own Thumb-2 interpreter with objdir/Lab8C-Resistors.o
+    (default build/arm, see "make objects") loaded, and claims blocks of BLOCK
+    inputs until none are left. The reference is the C expression itself, 10*x or
+    x/10, not the lab's weak C function, so the sweep needs nothing but the object.
+    -r limits the 32-bit kernels to part of the range for a quick run.
+
+    Mul64X10 gets -n samples (default 2^28) in equal shares of these strata:
+
+        carries     the low word next to j*2^31/5, j = 1 to 9, where 4*lo + lo
+                    carries out of the low word (ADDS/ADCS) or 5*lo crosses bit 31
+                    (the carry the final LSLS/ADC moves up), each with a random
+                    high word
+        bits        a random input with the high word exactly h bits long and the
+                    low word exactly l bits long, for every h and l from 0 to 32;
+                    this covers the two bits the ORR brings up from the low word
+        edges       0, 1, the powers of two, all ones and their neighbours, in
+                    both words
+
+    Each block's inputs depend only on the block number and the seed, so a run
+    gives the same answer whatever -j is. Prints inputs, mismatches (the first
+    few in full), seconds and inputs per second for each kernel; the exit status
+    is 1 if anything disagrees and 2 if the object cannot be loaded.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "Thumb.h"
+
+#define BLOCK               (1u << 20)          // inputs a thread claims at a time
+#define MAX_REPORTS         5
+#define MAX_THREADS         64
+#define CARRY_SPREAD        64                  // low words either side of each carry boundary
+
+typedef enum {MUL32, DIV32, MUL64} KIND ;
+
+typedef struct
+    {
+    const char *            name ;
+    KIND                    kind ;
+    } KERNEL ;
+
+typedef struct
+    {
+    KERNEL *                kernel ;
+    uint64_t                first ;             // 32-bit kernels: inputs first..last
+    uint64_t                last ;
+    uint64_t                samples ;           // Mul64X10
+    uint64_t                blocks ;
+    uint64_t                next ;              // next block to claim
+    uint64_t                mismatches ;
+    uint64_t                inputs ;
+    pthread_mutex_t         lock ;
+    } SWEEP ;
+
+typedef struct
+    {
+    SWEEP *                 sweep ;
+    const char *            path ;
+    int                     failed ;            // could not load the object
+    } WORKER ;
+
+static KERNEL               kernels[] =
+    {
+    {"Mul32X10",    MUL32},
+    {"Div32X10",    DIV32},
+    {"Mul64X10",    MUL64},
+    } ;
+
+#define KERNELS             (sizeof(kernels) / sizeof(kernels[0]))
+
+static uint64_t             seed = 0x9E3779B97F4A7C15ULL ;
+
+static void *               Worker(void *arg) ;
+static void                 Sweep32(SWEEP *s, THUMB_CPU *cpu, uint32_t fn, uint64_t block) ;
+static void                 Sweep64(SWEEP *s, THUMB_CPU *cpu, uint32_t fn, uint64_t block) ;
+static uint64_t             Stratum(uint64_t n, uint64_t *rng) ;
+static void                 Mismatch(SWEEP *s, uint64_t x, uint64_t got, uint64_t want) ;
+static uint64_t             Random(uint64_t *state) ;
+static double               Now(void) ;
+static void                 Usage(void) ;
+
+int main(int argc, char **argv)
+    {
+    const char *dir = "build/arm" ;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN) ;
+    uint64_t samples = 1ULL << 28, first = 0, last = 0xFFFFFFFF ;
+    char **names = NULL ;
+    int nnames = 0, failed = 0 ;
+    char path[512] ;
+
+    for (int k = 1; k < argc; k++)
+        {
+        if (strcmp(argv[k], "-j") == 0 && k + 1 < argc) threads = strtol(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-n") == 0 && k + 1 < argc) samples = strtoull(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-d") == 0 && k + 1 < argc) dir = argv[++k] ;
+        else if (strcmp(argv[k], "-r") == 0 && k + 1 < argc)
+            {
+            char *colon ;
+
+            first = strtoull(argv[++k], &colon, 0) ;
+            if (*colon != ':') Usage() ;
+            last = strtoull(colon + 1, NULL, 0) ;
+            if (first > last || last > 0xFFFFFFFF) Usage() ;
+            }
+        else if (argv[k][0] == '-') Usage() ;
+        else
+            {
+            names = &argv[k] ;
+            nnames = argc - k ;
+            break ;
+            }
+        }
+    if (threads < 1) threads = 1 ;
+    if (threads > MAX_THREADS) threads = MAX_THREADS ;
+    snprintf(path, sizeof(path), "%s/Lab8C-Resistors.o", dir) ;
+
+    printf("%ld threads, %s\n", threads, path) ;
+    printf("%-10s %14s %10s %10s %14s\n", "kernel", "inputs", "mismatch", "seconds", "inputs/s") ;
+    for (int k = 0; k < KERNELS; k++)
+        {
+        pthread_t thread[MAX_THREADS] ;
+        WORKER worker[MAX_THREADS] ;
+        int wanted = nnames == 0 ;
+        SWEEP s ;
+        double start, seconds ;
+
+        for (int j = 0; j < nnames; j++) wanted |= strcmp(names[j], kernels[k].name) == 0 ;
+        if (!wanted) continue ;
+
+        memset(&s, 0, sizeof(s)) ;
+        s.kernel = &kernels[k] ;
+        s.first = first ;
+        s.last = last ;
+        s.samples = samples ;
+        s.blocks = kernels[k].kind == MUL64 ? (samples + BLOCK - 1) / BLOCK : (last - first) / BLOCK + 1 ;
+        pthread_mutex_init(&s.lock, NULL) ;
+
+        start = Now() ;
+        for (int t = 0; t < threads; t++)
+            {
+            worker[t] = (WORKER) {&s, path, 0} ;
+            pthread_create(&thread[t], NULL, Worker, &worker[t]) ;
+            }
+        for (int t = 0; t < threads; t++)
+            {
+            pthread_join(thread[t], NULL) ;
+            if (worker[t].failed) return 2 ;
+            }
+        seconds = Now() - start ;
+
+        printf("%-10s %14llu %10llu %10.1f %14.0f\n", s.kernel->name, (unsigned long long) s.inputs,
+               (unsigned long long) s.mismatches, seconds, seconds > 0 ? s.inputs / seconds : 0) ;
+        if (s.mismatches != 0) failed = 1 ;
+        pthread_mutex_destroy(&s.lock) ;
+        }
+
+    return failed ;
+    }
+
+static void *Worker(void *arg)
+    {
+    WORKER *w = (WORKER *) arg ;
+    SWEEP *s = w->sweep ;
+    THUMB_CPU *cpu = ThumbCreate() ;
+    uint32_t fn ;
+    uint64_t block ;
+
+    if (!ThumbLoadObject(cpu, w->path) || !ThumbLink(cpu) || (fn = ThumbSymbol(cpu, s->kernel->name)) == 0)
+        {
+        fprintf(stderr, "sweep: no %s in %s\n", s->kernel->name, w->path) ;
+        w->failed = 1 ;
+        ThumbDestroy(cpu) ;
+        return NULL ;
+        }
+    cpu->limit = 1000 ;
+
+    while ((block = __atomic_fetch_add(&s->next, 1, __ATOMIC_RELAXED)) < s->blocks)
+        {
+        if (s->kernel->kind == MUL64) Sweep64(s, cpu, fn, block) ;
+        else Sweep32(s, cpu, fn, block) ;
+        }
+
+    ThumbDestroy(cpu) ;
+    return NULL ;
+    }
+
+static void Sweep32(SWEEP *s, THUMB_CPU *cpu, uint32_t fn, uint64_t block)
+    {
+    uint64_t x = s->first + block * BLOCK ;
+    uint64_t end = x + BLOCK - 1 < s->last ? x + BLOCK - 1 : s->last ;
+    uint64_t count = end - x + 1 ;
+
+    for (; x <= end; x++)
+        {
+        uint32_t arg = (uint32_t) x ;
+        uint32_t want = s->kernel->kind == MUL32 ? 10 * arg : arg / 10 ;
+
+        if (ThumbCall(cpu, fn, &arg, 1) != THUMB_OK || cpu->r[0] != want) Mismatch(s, x, cpu->r[0], want) ;
+        }
+    __atomic_fetch_add(&s->inputs, count, __ATOMIC_RELAXED) ;
+    }
+
+static void Sweep64(SWEEP *s, THUMB_CPU *cpu, uint32_t fn, uint64_t block)
+    {
+    uint64_t n = block * BLOCK ;
+    uint64_t end = n + BLOCK < s->samples ? n + BLOCK : s->samples ;
+    uint64_t rng = seed ^ (block * 0xD1B54A32D192ED03ULL) ;
+    uint64_t count = end - n ;
+
+    for (; n < end; n++)
+        {
+        uint64_t x = Stratum(n, &rng), want = 10 * x, got ;
+        uint32_t args[2] = {(uint32_t) x, (uint32_t) (x >> 32)} ;
+
+        if (ThumbCall(cpu, fn, args, 2) != THUMB_OK) Mismatch(s, x, 0, want) ;
+        else if ((got = ((uint64_t) cpu->r[1] << 32) | cpu->r[0]) != want) Mismatch(s, x, got, want) ;
+        }
+    __atomic_fetch_add(&s->inputs, count, __ATOMIC_RELAXED) ;
+    }
+
+// The n-th sample: the strata take turns, so every block covers all of them
+static uint64_t Stratum(uint64_t n, uint64_t *rng)
+    {
+    static const uint32_t edges[] =
+        {
+        0, 1, 2, 3, 0x3FFFFFFF, 0x40000000, 0x7FFFFFFF, 0x80000000, 0x80000001,
+        0xBFFFFFFF, 0xC0000000, 0xFFFFFFFE, 0xFFFFFFFF
+        } ;
+    enum {EDGES = sizeof(edges) / sizeof(edges[0])} ;
+    uint64_t r = Random(rng) ;
+    uint32_t hi, lo ;
+
+    switch (n % 3)
+        {
+        case 0:
+            {
+            // Next to j*2^31/5: the carries out of 5*lo and out of bit 31 of it
+            uint64_t j = 1 + r % 9 ;
+            int64_t delta = (int64_t) ((r >> 8) % (2*CARRY_SPREAD + 1)) - CARRY_SPREAD ;
+
+            lo = (uint32_t) ((j << 31) / 5 + delta) ;
+            hi = (uint32_t) (r >> 32) ;
+            break ;
+            }
+
+        case 1:
+            {
+            // High word exactly h bits long, low word exactly l bits long
+            unsigned h = r % 33, l = (r >> 8) % 33 ;
+            uint64_t bits = Random(rng) ;
+
+            hi = h == 0 ? 0 : (uint32_t) ((bits & ((1ULL << (h - 1)) - 1)) | (1ULL << (h - 1))) ;
+            lo = l == 0 ? 0 : (uint32_t) (((bits >> 32) & ((1ULL << (l - 1)) - 1)) | (1ULL << (l - 1))) ;
+            break ;
+            }
+
+        default:
+            // Edge values and powers of two in both words
+            hi = (r & 1) ? edges[(r >> 1) % EDGES] : 1u << ((r >> 1) % 32) ;
+            lo = (r & 64) ? edges[(r >> 7) % EDGES] : 1u << ((r >> 7) % 32) ;
+            if (r & 0x1000) hi += (uint32_t) ((r >> 16) % 3) - 1 ;
+            if (r & 0x2000) lo += (uint32_t) ((r >> 24) % 3) - 1 ;
+            break ;
+        }
+
+    return ((uint64_t) hi << 32) | lo ;
+    }
+
+static void Mismatch(SWEEP *s, uint64_t x, uint64_t got, uint64_t want)
+    {
+    pthread_mutex_lock(&s->lock) ;
+    if (s->mismatches++ < MAX_REPORTS)
+        {
+        printf("    %s(0x%llX) = 0x%llX, should be 0x%llX\n", s->kernel->name,
+               (unsigned long long) x, (unsigned long long) got, (unsigned long long) want) ;
+        }
+    pthread_mutex_unlock(&s->lock) ;
+    }
+
+// xorshift64*
+static uint64_t Random(uint64_t *state)
+    {
+    *state ^= *state >> 12 ;
+    *state ^= *state << 25 ;
+    *state ^= *state >> 27 ;
+    return *state * 0x2545F4914F6CDD1DULL ;
+    }
+
+static double Now(void)
+    {
+    struct timespec ts ;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return ts.tv_sec + 1e-9 * ts.tv_nsec ;
+    }
+
+static void Usage(void)
+    {
+    fprintf(stderr, "usage: sweep [-j threads] [-n samples] [-r first:last] [-d objdir] [kernel...]\n") ;
+    exit(2) ;
+    }
@@ -0,0 +1,236 @@
+/*
+    netbench: ../Common/network.c on random targets, timed, and checked against an
+    exhaustive search.
+
+        netbench [-n queries] [-c checks] [-s seed] [ohms series ppm]
+
+    Targets are spread evenly over the decades from 1 ohm to 10 MOhms. For each
+    series and tolerance the benchmark reports queries per second, the mean and
+    worst time per query, how often the tolerance was met and the mean number of
+    parts. Then -c targets per case are searched again by brute force over every
+    pair, and every triple where that is affordable (E12 and E24), under the same
+    fewest-parts rule; the errors and part counts must agree. The exit status is
+    1 if any of them differ.
+
+    With three arguments, netbench answers one query instead, e.g.
+    "netbench 33000 E24 1000", and shows the color bands of the parts.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "network.h"
+
+#define MAX_PARTS           3
+
+typedef struct
+    {
+    NETWORK_SERIES          series ;
+    const char *            name ;
+    int                     triples ;       // brute force of three parts affordable
+    } SERIES ;
+
+static SERIES               series[] =
+    {
+    {NETWORK_E12,   "E12",  1},
+    {NETWORK_E24,   "E24",  1},
+    {NETWORK_E96,   "E96",  0}
+    } ;
+
+static const uint32_t       tolerances[] = {10000, 1000, 100} ;    // ppm: 1%, 0.1%, 0.01%
+
+static uint64_t             random_state = 88172645463325252ULL ;
+
+static int                  Brute(NETWORK_SERIES s, uint32_t target, uint32_t ppm, unsigned maxParts, uint32_t *error, unsigned *parts) ;
+static uint32_t             Parallel(uint32_t a, uint32_t b) ;
+static void                 Print(const NETWORK *net) ;
+static uint64_t             Random(void) ;
+static double               Seconds(void) ;
+static uint32_t             Target(void) ;
+static void                 Usage(void) ;
+
+int main(int argc, char **argv)
+    {
+    unsigned long queries = 20000, checks = 20 ;
+    int failed = 0 ;
+    char *end ;
+
+    for (int k = 1; k < argc; k++)
+        {
+        if (strcmp(argv[k], "-n") == 0 && k + 1 < argc) queries = strtoul(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-c") == 0 && k + 1 < argc) checks = strtoul(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-s") == 0 && k + 1 < argc) random_state = strtoull(argv[++k], NULL, 0) | 1 ;
+        else if (argv[k][0] != '-' && k + 3 == argc)
+            {
+            double ohms = strtod(argv[k], &end) ;
+            int s ;
+            NETWORK net ;
+            int met ;
+
+            for (s = 0; s < 3 && strcmp(series[s].name, argv[k + 1]) != 0; s++) continue ;
+            if (*end != '\0' || s == 3 || ohms * NETWORK_OHM < 1 || ohms * NETWORK_OHM > UINT32_MAX) Usage() ;
+            met = NetworkSearch(series[s].series, (uint32_t) (ohms * NETWORK_OHM + 0.5), strtoul(argv[k + 2], NULL, 0), MAX_PARTS, &net) ;
+            Print(&net) ;
+            printf("%s\n", met ? "within tolerance" : "closest found, outside tolerance") ;
+            return 0 ;
+            }
+        else Usage() ;
+        }
+
+    printf("%-6s %8s %10s %12s %12s %12s %8s %8s\n", "series", "ppm", "queries", "queries/s", "mean us", "worst us", "met", "parts") ;
+    for (int s = 0; s < 3; s++)
+        {
+        for (int t = 0; t < 3; t++)
+            {
+            double start = Seconds(), worst = 0, total ;
+            unsigned long met = 0, parts = 0, wrong = 0 ;
+
+            for (unsigned long q = 0; q < queries; q++)
+                {
+                double begin = Seconds(), took ;
+                NETWORK net ;
+
+                met += NetworkSearch(series[s].series, Target(), tolerances[t], MAX_PARTS, &net) != 0 ;
+                parts += net.parts ;
+                took = Seconds() - begin ;
+                if (took > worst) worst = took ;
+                }
+            total = Seconds() - start ;
+
+            // The same fewest-parts answer as trying everything
+            for (unsigned long q = 0; q < checks; q++)
+                {
+                uint32_t target = Target(), error ;
+                unsigned maxParts = series[s].triples ? 3 : 2, count ;
+                NETWORK net ;
+                int met1 = NetworkSearch(series[s].series, target, tolerances[t], maxParts, &net) ;
+                int met2 = Brute(series[s].series, target, tolerances[t], maxParts, &error, &count) ;
+
+                if (met1 != met2 || net.error != error || net.parts != count)
+                    {
+                    if (wrong++ < 3)
+                        {
+                        printf("    %s %u ppm, target %u: found error %u with %u parts, exhaustive %u with %u\n",
+                               series[s].name, tolerances[t], target, net.error, net.parts, error, count) ;
+                        }
+                    }
+                }
+            if (wrong != 0) failed = 1 ;
+
+            printf("%-6s %8u %10lu %12.0f %12.1f %12.1f %7.1f%% %8.2f%s\n", series[s].name, tolerances[t], queries,
+                   total > 0 ? queries / total : 0, 1e6 * total / queries, 1e6 * worst,
+                   100.0 * met / queries, (double) parts / queries, wrong ? "  WRONG" : "") ;
+            }
+        }
+
+    return failed ;
+    }
+
+// Every network of up to maxParts parts, in the order NetworkSearch tries the
+// counts; a count only replaces the last if it does strictly better
+static int Brute(NETWORK_SERIES s, uint32_t target, uint32_t ppm, unsigned maxParts, uint32_t *error, unsigned *parts)
+    {
+    unsigned n ;
+    const uint32_t *p = NetworkParts(s, &n) ;
+    uint64_t best = UINT64_MAX ;
+
+    #define TRY(value, count)                                                           \
+        {                                                                               \
+        uint64_t v = (value), e = v > target ? v - target : target - v ;                \
+        if (v <= UINT32_MAX && e < best) { best = e ; *parts = count ; }                \
+        }
+    #define MET()           (best * 1000000 <= (uint64_t) ppm * target)
+
+    for (unsigned i = 0; i < n; i++) TRY(p[i], 1) ;
+    if (maxParts < 2 || MET()) goto done ;
+
+    for (unsigned i = 0; i < n; i++)
+        {
+        for (unsigned j = i; j < n; j++)
+            {
+            TRY((uint64_t) p[i] + p[j], 2) ;
+            TRY(Parallel(p[i], p[j]), 2) ;
+            }
+        }
+    if (maxParts < 3 || MET()) goto done ;
+
+    for (unsigned i = 0; i < n; i++)
+        {
+        for (unsigned j = 0; j < n; j++)
+            {
+            for (unsigned k = j; k < n; k++)
+                {
+                if (i <= j)
+                    {
+                    TRY((uint64_t) p[i] + p[j] + p[k], 3) ;
+                    TRY(Parallel(Parallel(p[i], p[j]), p[k]), 3) ;
+                    }
+                TRY((uint64_t) p[i] + Parallel(p[j], p[k]), 3) ;
+                TRY(Parallel(p[i], p[j] + p[k]), 3) ;
+                }
+            }
+        }
+
+done:
+    *error = (uint32_t) best ;
+    return MET() ;
+    }
+
+// As network.c rounds it
+static uint32_t Parallel(uint32_t a, uint32_t b)
+    {
+    uint64_t sum = (uint64_t) a + b ;
+
+    return (uint32_t) (((uint64_t) a * b + (sum >> 1)) / sum) ;
+    }
+
+static void Print(const NETWORK *net)
+    {
+    printf("%s = %u.%02u ohms, off by %u.%02u\n", NetworkShapeName(net->shape),
+           net->value / NETWORK_OHM, net->value % NETWORK_OHM, net->error / NETWORK_OHM, net->error % NETWORK_OHM) ;
+    for (unsigned k = 0; k < net->parts; k++)
+        {
+        uint8_t digits[3] ;
+        int exponent ;
+
+        printf("    %u.%02u ohms", net->part[k] / NETWORK_OHM, net->part[k] % NETWORK_OHM) ;
+        if (NetworkBands(net->part[k], 3, digits, &exponent))
+            {
+            printf(", bands %u %u %u x 10^%d", digits[0], digits[1], digits[2], exponent) ;
+            }
+        printf("\n") ;
+        }
+    }
+
+// 1 ohm to 10 MOhms, evenly over the decades
+static uint32_t Target(void)
+    {
+    double decades = 7.0 * (Random() >> 11) / (1ULL << 53) ;
+
+    return (uint32_t) (NETWORK_OHM * pow(10.0, decades) + 0.5) ;
+    }
+
+static uint64_t Random(void)
+    {
+    random_state ^= random_state << 13 ;
+    random_state ^= random_state >> 7 ;
+    random_state ^= random_state << 17 ;
+    return random_state ;
+    }
+
+static double Seconds(void)
+    {
+    struct timespec ts ;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return ts.tv_sec + 1e-9 * ts.tv_nsec ;
+    }
+
+static void Usage(void)
+    {
+    fprintf(stderr, "usage: netbench [-n queries] [-c checks] [-s seed] [ohms E12|E24|E96 ppm]\n") ;
+    exit(1) ;
+    }
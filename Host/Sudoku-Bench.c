@@ -0,0 +1,369 @@
+/*
+    sudokubench: ../Common/dlx.c against a backtracking search that fills the cells
+    in order and tries the digits upwards (Lab 7's SCAN), timed on a corpus of
+    puzzles, and every answer checked.
+
+        sudokubench [-n puzzles] [-g givens] [-b budget] [-s seed] [file ...]
+
+    Each line of a file that starts with 81 characters of 1 to 9, 0 or '.' is a
+    puzzle; other lines are skipped, so the usual one-puzzle-per-line collections
+    can be read as they are. Without files the corpus is Lab 7's puzzle, two that
+    are hard for backtracking, and -n random ones: a solved grid with its digits,
+    rows, columns, bands and stacks shuffled, and all but -g of its cells emptied
+    (solvable, though not always uniquely).
+
+    For each engine the benchmark reports puzzles per second, the mean and worst
+    time per puzzle, and the mean number of digits tried and taken back. The
+    backtracking search gives up after -b digits tried on one puzzle. Every solution
+    must keep the givens and be a valid grid, and where both engines finish they
+    must agree on whether there is one. The exit status is 1 if any check fails.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dlx.h"
+
+#define CELLS               DLX_CELLS
+#define EMPTY               0
+#define GAVE_UP             (-1)
+
+typedef struct
+    {
+    const char *            name ;
+    int                     (*Solve)(const uint8_t given[CELLS], uint8_t cells[CELLS], unsigned long *placed, unsigned long *removed) ;
+    double                  total ;
+    double                  worst ;
+    unsigned long           solved ;
+    unsigned long           gaveUp ;
+    unsigned long           placed ;
+    unsigned long           removed ;
+    } ENGINE ;
+
+static int                  Backtrack(uint8_t cells[CELLS], int index) ;
+static int                  Check(const uint8_t given[CELLS], const uint8_t cells[CELLS]) ;
+static void                 Generate(uint8_t given[CELLS], unsigned givens) ;
+static int                  Parse(const char *text, uint8_t cells[CELLS]) ;
+static uint64_t             Random(void) ;
+static void                 Read(const char *path) ;
+static double               Seconds(void) ;
+static void                 Shuffle(uint8_t order[], unsigned items) ;
+static int                  SolveBacktrack(const uint8_t given[CELLS], uint8_t cells[CELLS], unsigned long *placed, unsigned long *removed) ;
+static int                  SolveDlx(const uint8_t given[CELLS], uint8_t cells[CELLS], unsigned long *placed, unsigned long *removed) ;
+static void                 Usage(void) ;
+
+static const char *         builtin[] =
+    {
+    "100009007003002090006000001080300709009010800201004050500000100090200500600500003",    // Lab 7
+    "800000000003600000070090200050007000000045700000100030001000068008500010090000400",
+    "000000000000003085001020000000507000004000100090000000500000073002010000000040009",    // against backtracking
+    } ;
+
+static ENGINE               engines[] =
+    {
+    {"dlx",         SolveDlx},
+    {"backtrack",   SolveBacktrack}
+    } ;
+
+static uint8_t              (*puzzles)[CELLS] ;
+static unsigned long        count ;
+static unsigned long        allocated ;
+
+static DLX                  dlx ;
+static uint16_t             used[3][9] ;    // digits (bit 1 to 9) in each row, column and block
+static unsigned long        tried, undone, budget = 10000000 ;
+static uint64_t             random_state = 88172645463325252ULL ;
+
+int main(int argc, char **argv)
+    {
+    unsigned long generate = 1000, givens = 26, wrong = 0 ;
+    int files = 0 ;
+
+    for (int k = 1; k < argc; k++)
+        {
+        if (strcmp(argv[k], "-n") == 0 && k + 1 < argc) generate = strtoul(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-g") == 0 && k + 1 < argc) givens = strtoul(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-b") == 0 && k + 1 < argc) budget = strtoul(argv[++k], NULL, 0) ;
+        else if (strcmp(argv[k], "-s") == 0 && k + 1 < argc) random_state = strtoull(argv[++k], NULL, 0) | 1 ;
+        else if (argv[k][0] != '-')
+            {
+            Read(argv[k]) ;
+            files++ ;
+            }
+        else Usage() ;
+        }
+    if (givens > CELLS) Usage() ;
+
+    if (files == 0)
+        {
+        for (unsigned k = 0; k < sizeof(builtin)/sizeof(builtin[0]); k++) Parse(builtin[k], NULL) ;
+        for (unsigned long k = 0; k < generate; k++)
+            {
+            uint8_t given[CELLS] ;
+
+            Generate(given, givens) ;
+            Parse(NULL, given) ;
+            }
+        }
+    if (count == 0)
+        {
+        fprintf(stderr, "sudokubench: no puzzles\n") ;
+        return 1 ;
+        }
+
+    for (unsigned long p = 0; p < count; p++)
+        {
+        int results[2] ;
+
+        for (int e = 0; e < 2; e++)
+            {
+            ENGINE *engine = &engines[e] ;
+            uint8_t cells[CELLS] ;
+            unsigned long placed = 0, removed = 0 ;
+            double begin = Seconds(), took ;
+
+            results[e] = (*engine->Solve)(puzzles[p], cells, &placed, &removed) ;
+            took = Seconds() - begin ;
+            engine->total += took ;
+            if (took > engine->worst) engine->worst = took ;
+            engine->placed += placed ;
+            engine->removed += removed ;
+            if (results[e] == GAVE_UP) engine->gaveUp++ ;
+            else if (results[e] != 0)
+                {
+                engine->solved++ ;
+                if (!Check(puzzles[p], cells) && wrong++ < 3)
+                    {
+                    printf("    puzzle %lu: %s's solution is not valid\n", p + 1, engine->name) ;
+                    }
+                }
+            }
+
+        if (results[0] != GAVE_UP && results[1] != GAVE_UP && results[0] != results[1] && wrong++ < 3)
+            {
+            printf("    puzzle %lu: %s %s, %s %s\n", p + 1, engines[0].name, results[0] ? "solved" : "failed",
+                   engines[1].name, results[1] ? "solved" : "failed") ;
+            }
+        }
+
+    printf("%-10s %9s %9s %9s %12s %12s %12s %12s %12s\n", "engine", "puzzles", "solved", "gave up",
+           "puzzles/s", "mean us", "worst us", "tried", "undone") ;
+    for (int e = 0; e < 2; e++)
+        {
+        ENGINE *engine = &engines[e] ;
+
+        printf("%-10s %9lu %9lu %9lu %12.0f %12.1f %12.1f %12.1f %12.1f\n", engine->name, count, engine->solved,
+               engine->gaveUp, engine->total > 0 ? count / engine->total : 0, 1e6 * engine->total / count,
+               1e6 * engine->worst, (double) engine->placed / count, (double) engine->removed / count) ;
+        }
+    if (wrong != 0) printf("%lu WRONG\n", wrong) ;
+
+    return wrong != 0 ;
+    }
+
+static int SolveDlx(const uint8_t given[CELLS], uint8_t cells[CELLS], unsigned long *placed, unsigned long *removed)
+    {
+    DLX_RESULT result = DlxBegin(&dlx, given, NULL, NULL) ;
+
+    while (result == DLX_RUNNING) result = DlxStep(&dlx, 4096) ;
+    DlxSolution(&dlx, cells) ;
+    *placed = dlx.placed ;
+    *removed = dlx.removed ;
+    return result == DLX_SOLVED ;
+    }
+
+static int SolveBacktrack(const uint8_t given[CELLS], uint8_t cells[CELLS], unsigned long *placed, unsigned long *removed)
+    {
+    int result = 1 ;
+
+    memset(used, 0, sizeof(used)) ;
+    for (int index = 0; index < CELLS; index++)
+        {
+        int row = index / 9, col = index % 9, blk = 3*(row / 3) + col / 3 ;
+        uint16_t bit = 1 << given[index] ;
+
+        cells[index] = given[index] ;
+        if (given[index] == EMPTY) continue ;
+        if (given[index] > 9 || ((used[0][row] | used[1][col] | used[2][blk]) & bit)) result = 0 ;
+        used[0][row] |= bit ;
+        used[1][col] |= bit ;
+        used[2][blk] |= bit ;
+        }
+
+    tried = undone = 0 ;
+    if (result != 0) result = Backtrack(cells, 0) ;
+    *placed = tried ;
+    *removed = undone ;
+    return result ;
+    }
+
+// 1 if the cells from index on can be filled, 0 if not, GAVE_UP past the budget
+static int Backtrack(uint8_t cells[CELLS], int index)
+    {
+    int row, col, blk ;
+
+    while (index < CELLS && cells[index] != EMPTY) index++ ;
+    if (index == CELLS) return 1 ;
+
+    row = index / 9 ;
+    col = index % 9 ;
+    blk = 3*(row / 3) + col / 3 ;
+    for (int digit = 1; digit <= 9; digit++)
+        {
+        uint16_t bit = 1 << digit ;
+        int result ;
+
+        if ((used[0][row] | used[1][col] | used[2][blk]) & bit) continue ;
+        if (++tried > budget) return GAVE_UP ;
+
+        cells[index] = digit ;
+        used[0][row] |= bit ;
+        used[1][col] |= bit ;
+        used[2][blk] |= bit ;
+        if ((result = Backtrack(cells, index + 1)) != 0) return result ;
+        used[0][row] &= ~bit ;
+        used[1][col] &= ~bit ;
+        used[2][blk] &= ~bit ;
+        cells[index] = EMPTY ;
+        undone++ ;
+        }
+
+    return 0 ;
+    }
+
+// The givens kept, and every row, column and block holding 1 to 9 once each
+static int Check(const uint8_t given[CELLS], const uint8_t cells[CELLS])
+    {
+    uint16_t seen[3][9] = {{0}} ;
+
+    for (int index = 0; index < CELLS; index++)
+        {
+        int row = index / 9, col = index % 9, blk = 3*(row / 3) + col / 3 ;
+
+        if (cells[index] < 1 || cells[index] > 9) return 0 ;
+        if (given[index] != EMPTY && given[index] != cells[index]) return 0 ;
+        seen[0][row] |= 1 << cells[index] ;
+        seen[1][col] |= 1 << cells[index] ;
+        seen[2][blk] |= 1 << cells[index] ;
+        }
+    for (int k = 0; k < 9; k++)
+        {
+        if (seen[0][k] != 0x3FE || seen[1][k] != 0x3FE || seen[2][k] != 0x3FE) return 0 ;
+        }
+
+    return 1 ;
+    }
+
+// A shuffled solved grid with all but givens cells emptied
+static void Generate(uint8_t given[CELLS], unsigned givens)
+    {
+    uint8_t digits[9], rows[9], cols[9], bands[3], stacks[3], order[CELLS] ;
+
+    for (int k = 0; k < 9; k++) digits[k] = k + 1 ;
+    for (int k = 0; k < 3; k++) bands[k] = stacks[k] = k ;
+    Shuffle(digits, 9) ;
+    Shuffle(bands, 3) ;
+    Shuffle(stacks, 3) ;
+    for (int band = 0; band < 3; band++)
+        {
+        uint8_t minor[3] = {0, 1, 2} ;
+
+        Shuffle(minor, 3) ;
+        for (int k = 0; k < 3; k++) rows[3*band + k] = 3*bands[band] + minor[k] ;
+        Shuffle(minor, 3) ;
+        for (int k = 0; k < 3; k++) cols[3*band + k] = 3*stacks[band] + minor[k] ;
+        }
+
+    // (3 x (r % 3) + r / 3 + c) % 9 is a valid grid, and the shuffles keep it one
+    for (int index = 0; index < CELLS; index++)
+        {
+        int r = rows[index / 9], c = cols[index % 9] ;
+
+        given[index] = digits[(3*(r % 3) + r / 3 + c) % 9] ;
+        order[index] = index ;
+        }
+    Shuffle(order, CELLS) ;
+    for (unsigned k = givens; k < CELLS; k++) given[order[k]] = EMPTY ;
+    }
+
+// Appends a puzzle from text, or cells if text is NULL; 0 if text is not one
+static int Parse(const char *text, uint8_t cells[CELLS])
+    {
+    uint8_t puzzle[CELLS] ;
+
+    if (text != NULL)
+        {
+        for (int index = 0; index < CELLS; index++)
+            {
+            if (text[index] == '.') puzzle[index] = EMPTY ;
+            else if (text[index] >= '0' && text[index] <= '9') puzzle[index] = text[index] - '0' ;
+            else return 0 ;
+            }
+        cells = puzzle ;
+        }
+
+    if (count == allocated)
+        {
+        allocated = allocated ? 2*allocated : 1024 ;
+        if ((puzzles = realloc(puzzles, allocated * sizeof(puzzles[0]))) == NULL)
+            {
+            fprintf(stderr, "sudokubench: out of memory\n") ;
+            exit(1) ;
+            }
+        }
+    memcpy(puzzles[count++], cells, CELLS) ;
+    return 1 ;
+    }
+
+static void Read(const char *path)
+    {
+    char line[256] ;
+    FILE *file = fopen(path, "r") ;
+
+    if (file == NULL)
+        {
+        perror(path) ;
+        exit(1) ;
+        }
+    while (fgets(line, sizeof(line), file) != NULL)
+        {
+        if (strlen(line) >= CELLS) Parse(line, NULL) ;
+        }
+    fclose(file) ;
+    }
+
+static void Shuffle(uint8_t order[], unsigned items)
+    {
+    for (unsigned k = items - 1; k > 0; k--)
+        {
+        unsigned j = Random() % (k + 1) ;
+        uint8_t swap = order[k] ;
+
+        order[k] = order[j] ;
+        order[j] = swap ;
+        }
+    }
+
+static uint64_t Random(void)
+    {
+    random_state ^= random_state << 13 ;
+    random_state ^= random_state >> 7 ;
+    random_state ^= random_state << 17 ;
+    return random_state ;
+    }
+
+static double Seconds(void)
+    {
+    struct timespec ts ;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return ts.tv_sec + 1e-9 * ts.tv_nsec ;
+    }
+
+static void Usage(void)
+    {
+    fprintf(stderr, "usage: sudokubench [-n puzzles] [-g givens] [-b budget] [-s seed] [file ...]\n") ;
+    exit(1) ;
+    }
@@ -0,0 +1,700 @@
+/*
+    Thumb-2 interpreter: address space, calling convention, the 16-bit instruction
+    set and the helpers shared with Thumb-Wide.c (32-bit integer instructions) and
+    Thumb-VFP.c (floating point). Cycle costs follow the Cortex-M4 TRM tables and
+    are parameterised by cpu->timing.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Thumb-Internal.h"
+
+static void                 AdvanceIT(THUMB_CPU *cpu) ;
+static void                 CallHost(STEP *x) ;
+static void                 Execute(STEP *x) ;
+static void                 ExecuteNarrow(STEP *x, uint16_t hw) ;
+static THUMB_REGION *       FindRegion(THUMB_CPU *cpu, uint32_t adrs, uint32_t size) ;
+static void                 LoadMultiple(STEP *x, unsigned rn, uint32_t list, int writeback) ;
+static void                 StoreMultiple(STEP *x, unsigned rn, uint32_t list, int writeback) ;
+
+static const THUMB_TIMING   cortex_m4 =
+    {
+    .refill = 2,
+    .load = 2,
+    .load_pipelined = 1,
+    .unaligned = 1,
+    .mla = 2,
+    .div_min = 2,
+    .div_max = 12,
+    .fp_latency = 1,
+    .fp_mla = 3,
+    .fp_div = 14,
+    .host_call = 4
+    } ;
+
+THUMB_CPU *ThumbCreate(void)
+    {
+    THUMB_CPU *cpu = calloc(1, sizeof(THUMB_CPU)) ;
+
+    cpu->timing = cortex_m4 ;
+    ThumbMap(cpu, THUMB_FLASH_BASE, THUMB_FLASH_SIZE, calloc(1, THUMB_FLASH_SIZE)) ;
+    ThumbMap(cpu, THUMB_SRAM_BASE,  THUMB_SRAM_SIZE,  calloc(1, THUMB_SRAM_SIZE)) ;
+    ThumbReset(cpu) ;
+    return cpu ;
+    }
+
+void ThumbDestroy(THUMB_CPU *cpu)
+    {
+    free(cpu->region[0].host) ;
+    free(cpu->region[1].host) ;
+    for (int k = 0; k < cpu->symbols; k++) free(cpu->symbol[k].name) ;
+    for (int k = 0; k < cpu->hostfns; k++) free(cpu->hostname[k]) ;
+    free(cpu->symbol) ;
+    free(cpu) ;
+    }
+
+// Clears registers, counters and the SRAM allocator; loaded code is kept
+void ThumbReset(THUMB_CPU *cpu)
+    {
+    memset(cpu->r, 0, sizeof(cpu->r)) ;
+    memset(cpu->s, 0, sizeof(cpu->s)) ;
+    memset(cpu->fp_ready, 0, sizeof(cpu->fp_ready)) ;
+    cpu->apsr = cpu->fpscr = cpu->itstate = 0 ;
+    cpu->cycles = cpu->instructions = 0 ;
+    cpu->fp_busy = 0 ;
+    cpu->status = THUMB_OK ;
+    cpu->sram_used = 0 ;
+    cpu->prev_ls = cpu->prev_narrow = 0 ;
+    }
+
+int ThumbMap(THUMB_CPU *cpu, uint32_t base, uint32_t size, void *host)
+    {
+    if (cpu->regions == THUMB_MAX_REGIONS) return 0 ;
+    cpu->region[cpu->regions].base = base ;
+    cpu->region[cpu->regions].size = size ;
+    cpu->region[cpu->regions].host = host ;
+    cpu->regions++ ;
+    return 1 ;
+    }
+
+// Scratch memory for arguments; 8-byte aligned and zeroed
+uint32_t ThumbAlloc(THUMB_CPU *cpu, uint32_t size)
+    {
+    uint32_t adrs = THUMB_SRAM_BASE + cpu->sram_used ;
+
+    size = (size + 7) & ~7u ;
+    if (cpu->sram_used + size > THUMB_SRAM_SIZE / 2) return 0 ;
+    memset(ThumbHost(cpu, adrs, size), 0, size) ;
+    cpu->sram_used += size ;
+    return adrs ;
+    }
+
+void *ThumbHost(THUMB_CPU *cpu, uint32_t adrs, uint32_t size)
+    {
+    THUMB_REGION *region = FindRegion(cpu, adrs, size) ;
+    return region == NULL ? NULL : region->host + (adrs - region->base) ;
+    }
+
+uint32_t ThumbRead32(THUMB_CPU *cpu, uint32_t adrs)
+    {
+    uint32_t value = 0 ;
+    void *host = ThumbHost(cpu, adrs, 4) ;
+
+    if (host != NULL) memcpy(&value, host, 4) ;
+    return value ;
+    }
+
+void ThumbWrite32(THUMB_CPU *cpu, uint32_t adrs, uint32_t value)
+    {
+    void *host = ThumbHost(cpu, adrs, 4) ;
+    if (host != NULL) memcpy(host, &value, 4) ;
+    }
+
+// AAPCS call: R0-R3 then the stack carry the arguments, S registers must be set by
+// the caller beforehand. Returns when the function returns to THUMB_RETURN.
+THUMB_STATUS ThumbCall(THUMB_CPU *cpu, uint32_t function, const uint32_t *args, int nargs)
+    {
+    uint64_t budget = cpu->limit ? cpu->instructions + cpu->limit : 0 ;
+    STEP x ;
+
+    memset(&x, 0, sizeof(x)) ;
+    x.cpu = cpu ;
+    cpu->status = THUMB_OK ;
+    cpu->itstate = 0 ;
+
+    cpu->r[13] = THUMB_SRAM_BASE + THUMB_SRAM_SIZE ;
+    if (nargs > 4) cpu->r[13] -= ((nargs - 4) * 4 + 7) & ~7u ;
+    for (int k = 0; k < nargs; k++)
+        {
+        if (k < 4) cpu->r[k] = args[k] ;
+        else ThumbWrite32(cpu, cpu->r[13] + 4*(k - 4), args[k]) ;
+        }
+    cpu->r[14] = THUMB_RETURN | 1 ;
+    cpu->r[15] = function & ~1u ;
+
+    if (setjmp(x.fault) != 0) return cpu->status ;
+
+    while (cpu->r[15] != THUMB_RETURN)
+        {
+        if (budget != 0 && cpu->instructions >= budget) Fault(&x, THUMB_FAULT_LIMIT, cpu->r[15]) ;
+        if (cpu->r[15] >= THUMB_HOST_BASE && cpu->r[15] < THUMB_HOST_BASE + 4*THUMB_MAX_HOSTFNS) CallHost(&x) ;
+        else Execute(&x) ;
+        }
+
+    return THUMB_OK ;
+    }
+
+const char *ThumbStatusText(THUMB_STATUS status)
+    {
+    switch (status)
+        {
+        case THUMB_OK:                  return "ok" ;
+        case THUMB_FAULT_MEMORY:        return "memory fault" ;
+        case THUMB_FAULT_ALIGN:         return "alignment fault" ;
+        case THUMB_FAULT_UNDEFINED:     return "undefined instruction" ;
+        case THUMB_FAULT_UNRESOLVED:    return "call to unresolved symbol" ;
+        case THUMB_FAULT_LIMIT:         return "instruction limit reached" ;
+        }
+    return "?" ;
+    }
+
+void Fault(STEP *x, THUMB_STATUS status, uint32_t adrs)
+    {
+    x->cpu->status = status ;
+    x->cpu->fault_pc = x->pc ;
+    x->cpu->fault_adrs = adrs ;
+    longjmp(x->fault, 1) ;
+    }
+
+static THUMB_REGION *FindRegion(THUMB_CPU *cpu, uint32_t adrs, uint32_t size)
+    {
+    for (int k = 0; k < cpu->regions; k++)
+        {
+        THUMB_REGION *region = &cpu->region[k] ;
+        if (adrs - region->base < region->size && adrs - region->base + size <= region->size) return region ;
+        }
+    return NULL ;
+    }
+
+uint32_t Load(STEP *x, uint32_t adrs, int size)
+    {
+    THUMB_REGION *region = FindRegion(x->cpu, adrs, size) ;
+    uint32_t value = 0 ;
+
+    if (region == NULL) Fault(x, THUMB_FAULT_MEMORY, adrs) ;
+    memcpy(&value, region->host + (adrs - region->base), size) ;
+    return value ;
+    }
+
+void Store(STEP *x, uint32_t adrs, int size, uint32_t value)
+    {
+    THUMB_REGION *region = FindRegion(x->cpu, adrs, size) ;
+
+    if (region == NULL) Fault(x, THUMB_FAULT_MEMORY, adrs) ;
+    memcpy(region->host + (adrs - region->base), &value, size) ;
+    }
+
+// Branch within Thumb code (B, CBZ, ADD PC, MOV PC)
+void BranchTo(STEP *x, uint32_t target)
+    {
+    x->next = target & ~1u ;
+    x->cost += x->cpu->timing.refill ;
+    }
+
+// BX semantics (BX, BLX, LDR PC, POP {PC}): bit 0 must select Thumb state
+void InterworkTo(STEP *x, uint32_t target)
+    {
+    if ((target & 1) == 0) Fault(x, THUMB_FAULT_UNDEFINED, target) ;
+    BranchTo(x, target) ;
+    }
+
+// Cost of a single LDR/STR: neighbouring accesses pipeline unless the address
+// depends on the register the previous load wrote; a word-crossing access splits.
+void ChargeSingle(STEP *x, uint32_t adrs, int size, uint32_t base, uint32_t loaded)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    int crosses = (adrs & 3) + size > 4 ;
+
+    if (cpu->prev_ls && (cpu->prev_loaded & base) == 0) x->cost += cpu->timing.load_pipelined - 1 ;
+    else x->cost += cpu->timing.load - 1 ;
+    if (crosses) x->cost += cpu->timing.unaligned ;
+
+    x->ls = !crosses ;
+    x->loaded = loaded ;
+    }
+
+int ConditionPassed(THUMB_CPU *cpu, unsigned cond)
+    {
+    uint32_t f = cpu->apsr ;
+    int n = (f & APSR_N) != 0, z = (f & APSR_Z) != 0 ;
+    int c = (f & APSR_C) != 0, v = (f & APSR_V) != 0 ;
+    int result ;
+
+    switch (cond >> 1)
+        {
+        case 0:  result = z ; break ;
+        case 1:  result = c ; break ;
+        case 2:  result = n ; break ;
+        case 3:  result = v ; break ;
+        case 4:  result = c && !z ; break ;
+        case 5:  result = n == v ; break ;
+        case 6:  result = !z && n == v ; break ;
+        default: return 1 ;
+        }
+
+    return (cond & 1) ? !result : result ;
+    }
+
+uint32_t Shift(uint32_t value, int type, unsigned amount, int carry_in, int *carry_out)
+    {
+    int carry = carry_in ;
+    uint32_t result = value ;
+
+    switch (type)
+        {
+        case SHIFT_LSL:
+            if (amount == 0) break ;
+            carry = amount <= 32 ? BIT((uint64_t) value, 32 - amount) : 0 ;
+            result = amount < 32 ? value << amount : 0 ;
+            break ;
+        case SHIFT_LSR:
+            if (amount == 0) break ;
+            carry = amount <= 32 ? BIT((uint64_t) value, amount - 1) : 0 ;
+            result = amount < 32 ? value >> amount : 0 ;
+            break ;
+        case SHIFT_ASR:
+            if (amount == 0) break ;
+            if (amount >= 32) amount = 32 ;
+            carry = BIT((uint64_t) (int64_t) (int32_t) value, amount - 1) ;
+            result = (uint32_t) ((int64_t) (int32_t) value >> amount) ;
+            break ;
+        case SHIFT_ROR:
+            if (amount == 0) break ;
+            amount &= 31 ;
+            result = amount ? (value >> amount) | (value << (32 - amount)) : value ;
+            carry = result >> 31 ;
+            break ;
+        case SHIFT_RRX:
+            result = ((uint32_t) carry_in << 31) | (value >> 1) ;
+            carry = value & 1 ;
+            break ;
+        }
+
+    if (carry_out != NULL) *carry_out = carry ;
+    return result ;
+    }
+
+uint32_t AddWithCarry(uint32_t x, uint32_t y, int carry_in, int *carry, int *overflow)
+    {
+    uint64_t usum = (uint64_t) x + y + carry_in ;
+    int64_t ssum = (int64_t) (int32_t) x + (int32_t) y + carry_in ;
+    uint32_t result = (uint32_t) usum ;
+
+    *carry = usum != result ;
+    *overflow = ssum != (int32_t) result ;
+    return result ;
+    }
+
+void SetNZ(THUMB_CPU *cpu, uint32_t result)
+    {
+    cpu->apsr &= ~(APSR_N | APSR_Z) ;
+    if (result & 0x80000000) cpu->apsr |= APSR_N ;
+    if (result == 0) cpu->apsr |= APSR_Z ;
+    }
+
+void SetNZC(THUMB_CPU *cpu, uint32_t result, int carry)
+    {
+    SetNZ(cpu, result) ;
+    cpu->apsr = carry ? cpu->apsr | APSR_C : cpu->apsr & ~APSR_C ;
+    }
+
+void SetNZCV(THUMB_CPU *cpu, uint32_t result, int carry, int overflow)
+    {
+    SetNZC(cpu, result, carry) ;
+    cpu->apsr = overflow ? cpu->apsr | APSR_V : cpu->apsr & ~APSR_V ;
+    }
+
+uint32_t ReverseBits(uint32_t value)
+    {
+    uint32_t result = 0 ;
+
+    for (int k = 0; k < 32; k++, value >>= 1) result = (result << 1) | (value & 1) ;
+    return result ;
+    }
+
+unsigned CountLeadingZeros(uint32_t value)
+    {
+    return value == 0 ? 32 : __builtin_clz(value) ;
+    }
+
+static void AdvanceIT(THUMB_CPU *cpu)
+    {
+    if ((cpu->itstate & 7) == 0) cpu->itstate = 0 ;
+    else cpu->itstate = (cpu->itstate & 0xE0) | ((cpu->itstate << 1) & 0x1F) ;
+    }
+
+static void CallHost(STEP *x)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    int which = (cpu->r[15] - THUMB_HOST_BASE) / 4 ;
+
+    x->pc = cpu->r[15] ;
+    if (cpu->hostfn[which] == NULL) Fault(x, THUMB_FAULT_UNRESOLVED, which) ;
+    cpu->hostfn[which](cpu) ;
+    cpu->cycles += cpu->timing.host_call ;
+    cpu->r[15] = cpu->r[14] & ~1u ;
+    cpu->prev_ls = 0 ;
+    }
+
+static void Execute(STEP *x)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint16_t hw1, hw2 ;
+    int wide, in_it ;
+
+    x->pc = cpu->r[15] ;
+    x->cost = 0 ;
+    x->ls = 0 ;
+    x->loaded = 0 ;
+
+    hw1 = Load(x, x->pc, 2) ;
+    wide = (hw1 >> 11) >= 0x1D ;
+    hw2 = wide ? Load(x, x->pc + 2, 2) : 0 ;
+    x->next = x->pc + (wide ? 4 : 2) ;
+    cpu->r[15] = x->pc + 4 ;
+
+    // Every instruction costs one cycle plus whatever its class adds to x->cost;
+    // one that fails its IT condition costs just the one
+    in_it = cpu->itstate != 0 ;
+    if (in_it && !ConditionPassed(cpu, cpu->itstate >> 4)) ;
+    else if (wide) ExecuteWide(x, hw1, hw2) ;
+    else ExecuteNarrow(x, hw1) ;
+    if (in_it) AdvanceIT(cpu) ;
+
+    // IT folds into a preceding 16-bit instruction
+    if ((hw1 & 0xFF00) == 0xBF00 && (hw1 & 0xF) != 0 && cpu->prev_narrow) ;
+    else cpu->cycles += 1 + x->cost ;
+
+    cpu->r[15] = x->next ;
+    cpu->instructions++ ;
+    cpu->prev_ls = x->ls ;
+    cpu->prev_loaded = x->loaded ;
+    cpu->prev_narrow = !wide ;
+    }
+
+static void LoadMultiple(STEP *x, unsigned rn, uint32_t list, int writeback)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t adrs = cpu->r[rn] ;
+    int count = __builtin_popcount(list) ;
+
+    if (adrs & 3) Fault(x, THUMB_FAULT_ALIGN, adrs) ;
+    if (writeback && !(list & (1u << rn))) cpu->r[rn] = adrs + 4*count ;
+    for (int k = 0; k < 15; k++)
+        {
+        if (!(list & (1u << k))) continue ;
+        cpu->r[k] = Load(x, adrs, 4) ;
+        adrs += 4 ;
+        }
+    x->cost += count ;
+    if (list & 0x8000) InterworkTo(x, Load(x, adrs, 4)) ;
+    }
+
+static void StoreMultiple(STEP *x, unsigned rn, uint32_t list, int writeback)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t adrs = cpu->r[rn] ;
+    int count = __builtin_popcount(list) ;
+
+    if (adrs & 3) Fault(x, THUMB_FAULT_ALIGN, adrs) ;
+    for (int k = 0; k < 15; k++)
+        {
+        if (!(list & (1u << k))) continue ;
+        Store(x, adrs, 4, cpu->r[k]) ;
+        adrs += 4 ;
+        }
+    if (writeback) cpu->r[rn] = adrs ;
+    x->cost += count ;
+    }
+
+// 16-bit encodings, ARMv7-M ARM section A5.2
+static void ExecuteNarrow(STEP *x, uint16_t hw)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t *r = cpu->r ;
+    int setflags = cpu->itstate == 0 ;
+    int carry = (cpu->apsr & APSR_C) != 0, overflow ;
+    unsigned rd = BITS(hw, 2, 0), rn = BITS(hw, 5, 3), rm = BITS(hw, 8, 6) ;
+    uint32_t result, adrs ;
+
+    switch (hw >> 12)
+        {
+        case 0x0:
+        case 0x1:
+            if (BITS(hw, 12, 11) != 3)
+                {
+                // LSL/LSR/ASR (immediate)
+                int type = BITS(hw, 12, 11) ;
+                unsigned amount = BITS(hw, 10, 6) ;
+
+                if (amount == 0 && type != SHIFT_LSL) amount = 32 ;
+                result = Shift(r[rn], type, amount, carry, &carry) ;
+                r[rd] = result ;
+                if (setflags) SetNZC(cpu, result, carry) ;
+                }
+            else
+                {
+                // ADD/SUB register or 3-bit immediate
+                uint32_t operand = BIT(hw, 10) ? rm : r[rm] ;
+
+                if (BIT(hw, 9)) result = AddWithCarry(r[rn], ~operand, 1, &carry, &overflow) ;
+                else result = AddWithCarry(r[rn], operand, 0, &carry, &overflow) ;
+                r[rd] = result ;
+                if (setflags) SetNZCV(cpu, result, carry, overflow) ;
+                }
+            break ;
+
+        case 0x2:
+        case 0x3:
+            {
+            // MOV/CMP/ADD/SUB 8-bit immediate
+            unsigned rdn = BITS(hw, 10, 8) ;
+            uint32_t imm = hw & 0xFF ;
+
+            switch (BITS(hw, 12, 11))
+                {
+                case 0:
+                    r[rdn] = imm ;
+                    if (setflags) SetNZ(cpu, imm) ;
+                    break ;
+                case 1:
+                    result = AddWithCarry(r[rdn], ~imm, 1, &carry, &overflow) ;
+                    SetNZCV(cpu, result, carry, overflow) ;
+                    break ;
+                case 2:
+                    r[rdn] = result = AddWithCarry(r[rdn], imm, 0, &carry, &overflow) ;
+                    if (setflags) SetNZCV(cpu, result, carry, overflow) ;
+                    break ;
+                case 3:
+                    r[rdn] = result = AddWithCarry(r[rdn], ~imm, 1, &carry, &overflow) ;
+                    if (setflags) SetNZCV(cpu, result, carry, overflow) ;
+                    break ;
+                }
+            break ;
+            }
+
+        case 0x4:
+            if (BITS(hw, 11, 10) == 0)
+                {
+                // Data processing (register)
+                uint32_t n = r[rd], m = r[rn] ;
+                int write = 1, arith = 0 ;
+
+                switch (BITS(hw, 9, 6))
+                    {
+                    case 0x0: result = n & m ; break ;
+                    case 0x1: result = n ^ m ; break ;
+                    case 0x2: result = Shift(n, SHIFT_LSL, m & 0xFF, carry, &carry) ; break ;
+                    case 0x3: result = Shift(n, SHIFT_LSR, m & 0xFF, carry, &carry) ; break ;
+                    case 0x4: result = Shift(n, SHIFT_ASR, m & 0xFF, carry, &carry) ; break ;
+                    case 0x5: result = AddWithCarry(n, m, carry, &carry, &overflow) ; arith = 1 ; break ;
+                    case 0x6: result = AddWithCarry(n, ~m, carry, &carry, &overflow) ; arith = 1 ; break ;
+                    case 0x7: result = Shift(n, SHIFT_ROR, m & 0xFF, carry, &carry) ; break ;
+                    case 0x8: result = n & m ; write = 0 ; break ;
+                    case 0x9: result = AddWithCarry(~m, 0, 1, &carry, &overflow) ; arith = 1 ; break ;
+                    case 0xA: result = AddWithCarry(n, ~m, 1, &carry, &overflow) ; arith = 1 ; write = 0 ; break ;
+                    case 0xB: result = AddWithCarry(n, m, 0, &carry, &overflow) ; arith = 1 ; write = 0 ; break ;
+                    case 0xC: result = n | m ; break ;
+                    case 0xD: result = n * m ; break ;
+                    case 0xE: result = n & ~m ; break ;
+                    default:  result = ~m ; break ;
+                    }
+
+                if (write) r[rd] = result ;
+                if (setflags || !write)
+                    {
+                    if (arith) SetNZCV(cpu, result, carry, overflow) ;
+                    else SetNZC(cpu, result, carry) ;
+                    }
+                }
+            else if (BITS(hw, 11, 10) == 1)
+                {
+                // Special data processing and branch/exchange on R0-R15
+                unsigned dn = (BIT(hw, 7) << 3) | rd ;
+                unsigned m = BITS(hw, 6, 3) ;
+
+                switch (BITS(hw, 9, 8))
+                    {
+                    case 0:
+                        result = r[dn] + r[m] ;
+                        if (dn == 15) BranchTo(x, result) ;
+                        else r[dn] = result ;
+                        break ;
+                    case 1:
+                        result = AddWithCarry(r[dn], ~r[m], 1, &carry, &overflow) ;
+                        SetNZCV(cpu, result, carry, overflow) ;
+                        break ;
+                    case 2:
+                        if (dn == 15) BranchTo(x, r[m]) ;
+                        else r[dn] = r[m] ;
+                        break ;
+                    case 3:
+                        result = r[m] ;
+                        if (BIT(hw, 7)) r[14] = x->next | 1 ;
+                        InterworkTo(x, result) ;
+                        break ;
+                    }
+                }
+            else
+                {
+                // LDR (literal)
+                adrs = ((x->pc + 4) & ~3u) + 4*(hw & 0xFF) ;
+                r[BITS(hw, 10, 8)] = Load(x, adrs, 4) ;
+                ChargeSingle(x, adrs, 4, 0, 1u << BITS(hw, 10, 8)) ;
+                }
+            break ;
+
+        case 0x5:
+            {
+            // Load/store register offset
+            static const int size[8] = {4, 2, 1, 1, 4, 2, 1, 2} ;
+            unsigned op = BITS(hw, 11, 9) ;
+
+            adrs = r[rn] + r[rm] ;
+            switch (op)
+                {
+                case 0: Store(x, adrs, 4, r[rd]) ; break ;
+                case 1: Store(x, adrs, 2, r[rd]) ; break ;
+                case 2: Store(x, adrs, 1, r[rd]) ; break ;
+                case 3: r[rd] = (int8_t) Load(x, adrs, 1) ; break ;
+                case 4: r[rd] = Load(x, adrs, 4) ; break ;
+                case 5: r[rd] = Load(x, adrs, 2) ; break ;
+                case 6: r[rd] = Load(x, adrs, 1) ; break ;
+                case 7: r[rd] = (int16_t) Load(x, adrs, 2) ; break ;
+                }
+            ChargeSingle(x, adrs, size[op], (1u << rn) | (1u << rm), op >= 3 ? 1u << rd : 0) ;
+            break ;
+            }
+
+        case 0x6:
+        case 0x7:
+        case 0x8:
+            {
+            // Load/store word, byte, halfword (immediate)
+            int bytes = (hw >> 12) == 0x8 ? 2 : BIT(hw, 12) ? 1 : 4 ;
+
+            adrs = r[rn] + bytes * BITS(hw, 10, 6) ;
+            if (BIT(hw, 11)) r[rd] = Load(x, adrs, bytes) ;
+            else Store(x, adrs, bytes, r[rd]) ;
+            ChargeSingle(x, adrs, bytes, 1u << rn, BIT(hw, 11) ? 1u << rd : 0) ;
+            break ;
+            }
+
+        case 0x9:
+            {
+            // Load/store SP relative
+            unsigned rt = BITS(hw, 10, 8) ;
+
+            adrs = r[13] + 4*(hw & 0xFF) ;
+            if (BIT(hw, 11)) r[rt] = Load(x, adrs, 4) ;
+            else Store(x, adrs, 4, r[rt]) ;
+            ChargeSingle(x, adrs, 4, 1u << 13, BIT(hw, 11) ? 1u << rt : 0) ;
+            break ;
+            }
+
+        case 0xA:
+            // ADR, ADD Rd,SP,#imm
+            if (BIT(hw, 11)) r[BITS(hw, 10, 8)] = r[13] + 4*(hw & 0xFF) ;
+            else r[BITS(hw, 10, 8)] = ((x->pc + 4) & ~3u) + 4*(hw & 0xFF) ;
+            break ;
+
+        case 0xB:
+            // Miscellaneous
+            if ((hw & 0xFF00) == 0xB000)
+                {
+                if (BIT(hw, 7)) r[13] -= 4*(hw & 0x7F) ;
+                else r[13] += 4*(hw & 0x7F) ;
+                }
+            else if ((hw & 0xF500) == 0xB100)
+                {
+                // CBZ, CBNZ
+                uint32_t offset = (BIT(hw, 9) << 6) | (BITS(hw, 7, 3) << 1) ;
+                if ((r[rd] == 0) != BIT(hw, 11)) BranchTo(x, x->pc + 4 + offset) ;
+                }
+            else if ((hw & 0xFF00) == 0xB200)
+                {
+                switch (BITS(hw, 7, 6))
+                    {
+                    case 0: r[rd] = (int16_t) r[rn] ; break ;
+                    case 1: r[rd] = (int8_t) r[rn] ; break ;
+                    case 2: r[rd] = (uint16_t) r[rn] ; break ;
+                    case 3: r[rd] = (uint8_t) r[rn] ; break ;
+                    }
+                }
+            else if ((hw & 0xFE00) == 0xB400)
+                {
+                // PUSH
+                uint32_t list = (hw & 0xFF) | (BIT(hw, 8) << 14) ;
+                r[13] -= 4*__builtin_popcount(list) ;
+                StoreMultiple(x, 13, list, 0) ;
+                }
+            else if ((hw & 0xFFE8) == 0xB660)
+                {
+                // CPS: interrupts are not modelled
+                }
+            else if ((hw & 0xFF00) == 0xBA00 && BITS(hw, 7, 6) != 2)
+                {
+                uint32_t m = r[rn] ;
+
+                switch (BITS(hw, 7, 6))
+                    {
+                    case 0: r[rd] = __builtin_bswap32(m) ; break ;
+                    case 1: r[rd] = ((m & 0x00FF00FF) << 8) | ((m >> 8) & 0x00FF00FF) ; break ;
+                    case 3: r[rd] = (uint32_t) (int16_t) ((m << 8) | ((m >> 8) & 0xFF)) ; break ;
+                    }
+                }
+            else if ((hw & 0xFE00) == 0xBC00)
+                {
+                // POP
+                uint32_t list = (hw & 0xFF) | (BIT(hw, 8) << 15) ;
+                LoadMultiple(x, 13, list, 1) ;
+                }
+            else if ((hw & 0xFF00) == 0xBF00)
+                {
+                // IT, or a hint (NOP, YIELD, WFE, WFI, SEV) when the mask is zero
+                if (hw & 0xF) cpu->itstate = hw & 0xFF ;
+                }
+            else Fault(x, THUMB_FAULT_UNDEFINED, hw) ;
+            break ;
+
+        case 0xC:
+            {
+            // STMIA/LDMIA
+            unsigned rb = BITS(hw, 10, 8) ;
+
+            if (BIT(hw, 11)) LoadMultiple(x, rb, hw & 0xFF, 1) ;
+            else StoreMultiple(x, rb, hw & 0xFF, 1) ;
+            break ;
+            }
+
+        case 0xD:
+            {
+            // B<cond>, UDF, SVC
+            unsigned cond = BITS(hw, 11, 8) ;
+
+            if (cond >= 0xE) Fault(x, THUMB_FAULT_UNDEFINED, hw) ;
+            if (ConditionPassed(cpu, cond)) BranchTo(x, x->pc + 4 + (uint32_t) ((int32_t) (int8_t) hw << 1)) ;
+            break ;
+            }
+
+        case 0xE:
+            // B
+            BranchTo(x, x->pc + 4 + (uint32_t) ((int32_t) ((uint32_t) hw << 21) >> 20)) ;
+            break ;
+
+        default:
+            Fault(x, THUMB_FAULT_UNDEFINED, hw) ;
+        }
+    }
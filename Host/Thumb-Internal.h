@@ -0,0 +1,66 @@
+/*
+    Shared between the Thumb-CPU.c, Thumb-Wide.c and Thumb-VFP.c parts of the
+    interpreter. Not for use outside of it.
+*/
+
+#ifndef __THUMB_INTERNAL_H
+#define __THUMB_INTERNAL_H
+
+#include <setjmp.h>
+#include <stdint.h>
+#include "Thumb.h"
+
+#define APSR_N              (1u << 31)
+#define APSR_Z              (1u << 30)
+#define APSR_C              (1u << 29)
+#define APSR_V              (1u << 28)
+#define APSR_Q              (1u << 27)
+#define APSR_GE_SHIFT       16
+
+#define SHIFT_LSL           0
+#define SHIFT_LSR           1
+#define SHIFT_ASR           2
+#define SHIFT_ROR           3
+#define SHIFT_RRX           4
+
+#define BIT(x, n)           (((x) >> (n)) & 1)
+#define BITS(x, hi, lo)     (((x) >> (lo)) & ((1u << ((hi) - (lo) + 1)) - 1))
+
+// State of the instruction being executed
+typedef struct
+    {
+    THUMB_CPU *             cpu ;
+    uint32_t                pc ;            // address of the instruction (R15 reads as pc + 4)
+    uint32_t                next ;          // address of the next instruction
+    unsigned                cost ;          // cycles charged so far
+    int                     ls ;            // single LDR/STR that the next one may pipeline with
+    uint32_t                loaded ;        // registers written by that LDR
+    uint32_t                base ;          // registers used to form its address
+    jmp_buf                 fault ;
+    } STEP ;
+
+// Thumb-CPU.c
+void                        Fault(STEP *x, THUMB_STATUS status, uint32_t adrs) ;
+uint32_t                    Load(STEP *x, uint32_t adrs, int size) ;
+void                        Store(STEP *x, uint32_t adrs, int size, uint32_t value) ;
+void                        BranchTo(STEP *x, uint32_t target) ;
+void                        InterworkTo(STEP *x, uint32_t target) ;
+void                        ChargeSingle(STEP *x, uint32_t adrs, int size, uint32_t base, uint32_t loaded) ;
+int                         ConditionPassed(THUMB_CPU *cpu, unsigned cond) ;
+uint32_t                    Shift(uint32_t value, int type, unsigned amount, int carry_in, int *carry_out) ;
+uint32_t                    AddWithCarry(uint32_t x, uint32_t y, int carry_in, int *carry, int *overflow) ;
+void                        SetNZ(THUMB_CPU *cpu, uint32_t result) ;
+void                        SetNZC(THUMB_CPU *cpu, uint32_t result, int carry) ;
+void                        SetNZCV(THUMB_CPU *cpu, uint32_t result, int carry, int overflow) ;
+uint32_t                    ReverseBits(uint32_t value) ;
+unsigned                    CountLeadingZeros(uint32_t value) ;
+
+// Thumb-Wide.c
+void                        ExecuteWide(STEP *x, uint16_t hw1, uint16_t hw2) ;
+int32_t                     SignedSaturate(int64_t value, unsigned bits, int *saturated) ;
+uint32_t                    UnsignedSaturate(int64_t value, unsigned bits, int *saturated) ;
+
+// Thumb-VFP.c
+void                        ExecuteVFP(STEP *x, uint16_t hw1, uint16_t hw2) ;
+
+#endif
@@ -0,0 +1,321 @@
+/*
+    ELF32 relocatable object loader and linker for the Thumb-2 interpreter. Each
+    allocated section is copied into the flash region; global symbols from every
+    object are collected, and relocations are applied once all objects are loaded.
+    Undefined symbols resolve to another object's global, to a host callback bound
+    with ThumbBind(), or to a stub that faults with THUMB_FAULT_UNRESOLVED.
+*/
+
+#include <elf.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Thumb.h"
+
+// Older <elf.h> files know these by their pre-EABI names
+#ifndef SHT_ARM_EXIDX
+#define SHT_ARM_EXIDX       0x70000001
+#endif
+#ifndef R_ARM_THM_CALL
+#define R_ARM_THM_CALL      10
+#endif
+#ifndef R_ARM_THM_JUMP11
+#define R_ARM_THM_JUMP11    102
+#endif
+#ifndef R_ARM_THM_JUMP8
+#define R_ARM_THM_JUMP8     103
+#endif
+
+struct THUMB_OBJECT
+    {
+    char *                  path ;
+    uint8_t *               file ;
+    size_t                  size ;
+    Elf32_Ehdr *            ehdr ;
+    Elf32_Shdr *            shdr ;
+    uint32_t *              adrs ;          // guest address of each allocated section
+    struct THUMB_OBJECT *   next ;
+    } ;
+
+typedef struct THUMB_OBJECT OBJECT ;
+
+static int                  AddSymbol(THUMB_CPU *cpu, const char *name, uint32_t value) ;
+static int                  Relocate(THUMB_CPU *cpu, OBJECT *obj, Elf32_Shdr *rel) ;
+static uint32_t             Resolve(THUMB_CPU *cpu, OBJECT *obj, Elf32_Sym *sym, const char *name) ;
+
+int ThumbLoadObject(THUMB_CPU *cpu, const char *path)
+    {
+    OBJECT *obj ;
+    FILE *fp ;
+    long size ;
+
+    if ((fp = fopen(path, "rb")) == NULL)
+        {
+        perror(path) ;
+        return 0 ;
+        }
+    fseek(fp, 0, SEEK_END) ;
+    size = ftell(fp) ;
+    rewind(fp) ;
+
+    obj = calloc(1, sizeof(OBJECT)) ;
+    obj->path = strdup(path) ;
+    obj->size = size ;
+    obj->file = malloc(size) ;
+    if (fread(obj->file, 1, size, fp) != (size_t) size) size = 0 ;
+    fclose(fp) ;
+
+    obj->ehdr = (Elf32_Ehdr *) obj->file ;
+    if (size < (long) sizeof(Elf32_Ehdr) || memcmp(obj->ehdr->e_ident, ELFMAG, SELFMAG) != 0
+        || obj->ehdr->e_ident[EI_CLASS] != ELFCLASS32 || obj->ehdr->e_ident[EI_DATA] != ELFDATA2LSB
+        || obj->ehdr->e_machine != EM_ARM || obj->ehdr->e_type != ET_REL)
+        {
+        fprintf(stderr, "%s: not an ARM ELF32 relocatable object\n", path) ;
+        free(obj->file) ;
+        free(obj->path) ;
+        free(obj) ;
+        return 0 ;
+        }
+
+    obj->shdr = (Elf32_Shdr *) (obj->file + obj->ehdr->e_shoff) ;
+    obj->adrs = calloc(obj->ehdr->e_shnum, sizeof(uint32_t)) ;
+
+    // Place every allocated section in flash, honoring its alignment
+    for (int sec = 0; sec < obj->ehdr->e_shnum; sec++)
+        {
+        Elf32_Shdr *sh = &obj->shdr[sec] ;
+        uint32_t align = sh->sh_addralign ? sh->sh_addralign : 1 ;
+        uint32_t offset ;
+
+        if ((sh->sh_flags & SHF_ALLOC) == 0 || sh->sh_type == SHT_ARM_EXIDX) continue ;
+
+        offset = (cpu->flash_used + align - 1) & ~(align - 1) ;
+        if (offset + sh->sh_size > THUMB_FLASH_SIZE)
+            {
+            fprintf(stderr, "%s: flash region full\n", path) ;
+            return 0 ;
+            }
+        obj->adrs[sec] = THUMB_FLASH_BASE + offset ;
+        if (sh->sh_type == SHT_PROGBITS)
+            {
+            memcpy(ThumbHost(cpu, obj->adrs[sec], sh->sh_size), obj->file + sh->sh_offset, sh->sh_size) ;
+            }
+        cpu->flash_used = offset + sh->sh_size ;
+        }
+
+    // Collect the globals this object defines
+    for (int sec = 0; sec < obj->ehdr->e_shnum; sec++)
+        {
+        Elf32_Shdr *sh = &obj->shdr[sec] ;
+        Elf32_Sym *sym ;
+        const char *strtab ;
+        int count ;
+
+        if (sh->sh_type != SHT_SYMTAB) continue ;
+        sym = (Elf32_Sym *) (obj->file + sh->sh_offset) ;
+        strtab = (const char *) obj->file + obj->shdr[sh->sh_link].sh_offset ;
+        count = sh->sh_size / sizeof(Elf32_Sym) ;
+
+        for (int k = 1; k < count; k++)
+            {
+            int bind = ELF32_ST_BIND(sym[k].st_info) ;
+
+            if (sym[k].st_shndx == SHN_UNDEF || sym[k].st_shndx >= SHN_LORESERVE) continue ;
+            if (bind != STB_GLOBAL && bind != STB_WEAK) continue ;
+            if (obj->adrs[sym[k].st_shndx] == 0) continue ;
+            if (!AddSymbol(cpu, strtab + sym[k].st_name, obj->adrs[sym[k].st_shndx] + sym[k].st_value))
+                {
+                fprintf(stderr, "%s: duplicate symbol %s\n", path, strtab + sym[k].st_name) ;
+                }
+            }
+        }
+
+    obj->next = cpu->objects ;
+    cpu->objects = obj ;
+    return 1 ;
+    }
+
+void ThumbBind(THUMB_CPU *cpu, const char *name, THUMB_HOSTFN function)
+    {
+    for (int k = 0; k < cpu->hostfns; k++)
+        {
+        if (strcmp(cpu->hostname[k], name) != 0) continue ;
+        cpu->hostfn[k] = function ;
+        return ;
+        }
+    if (cpu->hostfns == THUMB_MAX_HOSTFNS) return ;
+    cpu->hostname[cpu->hostfns] = strdup(name) ;
+    cpu->hostfn[cpu->hostfns++] = function ;
+    }
+
+int ThumbLink(THUMB_CPU *cpu)
+    {
+    int ok = 1 ;
+
+    for (OBJECT *obj = cpu->objects; obj != NULL; obj = obj->next)
+        {
+        for (int sec = 0; sec < obj->ehdr->e_shnum; sec++)
+            {
+            Elf32_Shdr *sh = &obj->shdr[sec] ;
+            if (sh->sh_type != SHT_REL || obj->adrs[sh->sh_info] == 0) continue ;
+            if (!Relocate(cpu, obj, sh)) ok = 0 ;
+            }
+        }
+
+    return ok ;
+    }
+
+uint32_t ThumbSymbol(THUMB_CPU *cpu, const char *name)
+    {
+    for (int k = 0; k < cpu->symbols; k++)
+        {
+        if (strcmp(cpu->symbol[k].name, name) == 0) return cpu->symbol[k].value ;
+        }
+    return 0 ;
+    }
+
+static int AddSymbol(THUMB_CPU *cpu, const char *name, uint32_t value)
+    {
+    if (ThumbSymbol(cpu, name) != 0) return 0 ;
+    cpu->symbol = realloc(cpu->symbol, (cpu->symbols + 1) * sizeof(THUMB_SYMBOL)) ;
+    cpu->symbol[cpu->symbols].name = strdup(name) ;
+    cpu->symbol[cpu->symbols].value = value ;
+    cpu->symbols++ ;
+    return 1 ;
+    }
+
+static uint32_t Resolve(THUMB_CPU *cpu, OBJECT *obj, Elf32_Sym *sym, const char *name)
+    {
+    uint32_t value ;
+
+    if (sym->st_shndx == SHN_ABS) return sym->st_value ;
+    if (sym->st_shndx != SHN_UNDEF) return obj->adrs[sym->st_shndx] + sym->st_value ;
+
+    if ((value = ThumbSymbol(cpu, name)) != 0) return value ;
+
+    // Not defined by any object: route calls to a host callback (possibly NULL)
+    for (int k = 0; k < cpu->hostfns; k++)
+        {
+        if (strcmp(cpu->hostname[k], name) == 0) return (THUMB_HOST_BASE + 4*k) | 1 ;
+        }
+    ThumbBind(cpu, name, NULL) ;
+    return (THUMB_HOST_BASE + 4*(cpu->hostfns - 1)) | 1 ;
+    }
+
+static uint32_t DecodeBranch24(uint16_t hw1, uint16_t hw2)
+    {
+    uint32_t s = (hw1 >> 10) & 1 ;
+    uint32_t i1 = !(((hw2 >> 13) & 1) ^ s) ;
+    uint32_t i2 = !(((hw2 >> 11) & 1) ^ s) ;
+    uint32_t imm = (s << 24) | (i1 << 23) | (i2 << 22) | ((hw1 & 0x3FF) << 12) | ((hw2 & 0x7FF) << 1) ;
+    return (uint32_t) ((int32_t) (imm << 7) >> 7) ;
+    }
+
+static void EncodeBranch24(uint16_t *hw, uint32_t offset)
+    {
+    uint32_t s = (offset >> 24) & 1 ;
+    uint32_t j1 = !((offset >> 23) & 1) ^ s ;
+    uint32_t j2 = !((offset >> 22) & 1) ^ s ;
+
+    hw[0] = (hw[0] & 0xF800) | (s << 10) | ((offset >> 12) & 0x3FF) ;
+    hw[1] = (hw[1] & 0xD000) | (j1 << 13) | (j2 << 11) | ((offset >> 1) & 0x7FF) ;
+    }
+
+static uint32_t DecodeBranch19(uint16_t hw1, uint16_t hw2)
+    {
+    uint32_t imm = (((hw1 >> 10) & 1) << 20) | (((hw2 >> 11) & 1) << 19) | (((hw2 >> 13) & 1) << 18)
+                 | ((hw1 & 0x3F) << 12) | ((hw2 & 0x7FF) << 1) ;
+    return (uint32_t) ((int32_t) (imm << 11) >> 11) ;
+    }
+
+static void EncodeBranch19(uint16_t *hw, uint32_t offset)
+    {
+    hw[0] = (hw[0] & 0xFBC0) | (((offset >> 20) & 1) << 10) | ((offset >> 12) & 0x3F) ;
+    hw[1] = (hw[1] & 0xD000) | (((offset >> 18) & 1) << 13) | (((offset >> 19) & 1) << 11) | ((offset >> 1) & 0x7FF) ;
+    }
+
+static int Relocate(THUMB_CPU *cpu, OBJECT *obj, Elf32_Shdr *rel)
+    {
+    Elf32_Shdr *symtab = &obj->shdr[rel->sh_link] ;
+    Elf32_Sym *syms = (Elf32_Sym *) (obj->file + symtab->sh_offset) ;
+    const char *strtab = (const char *) obj->file + obj->shdr[symtab->sh_link].sh_offset ;
+    Elf32_Rel *r = (Elf32_Rel *) (obj->file + rel->sh_offset) ;
+    int count = rel->sh_size / sizeof(Elf32_Rel) ;
+    uint32_t base = obj->adrs[rel->sh_info] ;
+    int ok = 1 ;
+
+    for (int k = 0; k < count; k++, r++)
+        {
+        Elf32_Sym *sym = &syms[ELF32_R_SYM(r->r_info)] ;
+        const char *name = strtab + sym->st_name ;
+        uint32_t P = base + r->r_offset ;
+        uint32_t S = Resolve(cpu, obj, sym, name) ;
+        uint32_t T = S & 1 ;
+        uint16_t *hw = (uint16_t *) ThumbHost(cpu, P, 4) ;
+        uint32_t *word = (uint32_t *) hw ;
+        uint32_t A, imm ;
+
+        S &= ~1u ;
+        switch (ELF32_R_TYPE(r->r_info))
+            {
+            case R_ARM_NONE:
+            case R_ARM_V4BX:
+                break ;
+
+            case R_ARM_ABS32:
+                *word = (S + *word) | T ;
+                break ;
+
+            case R_ARM_REL32:
+                *word = ((S + *word) | T) - P ;
+                break ;
+
+            case R_ARM_THM_CALL:
+            case R_ARM_THM_JUMP24:
+                A = DecodeBranch24(hw[0], hw[1]) ;
+                EncodeBranch24(hw, ((S + A) | T) - P) ;
+                break ;
+
+            case R_ARM_THM_JUMP19:
+                A = DecodeBranch19(hw[0], hw[1]) ;
+                EncodeBranch19(hw, S + A - P) ;
+                break ;
+
+            case R_ARM_THM_JUMP11:
+                A = (uint32_t) ((int32_t) ((hw[0] & 0x7FF) << 21) >> 20) ;
+                hw[0] = (hw[0] & 0xF800) | (((S + A - P) >> 1) & 0x7FF) ;
+                break ;
+
+            case R_ARM_THM_JUMP8:
+                A = (uint32_t) ((int32_t) ((hw[0] & 0xFF) << 24) >> 23) ;
+                hw[0] = (hw[0] & 0xFF00) | (((S + A - P) >> 1) & 0xFF) ;
+                break ;
+
+            case R_ARM_THM_MOVW_ABS_NC:
+            case R_ARM_THM_MOVT_ABS:
+                A = ((hw[0] & 0xF) << 12) | (((hw[0] >> 10) & 1) << 11) | (((hw[1] >> 12) & 7) << 8) | (hw[1] & 0xFF) ;
+                A = (uint32_t) (int32_t) (int16_t) A ;
+                imm = (S + A) | T ;
+                if (ELF32_R_TYPE(r->r_info) == R_ARM_THM_MOVT_ABS) imm = (S + A) >> 16 ;
+                hw[0] = (hw[0] & 0xFBF0) | ((imm >> 12) & 0xF) | (((imm >> 11) & 1) << 10) ;
+                hw[1] = (hw[1] & 0x8F00) | (((imm >> 8) & 7) << 12) | (imm & 0xFF) ;
+                break ;
+
+            case R_ARM_THM_PC12:
+                A = (hw[0] & 0x80) ? (hw[1] & 0xFFF) : -(hw[1] & 0xFFF) ;
+                imm = S + A - (P & ~3u) ;
+                if ((int32_t) imm >= 0) hw[0] |= 0x80 ;
+                else hw[0] &= ~0x80, imm = -imm ;
+                hw[1] = (hw[1] & 0xF000) | (imm & 0xFFF) ;
+                break ;
+
+            default:
+                fprintf(stderr, "%s: unsupported relocation type %d for %s\n", obj->path, (int) ELF32_R_TYPE(r->r_info), name) ;
+                ok = 0 ;
+                break ;
+            }
+        }
+
+    return ok ;
+    }
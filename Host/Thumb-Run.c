@@ -0,0 +1,134 @@
+/*
+    thumbrun: load assembled lab objects into the Thumb-2 interpreter, call one
+    function and report its results and modelled Cortex-M4 cycle count.
+
+        thumbrun [options] file.o... Function [arg...]
+
+    Arguments go into R0-R3 then the stack in order; an argument written as a
+    floating point number (1.5 or 2f) goes into the next S register instead, and
+    @N is the address of word N of a 4 KB zeroed scratch buffer.
+
+        -w N=V      store V (a number or @M) in scratch word N before the call
+        -p N        print the first N scratch words after the call
+        -l N        give up after N instructions (default 10000000)
+        -r N        call the function N times and report the cycles of the last
+
+    Examples:
+
+        thumbrun build/arm/Lab8C-Resistors.o Div32X10 1234567
+        thumbrun build/arm/Lab4C-Optimization.o AddressDependency @0 -w 0=@1 -w 1=@0
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Thumb.h"
+
+#define SCRATCH_WORDS       1024
+#define MAX_ARGS            16
+
+static int                  IsFloat(const char *text) ;
+static uint32_t             Value(const char *text, uint32_t scratch) ;
+static void                 Usage(void) ;
+
+int main(int argc, char **argv)
+    {
+    THUMB_CPU *cpu = ThumbCreate() ;
+    uint32_t scratch, function = 0, args[MAX_ARGS] ;
+    char *pokes[SCRATCH_WORDS] ;
+    char *name = NULL ;
+    int nargs = 0, npokes = 0, nfloats = 0, print = 0, repeat = 1 ;
+    uint64_t cycles = 0, instructions = 0 ;
+    THUMB_STATUS status = THUMB_OK ;
+    float s0 ;
+
+    cpu->limit = 10000000 ;
+    scratch = ThumbAlloc(cpu, 4*SCRATCH_WORDS) ;
+
+    for (int k = 1; k < argc; k++)
+        {
+        char *arg = argv[k] ;
+        size_t length = strlen(arg) ;
+
+        if (strcmp(arg, "-w") == 0 && k + 1 < argc) pokes[npokes++] = argv[++k] ;
+        else if (strcmp(arg, "-p") == 0 && k + 1 < argc) print = atoi(argv[++k]) ;
+        else if (strcmp(arg, "-l") == 0 && k + 1 < argc) cpu->limit = strtoull(argv[++k], NULL, 0) ;
+        else if (strcmp(arg, "-r") == 0 && k + 1 < argc) repeat = atoi(argv[++k]) ;
+        else if (name == NULL && length > 2 && strcmp(arg + length - 2, ".o") == 0)
+            {
+            if (!ThumbLoadObject(cpu, arg)) return 1 ;
+            }
+        else if (name == NULL) name = arg ;
+        else if (IsFloat(arg))
+            {
+            float value = strtof(arg, NULL) ;
+            if (nfloats < 16) memcpy(&cpu->s[nfloats++], &value, 4) ;
+            }
+        else if (nargs < MAX_ARGS) args[nargs++] = Value(arg, scratch) ;
+        }
+
+    if (name == NULL) Usage() ;
+    if (!ThumbLink(cpu)) return 1 ;
+    if ((function = ThumbSymbol(cpu, name)) == 0)
+        {
+        fprintf(stderr, "thumbrun: %s is not defined\n", name) ;
+        return 1 ;
+        }
+
+    for (int k = 0; k < npokes; k++)
+        {
+        char *equals = strchr(pokes[k], '=') ;
+        unsigned word = strtoul(pokes[k], NULL, 0) ;
+
+        if (equals == NULL || word >= SCRATCH_WORDS) Usage() ;
+        ThumbWrite32(cpu, scratch + 4*word, Value(equals + 1, scratch)) ;
+        }
+
+    for (int k = 0; k < repeat && status == THUMB_OK; k++)
+        {
+        cycles = cpu->cycles ;
+        instructions = cpu->instructions ;
+        status = ThumbCall(cpu, function, args, nargs) ;
+        }
+
+    if (status != THUMB_OK)
+        {
+        printf("%s: %s at PC=%08X (address %08X)\n", name, ThumbStatusText(status), cpu->fault_pc, cpu->fault_adrs) ;
+        if (status == THUMB_FAULT_UNRESOLVED) printf("    unresolved symbol: %s\n", cpu->hostname[cpu->fault_adrs]) ;
+        return 2 ;
+        }
+
+    printf("R0           = %u (0x%08X, %d)\n", cpu->r[0], cpu->r[0], (int32_t) cpu->r[0]) ;
+    printf("R1:R0        = %llu (0x%08X%08X)\n", ((unsigned long long) cpu->r[1] << 32) | cpu->r[0], cpu->r[1], cpu->r[0]) ;
+    memcpy(&s0, &cpu->s[0], 4) ;
+    printf("S0           = %g\n", s0) ;
+    printf("cycles       = %llu\n", (unsigned long long) (cpu->cycles - cycles)) ;
+    printf("instructions = %llu\n", (unsigned long long) (cpu->instructions - instructions)) ;
+    for (int k = 0; k < print && k < SCRATCH_WORDS; k++)
+        {
+        printf("@%-3d         = 0x%08X\n", k, ThumbRead32(cpu, scratch + 4*k)) ;
+        }
+
+    ThumbDestroy(cpu) ;
+    return 0 ;
+    }
+
+static int IsFloat(const char *text)
+    {
+    if (text[0] == '@' || strncmp(text, "0x", 2) == 0 || strncmp(text, "0X", 2) == 0) return 0 ;
+    return strpbrk(text, ".fFeE") != NULL ;
+    }
+
+static uint32_t Value(const char *text, uint32_t scratch)
+    {
+    if (text[0] == '@') return scratch + 4*strtoul(text + 1, NULL, 0) ;
+    if (text[0] == '-') return (uint32_t) strtol(text, NULL, 0) ;
+    return (uint32_t) strtoul(text, NULL, 0) ;
+    }
+
+static void Usage(void)
+    {
+    fprintf(stderr, "usage: thumbrun [-w N=V] [-p N] [-l N] [-r N] file.o... Function [arg...]\n") ;
+    exit(1) ;
+    }
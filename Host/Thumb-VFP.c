@@ -0,0 +1,365 @@
+/*
+    Thumb-2 interpreter: the single-precision FPv4-SP instructions of the Cortex-M4F
+    (ARMv7-M ARM section A6). Double-precision data processing does not exist on
+    this FPU and faults as undefined; D registers are only named by VMOV, VLDM/VSTM
+    and VPUSH/VPOP, where they alias pairs of S registers.
+
+    VADD/VMUL results reach a dependent FP instruction after cpu->timing.fp_latency
+    extra cycles. VDIV/VSQRT issue in one cycle and finish in the background, so
+    integer work placed after them is free until something reads the result.
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "Thumb-Internal.h"
+
+#define FPSCR_N             (1u << 31)
+#define FPSCR_Z             (1u << 30)
+#define FPSCR_C             (1u << 29)
+#define FPSCR_V             (1u << 28)
+
+static void                 Arithmetic(STEP *x, uint16_t hw1, uint16_t hw2) ;
+static void                 Compare(THUMB_CPU *cpu, float a, float b) ;
+static void                 Convert(STEP *x, uint16_t hw1, uint16_t hw2, unsigned sd, unsigned sm) ;
+static void                 LoadStore(STEP *x, uint16_t hw1, uint16_t hw2) ;
+static void                 Ready(STEP *x, unsigned sreg, unsigned latency) ;
+static void                 Transfer(STEP *x, uint16_t hw1, uint16_t hw2) ;
+static void                 Wait(STEP *x, unsigned sreg) ;
+
+static inline float Float(uint32_t bits)
+    {
+    float value ;
+    memcpy(&value, &bits, 4) ;
+    return value ;
+    }
+
+static inline uint32_t Bits(float value)
+    {
+    uint32_t bits ;
+    memcpy(&bits, &value, 4) ;
+    return bits ;
+    }
+
+void ExecuteVFP(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    if (BITS(hw2, 11, 9) != 5 || (hw1 & 0xF000) != 0xE000) Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+
+    if ((hw1 & 0x0F00) == 0x0E00)
+        {
+        if (BIT(hw2, 4) == 0) Arithmetic(x, hw1, hw2) ;
+        else Transfer(x, hw1, hw2) ;
+        }
+    else LoadStore(x, hw1, hw2) ;
+    }
+
+// Stall until an S register written by an earlier FP instruction is available
+static void Wait(STEP *x, unsigned sreg)
+    {
+    uint64_t now = x->cpu->cycles + x->cost ;
+    if (x->cpu->fp_ready[sreg] > now) x->cost += x->cpu->fp_ready[sreg] - now ;
+    }
+
+// The result lands latency cycles after this instruction completes
+static void Ready(STEP *x, unsigned sreg, unsigned latency)
+    {
+    x->cpu->fp_ready[sreg] = x->cpu->cycles + x->cost + 1 + latency ;
+    }
+
+static void Compare(THUMB_CPU *cpu, float a, float b)
+    {
+    uint32_t flags ;
+
+    if (isnan(a) || isnan(b)) flags = FPSCR_C | FPSCR_V ;
+    else if (a == b) flags = FPSCR_Z | FPSCR_C ;
+    else if (a < b) flags = FPSCR_N ;
+    else flags = FPSCR_C ;
+    cpu->fpscr = (cpu->fpscr & 0x0FFFFFFF) | flags ;
+    }
+
+static void Arithmetic(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t *s = cpu->s ;
+    unsigned sd = (BITS(hw2, 15, 12) << 1) | BIT(hw1, 6) ;
+    unsigned sn = (BITS(hw1, 3, 0) << 1) | BIT(hw2, 7) ;
+    unsigned sm = (BITS(hw2, 3, 0) << 1) | BIT(hw2, 5) ;
+    unsigned opc1 = BITS(hw1, 7, 4) & 0xB ;
+    int negate = BIT(hw2, 6) ;
+    volatile float product ;
+    float a, b, d ;
+
+    if (BIT(hw2, 8)) Fault(x, THUMB_FAULT_UNDEFINED, hw2) ;
+
+    if (opc1 == 0xB)
+        {
+        // VMOV (immediate), VMOV/VABS/VNEG/VSQRT (register), VCMP, VCVT
+        unsigned opc2 = BITS(hw1, 3, 0) ;
+
+        if (!BIT(hw2, 6))
+            {
+            uint32_t imm8 = (opc2 << 4) | (hw2 & 0xF) ;
+            uint32_t exponent = BIT(imm8, 6) ? 0x7C | BITS(imm8, 5, 4) : 0x80 | BITS(imm8, 5, 4) ;
+            s[sd] = (BIT(imm8, 7) << 31) | (exponent << 23) | ((imm8 & 0xF) << 19) ;
+            Ready(x, sd, 0) ;
+            return ;
+            }
+
+        switch (opc2)
+            {
+            case 0x0:
+                Wait(x, sm) ;
+                s[sd] = BIT(hw2, 7) ? s[sm] & 0x7FFFFFFF : s[sm] ;
+                Ready(x, sd, 0) ;
+                return ;
+            case 0x1:
+                Wait(x, sm) ;
+                if (BIT(hw2, 7))
+                    {
+                    // VSQRT runs beside later instructions, like VDIV
+                    uint64_t now = cpu->cycles + x->cost ;
+                    if (cpu->fp_busy > now) x->cost += cpu->fp_busy - now ;
+                    s[sd] = Bits(sqrtf(Float(s[sm]))) ;
+                    cpu->fp_busy = cpu->cycles + x->cost + cpu->timing.fp_div ;
+                    cpu->fp_ready[sd] = cpu->fp_busy ;
+                    }
+                else
+                    {
+                    s[sd] = s[sm] ^ 0x80000000 ;
+                    Ready(x, sd, 0) ;
+                    }
+                return ;
+            case 0x4:
+            case 0x5:
+                Wait(x, sd) ;
+                if (opc2 == 0x4) Wait(x, sm) ;
+                Compare(cpu, Float(s[sd]), opc2 == 0x4 ? Float(s[sm]) : 0.0f) ;
+                return ;
+            default:
+                Convert(x, hw1, hw2, sd, sm) ;
+                return ;
+            }
+        }
+
+    Wait(x, sn) ;
+    Wait(x, sm) ;
+    a = Float(s[sn]) ;
+    b = Float(s[sm]) ;
+
+    switch (opc1)
+        {
+        case 0x0:
+        case 0x1:
+            // VMLA, VMLS, VNMLA, VNMLS: rounded product then rounded sum
+            Wait(x, sd) ;
+            product = a * b ;
+            if (negate) product = -product ;
+            d = Float(s[sd]) ;
+            if (opc1 == 0x1) d = -d ;
+            s[sd] = Bits(d + product) ;
+            x->cost += cpu->timing.fp_mla - 1 ;
+            Ready(x, sd, 0) ;
+            return ;
+
+        case 0x2:
+            d = a * b ;
+            s[sd] = Bits(negate ? -d : d) ;
+            break ;
+
+        case 0x3:
+            s[sd] = Bits(negate ? a - b : a + b) ;
+            break ;
+
+        case 0x8:
+            {
+            // VDIV
+            uint64_t now = cpu->cycles + x->cost ;
+            if (cpu->fp_busy > now) x->cost += cpu->fp_busy - now ;
+            s[sd] = Bits(a / b) ;
+            cpu->fp_busy = cpu->cycles + x->cost + cpu->timing.fp_div ;
+            cpu->fp_ready[sd] = cpu->fp_busy ;
+            return ;
+            }
+
+        case 0x9:
+        case 0xA:
+            // VFNMA, VFNMS, VFMA, VFMS: fused
+            Wait(x, sd) ;
+            d = Float(s[sd]) ;
+            if (opc1 == 0x9) d = -d ;
+            s[sd] = Bits(fmaf(negate ? -a : a, b, d)) ;
+            x->cost += cpu->timing.fp_mla - 1 ;
+            Ready(x, sd, 0) ;
+            return ;
+
+        default:
+            Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+        }
+
+    Ready(x, sd, cpu->timing.fp_latency) ;
+    }
+
+static void Convert(STEP *x, uint16_t hw1, uint16_t hw2, unsigned sd, unsigned sm)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t *s = cpu->s ;
+    unsigned opc2 = BITS(hw1, 3, 0) ;
+
+    if (opc2 == 0x8)
+        {
+        // VCVT.F32.S32/U32
+        Wait(x, sm) ;
+        s[sd] = Bits(BIT(hw2, 7) ? (float) (int32_t) s[sm] : (float) s[sm]) ;
+        }
+    else if (opc2 == 0xC || opc2 == 0xD)
+        {
+        // VCVT{R}.S32/U32.F32: round toward zero unless R
+        float value ;
+        double rounded ;
+
+        Wait(x, sm) ;
+        value = Float(s[sm]) ;
+        rounded = BIT(hw2, 7) ? trunc(value) : nearbyint(value) ;
+        if (isnan(value)) s[sd] = 0 ;
+        else if (opc2 == 0xD) s[sd] = rounded >= 2147483647.0 ? 0x7FFFFFFF : rounded <= -2147483648.0 ? 0x80000000 : (uint32_t) (int32_t) rounded ;
+        else s[sd] = rounded >= 4294967295.0 ? 0xFFFFFFFF : rounded <= 0 ? 0 : (uint32_t) rounded ;
+        }
+    else if ((opc2 & 0xA) == 0xA)
+        {
+        // VCVT between F32 and 16/32-bit fixed point; Sd is both source and result
+        int to_fixed = BIT(opc2, 2), is_unsigned = BIT(opc2, 0) ;
+        int size = BIT(hw2, 7) ? 32 : 16 ;
+        int frac = size - (int) (((hw2 & 0xF) << 1) | BIT(hw2, 5)) ;
+        double scale = ldexp(1.0, frac) ;
+
+        Wait(x, sd) ;
+        if (to_fixed)
+            {
+            double v = trunc(Float(s[sd]) * scale) ;
+            double max = is_unsigned ? ldexp(1.0, size) - 1 : ldexp(1.0, size - 1) - 1 ;
+            double min = is_unsigned ? 0 : -ldexp(1.0, size - 1) ;
+
+            if (isnan(v)) v = 0 ;
+            if (v > max) v = max ;
+            if (v < min) v = min ;
+            s[sd] = is_unsigned ? (uint32_t) v : (uint32_t) (int32_t) v ;
+            if (size == 16) s[sd] = is_unsigned ? s[sd] & 0xFFFF : (uint32_t) (int16_t) s[sd] ;
+            }
+        else
+            {
+            int64_t raw = size == 16 ? (is_unsigned ? (int64_t) (uint16_t) s[sd] : (int64_t) (int16_t) s[sd])
+                                     : (is_unsigned ? (int64_t) s[sd] : (int64_t) (int32_t) s[sd]) ;
+            s[sd] = Bits((float) (raw / scale)) ;
+            }
+        }
+    else Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+
+    Ready(x, sd, 0) ;
+    }
+
+// VMOV between core and S registers, VMRS, VMSR
+static void Transfer(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    unsigned rt = BITS(hw2, 15, 12) ;
+    unsigned sn = (BITS(hw1, 3, 0) << 1) | BIT(hw2, 7) ;
+
+    switch (BITS(hw1, 7, 4))
+        {
+        case 0x0:
+            cpu->s[sn] = cpu->r[rt] ;
+            Ready(x, sn, 0) ;
+            break ;
+        case 0x1:
+            Wait(x, sn) ;
+            cpu->r[rt] = cpu->s[sn] ;
+            break ;
+        case 0xE:
+            cpu->fpscr = cpu->r[rt] ;
+            break ;
+        case 0xF:
+            if (rt == 15) cpu->apsr = (cpu->apsr & 0x0FFFFFFF) | (cpu->fpscr & 0xF0000000) ;
+            else cpu->r[rt] = cpu->fpscr ;
+            break ;
+        default:
+            Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+        }
+    }
+
+// VLDR, VSTR, VLDM, VSTM, VPUSH, VPOP and VMOV of two core registers
+static void LoadStore(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t *r = cpu->r ;
+    unsigned rn = BITS(hw1, 3, 0) ;
+    int p = BIT(hw1, 8), u = BIT(hw1, 7), w = BIT(hw1, 5), load = BIT(hw1, 4) ;
+    int dbl = BIT(hw2, 8) ;
+    unsigned first = dbl ? (BIT(hw1, 6) << 5) | (BITS(hw2, 15, 12) << 1) : (BITS(hw2, 15, 12) << 1) | BIT(hw1, 6) ;
+    unsigned count = hw2 & 0xFF ;
+    uint32_t base = rn == 15 ? (x->pc + 4) & ~3u : r[rn] ;
+    uint32_t adrs ;
+
+    if ((hw1 & 0x0FE0) == 0x0C40)
+        {
+        // VMOV Rt, Rt2 <-> Sm, Sm+1 (or Dm)
+        unsigned rt2 = rn, rt = BITS(hw2, 15, 12) ;
+        unsigned sm = dbl ? (BIT(hw2, 5) << 5) | ((hw2 & 0xF) << 1) : ((hw2 & 0xF) << 1) | BIT(hw2, 5) ;
+
+        if (sm == 31) Fault(x, THUMB_FAULT_UNDEFINED, hw2) ;
+        if (load)
+            {
+            Wait(x, sm) ;
+            Wait(x, sm + 1) ;
+            r[rt] = cpu->s[sm] ;
+            r[rt2] = cpu->s[sm + 1] ;
+            }
+        else
+            {
+            cpu->s[sm] = r[rt] ;
+            cpu->s[sm + 1] = r[rt2] ;
+            Ready(x, sm, 0) ;
+            Ready(x, sm + 1, 0) ;
+            }
+        x->cost += 1 ;
+        return ;
+        }
+
+    if (p && !w)
+        {
+        // VLDR, VSTR
+        uint32_t offset = 4*(hw2 & 0xFF) ;
+
+        adrs = u ? base + offset : base - offset ;
+        count = dbl ? 2 : 1 ;
+        }
+    else if (p == u)
+        {
+        Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+        return ;
+        }
+    else
+        {
+        // VLDMIA/VSTMIA with optional writeback, VLDMDB!/VSTMDB! (VPUSH/VPOP)
+        if (dbl) count &= ~1u ;
+        adrs = p ? base - 4*count : base ;
+        if (w) r[rn] = p ? adrs : base + 4*count ;
+        }
+
+    if (adrs & 3) Fault(x, THUMB_FAULT_ALIGN, adrs) ;
+    if (first + count > 32) Fault(x, THUMB_FAULT_UNDEFINED, hw2) ;
+
+    for (unsigned k = 0; k < count; k++, adrs += 4)
+        {
+        if (load)
+            {
+            cpu->s[first + k] = Load(x, adrs, 4) ;
+            Ready(x, first + k, 0) ;
+            }
+        else
+            {
+            Wait(x, first + k) ;
+            Store(x, adrs, 4, cpu->s[first + k]) ;
+            }
+        }
+    x->cost += count ;
+    }
@@ -0,0 +1,729 @@
+/*
+    Thumb-2 interpreter: 32-bit integer instructions (ARMv7-M ARM section A5.3).
+    Coprocessor space is passed on to Thumb-VFP.c.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "Thumb-Internal.h"
+
+static void                 BranchesAndControl(STEP *x, uint16_t hw1, uint16_t hw2) ;
+static uint32_t             DataProcessing(STEP *x, unsigned op, int setflags, uint32_t n, uint32_t m, int carry, int *write) ;
+static void                 DataRegister(STEP *x, uint16_t hw1, uint16_t hw2) ;
+static void                 DualExclusiveTable(STEP *x, uint16_t hw1, uint16_t hw2) ;
+static uint32_t             ExpandImmediate(uint32_t imm12, int carry_in, int *carry_out) ;
+static void                 LoadStoreMultiple(STEP *x, uint16_t hw1, uint16_t hw2) ;
+static void                 LoadStoreSingle(STEP *x, uint16_t hw1, uint16_t hw2) ;
+static void                 LongMultiply(STEP *x, uint16_t hw1, uint16_t hw2) ;
+static void                 Multiply(STEP *x, uint16_t hw1, uint16_t hw2) ;
+static uint32_t             Parallel(THUMB_CPU *cpu, unsigned op, unsigned kind, uint32_t n, uint32_t m) ;
+static void                 PlainImmediate(STEP *x, uint16_t hw1, uint16_t hw2) ;
+
+void ExecuteWide(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t *r = cpu->r ;
+    int carry = (cpu->apsr & APSR_C) != 0 ;
+    unsigned rn = BITS(hw1, 3, 0), rd = BITS(hw2, 11, 8) ;
+    int write ;
+    uint32_t result ;
+
+    if ((hw1 & 0xEC00) == 0xEC00)
+        {
+        ExecuteVFP(x, hw1, hw2) ;
+        return ;
+        }
+
+    switch (hw1 >> 11)
+        {
+        case 0x1D:
+            if ((hw1 & 0x0640) == 0x0000) LoadStoreMultiple(x, hw1, hw2) ;
+            else if ((hw1 & 0x0640) == 0x0040) DualExclusiveTable(x, hw1, hw2) ;
+            else if ((hw1 & 0x0600) == 0x0200)
+                {
+                // Data processing (shifted register)
+                unsigned op = BITS(hw1, 8, 5) ;
+                unsigned amount = (BITS(hw2, 14, 12) << 2) | BITS(hw2, 7, 6) ;
+                int type = BITS(hw2, 5, 4) ;
+                uint32_t m ;
+
+                if (type == SHIFT_ROR && amount == 0) type = SHIFT_RRX ;
+                else if (amount == 0 && type != SHIFT_LSL) amount = 32 ;
+                m = Shift(r[BITS(hw2, 3, 0)], type, amount, carry, &carry) ;
+
+                if (op == 6)
+                    {
+                    // PKHBT, PKHTB
+                    if (BIT(hw2, 5)) r[rd] = (r[rn] & 0xFFFF0000) | (m & 0xFFFF) ;
+                    else r[rd] = (r[rn] & 0xFFFF) | (m & 0xFFFF0000) ;
+                    break ;
+                    }
+                result = DataProcessing(x, op, BIT(hw1, 4), rn == 15 ? 0 : r[rn], m, carry, &write) ;
+                if (write && rd != 15) r[rd] = result ;
+                }
+            else Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+            break ;
+
+        case 0x1E:
+            if (BIT(hw2, 15)) BranchesAndControl(x, hw1, hw2) ;
+            else if (BIT(hw1, 9)) PlainImmediate(x, hw1, hw2) ;
+            else
+                {
+                // Data processing (modified immediate)
+                uint32_t imm12 = (BIT(hw1, 10) << 11) | (BITS(hw2, 14, 12) << 8) | (hw2 & 0xFF) ;
+                uint32_t imm = ExpandImmediate(imm12, carry, &carry) ;
+                unsigned op = BITS(hw1, 8, 5) ;
+
+                result = DataProcessing(x, op, BIT(hw1, 4), rn == 15 ? 0 : r[rn], imm, carry, &write) ;
+                if (write && rd != 15) r[rd] = result ;
+                }
+            break ;
+
+        case 0x1F:
+            if ((hw1 & 0x0600) == 0x0000) LoadStoreSingle(x, hw1, hw2) ;
+            else if ((hw1 & 0x0700) == 0x0200) DataRegister(x, hw1, hw2) ;
+            else if ((hw1 & 0x0780) == 0x0300) Multiply(x, hw1, hw2) ;
+            else if ((hw1 & 0x0780) == 0x0380) LongMultiply(x, hw1, hw2) ;
+            else Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+            break ;
+        }
+    }
+
+int32_t SignedSaturate(int64_t value, unsigned bits, int *saturated)
+    {
+    int64_t max = (1LL << (bits - 1)) - 1, min = -(1LL << (bits - 1)) ;
+
+    if (value > max) { *saturated = 1 ; return max ; }
+    if (value < min) { *saturated = 1 ; return min ; }
+    return value ;
+    }
+
+uint32_t UnsignedSaturate(int64_t value, unsigned bits, int *saturated)
+    {
+    int64_t max = (1LL << bits) - 1 ;
+
+    if (value > max) { *saturated = 1 ; return max ; }
+    if (value < 0)   { *saturated = 1 ; return 0 ; }
+    return value ;
+    }
+
+static uint32_t ExpandImmediate(uint32_t imm12, int carry_in, int *carry_out)
+    {
+    uint32_t imm8 = imm12 & 0xFF, value ;
+
+    *carry_out = carry_in ;
+    if (BITS(imm12, 11, 10) == 0)
+        {
+        switch (BITS(imm12, 9, 8))
+            {
+            case 0:  return imm8 ;
+            case 1:  return imm8 * 0x00010001 ;
+            case 2:  return imm8 * 0x01000100 ;
+            default: return imm8 * 0x01010101 ;
+            }
+        }
+
+    value = Shift(0x80 | (imm12 & 0x7F), SHIFT_ROR, BITS(imm12, 11, 7), carry_in, carry_out) ;
+    return value ;
+    }
+
+// AND, BIC, ORR, ORN, EOR, ADD, ADC, SBC, SUB, RSB and their TST/TEQ/CMN/CMP and
+// MOV/MVN aliases (the caller passes n = 0 when Rn is PC; Rd = PC means no write)
+static uint32_t DataProcessing(STEP *x, unsigned op, int setflags, uint32_t n, uint32_t m, int carry, int *write)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    int overflow, arith = 1 ;
+    uint32_t result ;
+
+    *write = 1 ;
+    switch (op)
+        {
+        case 0x0: result = n & m ; arith = 0 ; break ;
+        case 0x1: result = n & ~m ; arith = 0 ; break ;
+        case 0x2: result = n | m ; arith = 0 ; break ;
+        case 0x3: result = n | ~m ; arith = 0 ; break ;
+        case 0x4: result = n ^ m ; arith = 0 ; break ;
+        case 0x8: result = AddWithCarry(n, m, 0, &carry, &overflow) ; break ;
+        case 0xA: result = AddWithCarry(n, m, (cpu->apsr & APSR_C) != 0, &carry, &overflow) ; break ;
+        case 0xB: result = AddWithCarry(n, ~m, (cpu->apsr & APSR_C) != 0, &carry, &overflow) ; break ;
+        case 0xD: result = AddWithCarry(n, ~m, 1, &carry, &overflow) ; break ;
+        case 0xE: result = AddWithCarry(~n, m, 1, &carry, &overflow) ; break ;
+        default:
+            Fault(x, THUMB_FAULT_UNDEFINED, op) ;
+            return 0 ;
+        }
+
+    if (setflags)
+        {
+        if (arith) SetNZCV(cpu, result, carry, overflow) ;
+        else SetNZC(cpu, result, carry) ;
+        }
+    return result ;
+    }
+
+static void PlainImmediate(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    uint32_t *r = x->cpu->r ;
+    unsigned rn = BITS(hw1, 3, 0), rd = BITS(hw2, 11, 8) ;
+    unsigned imm12 = (BIT(hw1, 10) << 11) | (BITS(hw2, 14, 12) << 8) | (hw2 & 0xFF) ;
+    unsigned imm16 = (rn << 12) | imm12 ;
+    unsigned lsb = (BITS(hw2, 14, 12) << 2) | BITS(hw2, 7, 6) ;
+    unsigned field = hw2 & 0x1F ;
+    uint32_t n = rn == 15 ? (x->pc + 4) & ~3u : r[rn] ;
+    int saturated = 0 ;
+
+    switch (BITS(hw1, 8, 4))
+        {
+        case 0x00: r[rd] = n + imm12 ; break ;
+        case 0x0A: r[rd] = n - imm12 ; break ;
+        case 0x04: r[rd] = imm16 ; break ;
+        case 0x0C: r[rd] = (r[rd] & 0xFFFF) | (imm16 << 16) ; break ;
+
+        case 0x10:
+        case 0x12:
+        case 0x18:
+        case 0x1A:
+            {
+            // SSAT, USAT and their 16-bit forms
+            int sat_unsigned = BIT(hw1, 7) ;
+            unsigned bits = sat_unsigned ? field : field + 1 ;
+
+            if (BIT(hw1, 5) && lsb == 0)
+                {
+                int32_t lo = (int16_t) n, hi = (int16_t) (n >> 16) ;
+                bits = sat_unsigned ? (field & 0xF) : (field & 0xF) + 1 ;
+                if (sat_unsigned) r[rd] = UnsignedSaturate(lo, bits, &saturated) | (UnsignedSaturate(hi, bits, &saturated) << 16) ;
+                else r[rd] = (SignedSaturate(lo, bits, &saturated) & 0xFFFF) | ((uint32_t) SignedSaturate(hi, bits, &saturated) << 16) ;
+                }
+            else
+                {
+                int32_t value = (int32_t) Shift(n, BIT(hw1, 5) ? SHIFT_ASR : SHIFT_LSL, lsb, 0, NULL) ;
+                r[rd] = sat_unsigned ? UnsignedSaturate(value, bits, &saturated) : (uint32_t) SignedSaturate(value, bits, &saturated) ;
+                }
+            if (saturated) x->cpu->apsr |= APSR_Q ;
+            break ;
+            }
+
+        case 0x14:
+        case 0x1C:
+            {
+            // SBFX, UBFX
+            uint32_t value = (n >> lsb) & (field == 31 ? ~0u : (2u << field) - 1) ;
+            if (BIT(hw1, 7) == 0 && field < 31 && BIT(value, field)) value |= ~0u << (field + 1) ;
+            r[rd] = value ;
+            break ;
+            }
+
+        case 0x16:
+            {
+            // BFI, BFC (Rn = PC)
+            uint32_t mask ;
+
+            if (field < lsb) Fault(x, THUMB_FAULT_UNDEFINED, hw2) ;
+            mask = (field - lsb == 31 ? ~0u : (2u << (field - lsb)) - 1) << lsb ;
+            r[rd] = (r[rd] & ~mask) | (rn == 15 ? 0 : (r[rn] << lsb) & mask) ;
+            break ;
+            }
+
+        default:
+            Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+        }
+    }
+
+static void BranchesAndControl(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t s = BIT(hw1, 10), j1 = BIT(hw2, 13), j2 = BIT(hw2, 11) ;
+    uint32_t offset ;
+
+    switch (BITS(hw2, 14, 12))
+        {
+        case 0:
+        case 2:
+            if (BITS(hw1, 9, 7) != 7)
+                {
+                // B<cond>.W
+                offset = (s << 20) | (j2 << 19) | (j1 << 18) | (BITS(hw1, 5, 0) << 12) | ((hw2 & 0x7FF) << 1) ;
+                offset = (uint32_t) ((int32_t) (offset << 11) >> 11) ;
+                if (ConditionPassed(cpu, BITS(hw1, 9, 6))) BranchTo(x, x->pc + 4 + offset) ;
+                }
+            else if ((hw1 & 0x07E0) == 0x0380)
+                {
+                // MSR APSR_nzcvq/APSR_g
+                uint32_t mask = (BIT(hw2, 11) ? 0xF8000000 : 0) | (BIT(hw2, 10) ? 0x000F0000 : 0) ;
+                cpu->apsr = (cpu->apsr & ~mask) | (cpu->r[BITS(hw1, 3, 0)] & mask) ;
+                }
+            else if ((hw1 & 0x07E0) == 0x03E0)
+                {
+                // MRS
+                cpu->r[BITS(hw2, 11, 8)] = (hw2 & 0xFF) == 0 ? cpu->apsr : 0 ;
+                }
+            // Hints and barriers (NOP.W, WFI, DSB, DMB, ISB) do nothing here
+            break ;
+
+        case 1:
+        case 3:
+        case 5:
+        case 7:
+            {
+            // B.W, BL
+            uint32_t i1 = !(j1 ^ s), i2 = !(j2 ^ s) ;
+
+            offset = (s << 24) | (i1 << 23) | (i2 << 22) | (BITS(hw1, 9, 0) << 12) | ((hw2 & 0x7FF) << 1) ;
+            offset = (uint32_t) ((int32_t) (offset << 7) >> 7) ;
+            if (BIT(hw2, 14)) cpu->r[14] = x->next | 1 ;
+            BranchTo(x, x->pc + 4 + offset) ;
+            break ;
+            }
+
+        default:
+            // BLX to ARM state
+            Fault(x, THUMB_FAULT_UNDEFINED, hw2) ;
+        }
+    }
+
+static void LoadStoreMultiple(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    unsigned rn = BITS(hw1, 3, 0) ;
+    int load = BIT(hw1, 4), writeback = BIT(hw1, 5) ;
+    int count = __builtin_popcount(hw2) ;
+    uint32_t start, adrs ;
+    uint32_t target = 0 ;
+
+    if (BITS(hw1, 8, 7) == 1) start = cpu->r[rn] ;
+    else if (BITS(hw1, 8, 7) == 2) start = cpu->r[rn] - 4*count ;
+    else
+        {
+        Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+        return ;
+        }
+    if (start & 3) Fault(x, THUMB_FAULT_ALIGN, start) ;
+
+    adrs = start ;
+    for (int k = 0; k < 16; k++)
+        {
+        if (!BIT(hw2, k)) continue ;
+        if (!load) Store(x, adrs, 4, cpu->r[k]) ;
+        else if (k == 15) target = Load(x, adrs, 4) ;
+        else cpu->r[k] = Load(x, adrs, 4) ;
+        adrs += 4 ;
+        }
+
+    if (writeback && !(load && BIT(hw2, rn))) cpu->r[rn] = BITS(hw1, 8, 7) == 1 ? adrs : start ;
+    x->cost += count ;
+    if (load && BIT(hw2, 15)) InterworkTo(x, target) ;
+    }
+
+static void DualExclusiveTable(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t *r = cpu->r ;
+    unsigned rn = BITS(hw1, 3, 0), rt = BITS(hw2, 15, 12), rt2 = BITS(hw2, 11, 8) ;
+    int p = BIT(hw1, 8), u = BIT(hw1, 7), w = BIT(hw1, 5), load = BIT(hw1, 4) ;
+    uint32_t base = rn == 15 ? (x->pc + 4) & ~3u : r[rn] ;
+    uint32_t adrs ;
+
+    if (p || w)
+        {
+        // LDRD, STRD
+        uint32_t offset = 4*(hw2 & 0xFF) ;
+        uint32_t target = u ? base + offset : base - offset ;
+
+        adrs = p ? target : base ;
+        if (adrs & 3) Fault(x, THUMB_FAULT_ALIGN, adrs) ;
+        if (load)
+            {
+            r[rt] = Load(x, adrs, 4) ;
+            r[rt2] = Load(x, adrs + 4, 4) ;
+            }
+        else
+            {
+            Store(x, adrs, 4, r[rt]) ;
+            Store(x, adrs + 4, 4, r[rt2]) ;
+            }
+        if (w) r[rn] = target ;
+        x->cost += 2 ;
+        return ;
+        }
+
+    if (!u)
+        {
+        // LDREX, STREX: there is no other bus master, so the store always succeeds
+        adrs = base + 4*(hw2 & 0xFF) ;
+        if (adrs & 3) Fault(x, THUMB_FAULT_ALIGN, adrs) ;
+        if (load) r[rt] = Load(x, adrs, 4) ;
+        else
+            {
+            Store(x, adrs, 4, r[rt]) ;
+            r[rt2] = 0 ;
+            }
+        x->cost += 1 ;
+        return ;
+        }
+
+    switch (BITS(hw2, 7, 4))
+        {
+        case 0x0:
+        case 0x1:
+            {
+            // TBB, TBH
+            uint32_t m = r[hw2 & 0xF], entry ;
+
+            if (!load) Fault(x, THUMB_FAULT_UNDEFINED, hw2) ;
+            if (rn == 15) base = x->pc + 4 ;
+            entry = BIT(hw2, 4) ? Load(x, base + 2*m, 2) : Load(x, base + m, 1) ;
+            x->cost += 1 ;
+            BranchTo(x, x->pc + 4 + 2*entry) ;
+            break ;
+            }
+
+        case 0x4:
+        case 0x5:
+            {
+            // LDREXB/H, STREXB/H
+            int size = BIT(hw2, 4) ? 2 : 1 ;
+
+            if (load) r[rt] = Load(x, base, size) ;
+            else
+                {
+                Store(x, base, size, r[rt]) ;
+                r[hw2 & 0xF] = 0 ;
+                }
+            x->cost += 1 ;
+            break ;
+            }
+
+        default:
+            Fault(x, THUMB_FAULT_UNDEFINED, hw2) ;
+        }
+    }
+
+static void LoadStoreSingle(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t *r = cpu->r ;
+    unsigned rn = BITS(hw1, 3, 0), rt = BITS(hw2, 15, 12) ;
+    int load = BIT(hw1, 4), is_signed = BIT(hw1, 8) ;
+    int size = 1 << BITS(hw1, 6, 5) ;
+    uint32_t base_regs = 1u << rn ;
+    uint32_t adrs, value ;
+
+    if (size == 8 || (!load && is_signed)) Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+
+    if (rn == 15)
+        {
+        // Literal: the U bit selects the direction
+        uint32_t offset = hw2 & 0xFFF ;
+        adrs = BIT(hw1, 7) ? ((x->pc + 4) & ~3u) + offset : ((x->pc + 4) & ~3u) - offset ;
+        base_regs = 0 ;
+        }
+    else if (BIT(hw1, 7)) adrs = r[rn] + (hw2 & 0xFFF) ;
+    else if (BIT(hw2, 11))
+        {
+        // 8-bit immediate with pre/post indexing and writeback
+        uint32_t offset = hw2 & 0xFF ;
+        uint32_t target = BIT(hw2, 9) ? r[rn] + offset : r[rn] - offset ;
+
+        adrs = BIT(hw2, 10) ? target : r[rn] ;
+        if (BIT(hw2, 8)) r[rn] = target ;
+        }
+    else if (BITS(hw2, 11, 6) == 0)
+        {
+        adrs = r[rn] + (r[hw2 & 0xF] << BITS(hw2, 5, 4)) ;
+        base_regs |= 1u << (hw2 & 0xF) ;
+        }
+    else
+        {
+        Fault(x, THUMB_FAULT_UNDEFINED, hw2) ;
+        return ;
+        }
+
+    if (!load)
+        {
+        Store(x, adrs, size, r[rt]) ;
+        ChargeSingle(x, adrs, size, base_regs, 0) ;
+        return ;
+        }
+
+    // PLD, PLI: byte/halfword loads to PC are hints
+    if (rt == 15 && size < 4) return ;
+
+    value = Load(x, adrs, size) ;
+    if (is_signed) value = size == 1 ? (uint32_t) (int8_t) value : (uint32_t) (int16_t) value ;
+    ChargeSingle(x, adrs, size, base_regs, rt == 15 ? 0 : 1u << rt) ;
+    if (rt == 15)
+        {
+        x->ls = 0 ;
+        InterworkTo(x, value) ;
+        }
+    else r[rt] = value ;
+    }
+
+static void DataRegister(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t *r = cpu->r ;
+    unsigned rn = BITS(hw1, 3, 0), rd = BITS(hw2, 11, 8), rm = BITS(hw2, 3, 0) ;
+    unsigned op1 = BITS(hw1, 7, 4), op2 = BITS(hw2, 7, 4) ;
+    uint32_t n = r[rn], m = r[rm], result ;
+    int carry = (cpu->apsr & APSR_C) != 0, saturated = 0 ;
+
+    if (op1 < 8 && op2 == 0)
+        {
+        // LSL, LSR, ASR, ROR (register)
+        result = Shift(n, BITS(hw1, 6, 5), m & 0xFF, carry, &carry) ;
+        r[rd] = result ;
+        if (BIT(hw1, 4)) SetNZC(cpu, result, carry) ;
+        return ;
+        }
+
+    if (op1 < 8 && (op2 & 8))
+        {
+        // Sign/zero extend with optional add; Rn = PC means no add
+        uint32_t v = Shift(m, SHIFT_ROR, 8*BITS(hw2, 5, 4), 0, NULL) ;
+        uint32_t add = rn == 15 ? 0 : n ;
+
+        switch (op1)
+            {
+            case 0: r[rd] = add + (uint32_t) (int16_t) v ; break ;
+            case 1: r[rd] = add + (uint16_t) v ; break ;
+            case 2: r[rd] = (((add >> 16) + (int8_t) (v >> 16)) << 16) | ((add + (int8_t) v) & 0xFFFF) ; break ;
+            case 3: r[rd] = (((add >> 16) + ((v >> 16) & 0xFF)) << 16) | ((add + (v & 0xFF)) & 0xFFFF) ; break ;
+            case 4: r[rd] = add + (uint32_t) (int8_t) v ; break ;
+            case 5: r[rd] = add + (uint8_t) v ; break ;
+            default: Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+            }
+        return ;
+        }
+
+    if (op1 >= 8 && op2 < 8)
+        {
+        r[rd] = Parallel(cpu, BITS(hw1, 6, 4), op2, n, m) ;
+        return ;
+        }
+
+    if ((op1 & 0xC) == 8 && (op2 & 0xC) == 8)
+        {
+        switch (((op1 & 3) << 2) | (op2 & 3))
+            {
+            case 0x0: r[rd] = SignedSaturate((int64_t) (int32_t) m + (int32_t) n, 32, &saturated) ; break ;
+            case 0x1: r[rd] = SignedSaturate((int64_t) (int32_t) m + SignedSaturate(2LL * (int32_t) n, 32, &saturated), 32, &saturated) ; break ;
+            case 0x2: r[rd] = SignedSaturate((int64_t) (int32_t) m - (int32_t) n, 32, &saturated) ; break ;
+            case 0x3: r[rd] = SignedSaturate((int64_t) (int32_t) m - SignedSaturate(2LL * (int32_t) n, 32, &saturated), 32, &saturated) ; break ;
+            case 0x4: r[rd] = __builtin_bswap32(n) ; break ;
+            case 0x5: r[rd] = ((n & 0x00FF00FF) << 8) | ((n >> 8) & 0x00FF00FF) ; break ;
+            case 0x6: r[rd] = ReverseBits(n) ; break ;
+            case 0x7: r[rd] = (uint32_t) (int16_t) ((n << 8) | ((n >> 8) & 0xFF)) ; break ;
+            case 0x8:
+                {
+                // SEL
+                uint32_t ge = BITS(cpu->apsr, 19, 16) ;
+                result = 0 ;
+                for (int k = 0; k < 4; k++) result |= (BIT(ge, k) ? n : m) & (0xFFu << 8*k) ;
+                r[rd] = result ;
+                break ;
+                }
+            case 0xC: r[rd] = CountLeadingZeros(n) ; break ;
+            default: Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+            }
+        if (saturated) cpu->apsr |= APSR_Q ;
+        return ;
+        }
+
+    Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+    }
+
+// SADD16, QASX, SHSAX, UADD8, UQSUB8, UHADD16, ...: op selects the lanes and the
+// operation, kind (hw2[6:4]) the signed/unsigned and modulo/saturating/halving form
+static uint32_t Parallel(THUMB_CPU *cpu, unsigned op, unsigned kind, uint32_t n, uint32_t m)
+    {
+    int is_unsigned = BIT(kind, 2), form = kind & 3 ;
+    int byte_lanes = (op == 0 || op == 4) ;
+    int bits = byte_lanes ? 8 : 16, lanes = byte_lanes ? 4 : 2 ;
+    uint32_t lane_mask = (1u << bits) - 1 ;
+    uint32_t result = 0, ge = 0 ;
+    int saturated = 0 ;
+
+    for (int k = 0; k < lanes; k++)
+        {
+        int j = k ;
+        int subtract ;
+        int64_t a, b, v ;
+
+        switch (op)
+            {
+            case 0: case 1: subtract = 0 ; break ;
+            case 4: case 5: subtract = 1 ; break ;
+            case 2: subtract = k == 0 ; j = 1 - k ; break ;     // ASX
+            case 6: subtract = k == 1 ; j = 1 - k ; break ;     // SAX
+            default: return 0 ;
+            }
+
+        a = (n >> (bits*k)) & lane_mask ;
+        b = (m >> (bits*j)) & lane_mask ;
+        if (!is_unsigned)
+            {
+            a = (a ^ (1u << (bits - 1))) - (1 << (bits - 1)) ;
+            b = (b ^ (1u << (bits - 1))) - (1 << (bits - 1)) ;
+            }
+        v = subtract ? a - b : a + b ;
+
+        if (form == 0)
+            {
+            int set = is_unsigned ? (subtract ? v >= 0 : v >= (1 << bits)) : v >= 0 ;
+            if (set) ge |= (byte_lanes ? 1u : 3u) << (k * (byte_lanes ? 1 : 2)) ;
+            }
+        else if (form == 1) v = is_unsigned ? UnsignedSaturate(v, bits, &saturated) : SignedSaturate(v, bits, &saturated) ;
+        else v >>= 1 ;
+
+        result |= ((uint32_t) v & lane_mask) << (bits*k) ;
+        }
+
+    if (form == 0) cpu->apsr = (cpu->apsr & ~(0xFu << APSR_GE_SHIFT)) | (ge << APSR_GE_SHIFT) ;
+    return result ;
+    }
+
+static void Multiply(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t *r = cpu->r ;
+    unsigned ra = BITS(hw2, 15, 12), rd = BITS(hw2, 11, 8) ;
+    uint32_t n = r[BITS(hw1, 3, 0)], m = r[BITS(hw2, 3, 0)] ;
+    int32_t acc = ra == 15 ? 0 : (int32_t) r[ra] ;
+    int64_t product ;
+    int saturated = 0 ;
+
+    if (ra != 15) x->cost += cpu->timing.mla - 1 ;
+
+    switch (BITS(hw1, 6, 4))
+        {
+        case 0:
+            if (BITS(hw2, 5, 4) == 0) r[rd] = n * m + (uint32_t) acc ;        // MUL, MLA
+            else r[rd] = (uint32_t) r[ra] - n * m ;                           // MLS
+            break ;
+
+        case 1:
+            {
+            // SMULxy, SMLAxy
+            int32_t a = (int16_t) (BIT(hw2, 5) ? n >> 16 : n) ;
+            int32_t b = (int16_t) (BIT(hw2, 4) ? m >> 16 : m) ;
+            product = (int64_t) a * b + acc ;
+            if (product != (int32_t) product) saturated = 1 ;
+            r[rd] = (uint32_t) product ;
+            break ;
+            }
+
+        case 2:
+        case 4:
+            {
+            // SMUAD, SMLAD, SMUSD, SMLSD (X swaps the halves of Rm)
+            uint32_t mm = BIT(hw2, 4) ? (m >> 16) | (m << 16) : m ;
+            int64_t lo = (int64_t) (int16_t) n * (int16_t) mm ;
+            int64_t hi = (int64_t) (int16_t) (n >> 16) * (int16_t) (mm >> 16) ;
+
+            product = (BITS(hw1, 6, 4) == 2 ? lo + hi : lo - hi) + acc ;
+            if (product != (int32_t) product) saturated = 1 ;
+            r[rd] = (uint32_t) product ;
+            break ;
+            }
+
+        case 3:
+            {
+            // SMULWy, SMLAWy
+            int32_t b = (int16_t) (BIT(hw2, 4) ? m >> 16 : m) ;
+            product = (((int64_t) (int32_t) n * b) >> 16) + acc ;
+            if (product != (int32_t) product) saturated = 1 ;
+            r[rd] = (uint32_t) product ;
+            break ;
+            }
+
+        case 5:
+        case 6:
+            {
+            // SMMUL, SMMLA, SMMLS (R rounds)
+            int64_t sum = (int64_t) (int32_t) n * (int32_t) m ;
+
+            if (BITS(hw1, 6, 4) == 6) sum = ((int64_t) acc << 32) - sum ;
+            else sum += (int64_t) acc << 32 ;
+            if (BIT(hw2, 4)) sum += 0x80000000LL ;
+            r[rd] = (uint32_t) (sum >> 32) ;
+            break ;
+            }
+
+        case 7:
+            {
+            // USAD8, USADA8
+            uint32_t sum = ra == 15 ? 0 : r[ra] ;
+            for (int k = 0; k < 32; k += 8) sum += abs((int) ((n >> k) & 0xFF) - (int) ((m >> k) & 0xFF)) ;
+            r[rd] = sum ;
+            break ;
+            }
+        }
+
+    if (saturated) cpu->apsr |= APSR_Q ;
+    }
+
+static void LongMultiply(STEP *x, uint16_t hw1, uint16_t hw2)
+    {
+    THUMB_CPU *cpu = x->cpu ;
+    uint32_t *r = cpu->r ;
+    unsigned lo = BITS(hw2, 15, 12), hi = BITS(hw2, 11, 8) ;
+    uint32_t n = r[BITS(hw1, 3, 0)], m = r[BITS(hw2, 3, 0)] ;
+    uint64_t acc = ((uint64_t) r[hi] << 32) | r[lo] ;
+    uint64_t result ;
+    unsigned op = (BITS(hw1, 6, 4) << 4) | BITS(hw2, 7, 4) ;
+
+    switch (op)
+        {
+        case 0x00: result = (uint64_t) ((int64_t) (int32_t) n * (int32_t) m) ; break ;
+        case 0x20: result = (uint64_t) n * m ; break ;
+        case 0x40: result = acc + (uint64_t) ((int64_t) (int32_t) n * (int32_t) m) ; break ;
+        case 0x60: result = acc + (uint64_t) n * m ; break ;
+        case 0x66: result = (uint64_t) n * m + r[lo] + r[hi] ; break ;
+
+        case 0x48: case 0x49: case 0x4A: case 0x4B:
+            {
+            // SMLALxy
+            int32_t a = (int16_t) (BIT(hw2, 5) ? n >> 16 : n) ;
+            int32_t b = (int16_t) (BIT(hw2, 4) ? m >> 16 : m) ;
+            result = acc + (uint64_t) (int64_t) (a * b) ;
+            break ;
+            }
+
+        case 0x4C: case 0x4D: case 0x5C: case 0x5D:
+            {
+            // SMLALD, SMLSLD
+            uint32_t mm = BIT(hw2, 4) ? (m >> 16) | (m << 16) : m ;
+            int64_t p1 = (int64_t) (int16_t) n * (int16_t) mm ;
+            int64_t p2 = (int64_t) (int16_t) (n >> 16) * (int16_t) (mm >> 16) ;
+            result = acc + (uint64_t) (op < 0x50 ? p1 + p2 : p1 - p2) ;
+            break ;
+            }
+
+        case 0x1F:
+        case 0x3F:
+            {
+            // SDIV, UDIV: early termination after a few quotient bits per cycle
+            unsigned rd = BITS(hw2, 11, 8), bits ;
+            uint32_t q ;
+
+            if (m == 0) q = 0 ;
+            else if (op == 0x1F) q = ((int32_t) n == INT32_MIN && (int32_t) m == -1) ? n : (uint32_t) ((int32_t) n / (int32_t) m) ;
+            else q = n / m ;
+            r[rd] = q ;
+
+            bits = 32 - CountLeadingZeros(op == 0x1F && (int32_t) q < 0 ? -q : q) ;
+            x->cost += cpu->timing.div_min - 1 + (bits + 3) / 4 ;
+            if (x->cost > cpu->timing.div_max - 1) x->cost = cpu->timing.div_max - 1 ;
+            return ;
+            }
+
+        default:
+            Fault(x, THUMB_FAULT_UNDEFINED, hw1) ;
+            return ;
+        }
+
+    r[lo] = (uint32_t) result ;
+    r[hi] = (uint32_t) (result >> 32) ;
+    }
@@ -0,0 +1,138 @@
+/*
+    Thumb-2 + single-precision VFP interpreter with a Cortex-M4 cycle model.
+
+    Assembled lab objects (ELF32 relocatable .o files from arm-none-eabi-as) are loaded
+    into a private 32-bit address space, linked against each other and against host
+    callbacks, and then called like C functions:
+
+        THUMB_CPU *cpu = ThumbCreate() ;
+        ThumbLoadObject(cpu, "build/arm/Lab8C-Resistors.o") ;
+        ThumbLink(cpu) ;
+        uint32_t args[] = {12345} ;
+        ThumbCall(cpu, ThumbSymbol(cpu, "Div32X10"), args, 1) ;
+        // cpu->r[0] is the result, cpu->cycles the modelled cycle count
+
+    Guest memory map:
+
+        0x08000000  loaded sections (code, literal pools, data, bss)
+        0x08F00000  host callbacks bound to undefined symbols (not memory; close
+                    enough to the code for BL to reach)
+        0x20000000  SRAM: ThumbAlloc() scratch space growing up, stack growing down
+        0xF0FFFFF0  return address given to the called function
+
+    Other ranges, such as the frame buffer at 0xD0000000, may be aliased onto host
+    memory with ThumbMap().
+*/
+
+#ifndef __THUMB_H
+#define __THUMB_H
+
+#include <stdint.h>
+
+#define THUMB_FLASH_BASE    0x08000000u
+#define THUMB_FLASH_SIZE    0x00100000u
+#define THUMB_SRAM_BASE     0x20000000u
+#define THUMB_SRAM_SIZE     0x00030000u
+#define THUMB_HOST_BASE     0x08F00000u
+#define THUMB_RETURN        0xF0FFFFF0u
+
+#define THUMB_MAX_REGIONS   8
+#define THUMB_MAX_HOSTFNS   32
+
+typedef struct THUMB_CPU    THUMB_CPU ;
+typedef void                (*THUMB_HOSTFN)(THUMB_CPU *cpu) ;
+
+typedef enum
+    {
+    THUMB_OK = 0,
+    THUMB_FAULT_MEMORY,         // access outside every mapped region
+    THUMB_FAULT_ALIGN,          // LDM/STM/LDRD/STRD/VLDR at an unaligned address
+    THUMB_FAULT_UNDEFINED,      // instruction outside the supported subset
+    THUMB_FAULT_UNRESOLVED,     // call to an undefined symbol with no host binding
+    THUMB_FAULT_LIMIT           // instruction budget exhausted (runaway loop)
+    } THUMB_STATUS ;
+
+// Cycle model parameters. Defaults follow the Cortex-M4 TRM instruction timing
+// tables assuming zero-wait-state memory; adjust them to calibrate against a board.
+typedef struct
+    {
+    unsigned                refill ;        // P: pipeline refill after a taken branch
+    unsigned                load ;          // single LDR/STR that cannot pipeline
+    unsigned                load_pipelined ;// LDR/STR after LDR/STR with no address dependency
+    unsigned                unaligned ;     // extra cycles when an access spans two words
+    unsigned                mla ;           // MLA/MLS
+    unsigned                div_min ;       // SDIV/UDIV early termination range
+    unsigned                div_max ;
+    unsigned                fp_latency ;    // stall when the next FP instruction reads a VADD/VMUL result
+    unsigned                fp_mla ;        // VMLA/VMLS/VNMLA/VNMLS
+    unsigned                fp_div ;        // VDIV/VSQRT (run in parallel with later instructions)
+    unsigned                host_call ;     // charged for a call into a host callback
+    } THUMB_TIMING ;
+
+typedef struct
+    {
+    uint32_t                base ;
+    uint32_t                size ;
+    uint8_t *               host ;
+    } THUMB_REGION ;
+
+typedef struct
+    {
+    char *                  name ;
+    uint32_t                value ;         // address (bit 0 set for Thumb functions)
+    } THUMB_SYMBOL ;
+
+struct THUMB_CPU
+    {
+    uint32_t                r[16] ;         // R0-R12, SP, LR, PC
+    uint32_t                s[32] ;         // S0-S31 as raw IEEE-754 bits
+    uint32_t                apsr ;          // N Z C V Q (31..27), GE (19..16)
+    uint32_t                fpscr ;
+    uint32_t                itstate ;
+
+    uint64_t                cycles ;        // modelled cycles since ThumbCreate/ThumbReset
+    uint64_t                instructions ;
+    uint64_t                limit ;         // max instructions per ThumbCall (0 = none)
+    THUMB_TIMING            timing ;
+
+    THUMB_STATUS            status ;
+    uint32_t                fault_pc ;
+    uint32_t                fault_adrs ;
+
+    // Private to the interpreter
+    THUMB_REGION            region[THUMB_MAX_REGIONS] ;
+    int                     regions ;
+    uint32_t                flash_used ;
+    uint32_t                sram_used ;
+    THUMB_SYMBOL *          symbol ;
+    int                     symbols ;
+    struct THUMB_OBJECT *   objects ;
+    THUMB_HOSTFN            hostfn[THUMB_MAX_HOSTFNS] ;
+    char *                  hostname[THUMB_MAX_HOSTFNS] ;
+    int                     hostfns ;
+    int                     prev_ls ;       // previous instruction was a single LDR/STR
+    uint32_t                prev_loaded ;   // register mask it loaded
+    int                     prev_narrow ;   // previous instruction was 16 bits
+    uint64_t                fp_ready[32] ;  // cycle each S register becomes available
+    uint64_t                fp_busy ;       // VDIV/VSQRT unit busy until this cycle
+    } ;
+
+THUMB_CPU *                 ThumbCreate(void) ;
+void                        ThumbDestroy(THUMB_CPU *cpu) ;
+void                        ThumbReset(THUMB_CPU *cpu) ;
+
+int                         ThumbLoadObject(THUMB_CPU *cpu, const char *path) ;
+void                        ThumbBind(THUMB_CPU *cpu, const char *name, THUMB_HOSTFN function) ;
+int                         ThumbLink(THUMB_CPU *cpu) ;
+uint32_t                    ThumbSymbol(THUMB_CPU *cpu, const char *name) ;
+
+int                         ThumbMap(THUMB_CPU *cpu, uint32_t base, uint32_t size, void *host) ;
+uint32_t                    ThumbAlloc(THUMB_CPU *cpu, uint32_t size) ;
+void *                      ThumbHost(THUMB_CPU *cpu, uint32_t adrs, uint32_t size) ;
+uint32_t                    ThumbRead32(THUMB_CPU *cpu, uint32_t adrs) ;
+void                        ThumbWrite32(THUMB_CPU *cpu, uint32_t adrs, uint32_t value) ;
+
+THUMB_STATUS                ThumbCall(THUMB_CPU *cpu, uint32_t function, const uint32_t *args, int nargs) ;
+const char *                ThumbStatusText(THUMB_STATUS status) ;
+
+#endif
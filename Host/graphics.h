@@ -0,0 +1,56 @@
+/*
+    Host stand-in for the graphics portion of the run-time library. The display is a
+    240x320 ARGB8888 frame buffer mapped at the same address as the LTDC layer on the
+    32F429IDISCOVERY board (0xD0000000), so programs that write pixels directly work.
+*/
+
+#ifndef __GRAPHICS_H
+#define __GRAPHICS_H
+
+#include <stdint.h>
+
+#define XPIXELS             240
+#define YPIXELS             320
+
+#define COLOR_BLUE          0xFF0000FF
+#define COLOR_GREEN         0xFF00FF00
+#define COLOR_RED           0xFFFF0000
+#define COLOR_CYAN          0xFF00FFFF
+#define COLOR_MAGENTA       0xFFFF00FF
+#define COLOR_YELLOW        0xFFFFFF00
+#define COLOR_LIGHTBLUE     0xFF8080FF
+#define COLOR_LIGHTGREEN    0xFF80FF80
+#define COLOR_LIGHTRED      0xFFFF8080
+#define COLOR_LIGHTCYAN     0xFF80FFFF
+#define COLOR_LIGHTMAGENTA  0xFFFF80FF
+#define COLOR_LIGHTYELLOW   0xFFFFFF80
+#define COLOR_DARKBLUE      0xFF000080
+#define COLOR_DARKGREEN     0xFF008000
+#define COLOR_DARKRED       0xFF800000
+#define COLOR_DARKCYAN      0xFF008080
+#define COLOR_DARKMAGENTA   0xFF800080
+#define COLOR_DARKYELLOW    0xFF808000
+#define COLOR_WHITE         0xFFFFFFFF
+#define COLOR_LIGHTGRAY     0xFFD3D3D3
+#define COLOR_GRAY          0xFF808080
+#define COLOR_DARKGRAY      0xFF404040
+#define COLOR_BLACK         0xFF000000
+#define COLOR_BROWN         0xFFA52A2A
+#define COLOR_ORANGE        0xFFFFA500
+
+void                        ClearDisplay(void) ;
+void                        DisplayChar(uint16_t x, uint16_t y, uint8_t c) ;
+void                        DisplayStringAt(uint16_t x, uint16_t y, uint8_t *text) ;
+void                        DrawHLine(uint16_t x, uint16_t y, uint16_t length) ;
+void                        DrawLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) ;
+void                        DrawPixel(uint16_t x, uint16_t y, uint32_t color) ;
+void                        DrawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height) ;
+void                        DrawVLine(uint16_t x, uint16_t y, uint16_t length) ;
+void                        FillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height) ;
+uint32_t                    GetBackground(void) ;
+uint32_t                    GetForeground(void) ;
+void                        SetBackground(uint32_t color) ;
+void                        SetColor(uint32_t color) ;
+void                        SetForeground(uint32_t color) ;
+
+#endif
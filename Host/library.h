@@ -0,0 +1,25 @@
+/*
+    Host stand-in for the run-time library that accompanies "ARM Assembly for Embedded
+    Applications". Only the surface used by the lab programs is provided; everything
+    runs on an ordinary Linux process with an in-memory frame buffer.
+*/
+
+#ifndef __LIBRARY_H
+#define __LIBRARY_H
+
+#include <stdint.h>
+
+#define HEADER              "COEN 20 Embedded Systems"
+
+void                        InitializeHardware(char *header, char *footer) ;
+
+uint32_t                    GetClockCycleCount(void) ;
+uint32_t                    GetRandomNumber(void) ;
+
+int                         PushButtonPressed(void) ;
+void                        WaitForPushButton(void) ;
+
+unsigned                    CountCycles(void *function, void *iparams, void *fparams, void *results) ;
+void                        CallReturnOverhead(void) ;
+
+#endif
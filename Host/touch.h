@@ -0,0 +1,16 @@
+/*
+    Host stand-in for the touch screen portion of the run-time library. Touches come
+    from the scripted input source described in Host.h.
+*/
+
+#ifndef __TOUCH_H
+#define __TOUCH_H
+
+#include <stdint.h>
+
+void                        TS_Init(void) ;
+int                         TS_Touched(void) ;
+int                         TS_GetX(void) ;
+int                         TS_GetY(void) ;
+
+#endif
@@ -14,6 +14,9 @@
 #include "library.h"
 #include "graphics.h"
 #include "touch.h"
+#include "widget.h"
+#include "events.h"
+#include "bcd.h"
 
 extern int Addition(int op1, int op2) ;
 extern int Subtraction(int op1, int op2) ;
@@ -31,6 +34,7 @@ typedef struct
     BOOL                (*func)() ;
     int                 value ;
     int                 minRadix ;
+    WIDGET              widget ;
     } BUTTON ;
 
 // Public fonts defined in run-time library
@@ -103,10 +107,8 @@ extern sFONT Font8, Font12, Font16, Font20, Font24 ;
 
 // Private functions defined in this file
 static BUTTON *         ButtonTouched(int x, int y) ;
-static void             Delay(uint32_t msec) ;
 static void             DrawButton(BUTTON *button, BUTTON_STATE state) ;
 static void             DrawCalculator(void) ;
-static uint32_t         GetTimeout(uint32_t msec) ;
 static void             InitializeTouchScreen(void) ;
 static int              Null(void) ;
 static char *           Num2Text(int op, char *text, int radix) ;
@@ -175,33 +177,40 @@ static BUTTON buttons[BUTTON_ROWS][BUTTON_COLS] =
 
 int main(void)
     {
+    BUTTON *button = NULL ;
+    BOOL divBy0 = FALSE ;
+
     InitializeHardware(HEADER, "Lab 1A: 16-bit Calculator") ;
     InitializeTouchScreen() ;
+    EventInitialize() ;
 
     DrawCalculator() ;
     DrawButton(&BUTTON_DEC, SELECTED) ;
     for (;;)
         {
-        if (TS_Touched())
-            {
-            BUTTON *button = ButtonTouched(TS_GetX(), TS_GetY() ) ;
+        BUTTON_STATE state ;
+        EVENT event ;
 
-            if (button != NULL)
-                {
-                BUTTON_STATE state ;
-                BOOL divBy0 ;
+        EventWait(&event) ;     // Sleeps until a finger comes down or lifts
 
-                if (button != &BUTTON_EQU) divBy0 = FALSE ;
-                else divBy0 = (function == Division) && !op2 ;
+        if (event.type == EVENT_TOUCH_DOWN && button == NULL)
+            {
+            button = ButtonTouched(event.x, event.y) ;
+            if (button == NULL) continue ;
 
-                state = (*button->func)(button->value) ? PRESSED : ERROR ;
-                DrawButton(button, state) ;
-                do Delay(100) ; while (TS_Touched()) ;
-                state = (button->minRadix == -radix) ? SELECTED : RELEASED ;
-                DrawButton(button, state) ;
+            if (button != &BUTTON_EQU) divBy0 = FALSE ;
+            else divBy0 = (function == Division) && !op2 ;
 
-                UpdateDisplay(divBy0) ;
-                }
+            state = (*button->func)(button->value) ? PRESSED : ERROR ;
+            DrawButton(button, state) ;
+            }
+        else if (event.type == EVENT_TOUCH_UP && button != NULL)
+            {
+            state = (button->minRadix == -radix) ? SELECTED : RELEASED ;
+            DrawButton(button, state) ;
+
+            UpdateDisplay(divBy0) ;
+            button = NULL ;
             }
         }
 
@@ -233,20 +242,12 @@ static void DrawButton(BUTTON *button, BUTTON_STATE state)
     static uint32_t fgnd[] = {BUTTON_FG_OFF, BUTTON_FG_ON, BUTTON_FG_SEL, BUTTON_FG_ERR} ;
     static uint32_t bgnd[] = {BUTTON_BG_OFF, BUTTON_BG_ON, BUTTON_BG_SEL, BUTTON_BG_ERR} ;
     static uint32_t brdr[] = {BUTTON_BD_OFF, BUTTON_BD_ON, BUTTON_BD_SEL, BUTTON_BD_ERR} ;
-    sFONT *font = (strlen(button->label) > 1) ? &BUTTON_SFNT : &BUTTON_LFNT ;
-    int x, y ;
-
-    SetColor(bgnd[state]) ;
-    FillRect(button->xmin, button->ymin, BUTTON_XSIZE, BUTTON_YSIZE) ;
-    SetColor(brdr[state]) ;
-    DrawRect(button->xmin, button->ymin, BUTTON_XSIZE, BUTTON_YSIZE) ;
-
-    SetFontSize(font) ;
-    SetForeground(fgnd[state]) ;
-    SetBackground(bgnd[state]) ;
-    x = button->xmin + (BUTTON_XSIZE - font->Width*strlen(button->label)) / 2 ;
-    y = button->ymin + (BUTTON_YSIZE - font->Height) / 2 + 1 ; 
-    DisplayStringAt(x, y, button->label) ;
+
+    // Repaints only if the state has changed since the button was last drawn
+    button->widget.foreground = fgnd[state] ;
+    button->widget.background = bgnd[state] ;
+    button->widget.border = brdr[state] ;
+    WidgetText(&button->widget, button->label) ;
     }
 
 static void DrawCalculator(void)
@@ -266,7 +267,11 @@ static void DrawCalculator(void)
         {
         for (col = 0; col < BUTTON_COLS; col++)
             {
-            DrawButton(&buttons[row][col], FALSE) ;
+            BUTTON *button = &buttons[row][col] ;
+            sFONT *font = (strlen(button->label) > 1) ? &BUTTON_SFNT : &BUTTON_LFNT ;
+
+            button->widget = (WIDGET) {button->xmin, button->ymin, BUTTON_XSIZE, BUTTON_YSIZE, WIDGET_CENTER, font} ;
+            DrawButton(button, FALSE) ;
             }
         }
     UpdateDisplay(FALSE) ;
@@ -274,36 +279,27 @@ static void DrawCalculator(void)
 
 static void UpdateDisplay(BOOL divBy0)
     {
-    static char prev1[100] = "" ;
-    static char line2[100] = "" ;
-    static sFONT *prev2 = &OP2_FONT ;
-    int y1 = DISPLAY_YPOS + 1  ;
-    int y2 = y1 + OP1_FONT.Height ;
-    sFONT *font2 = (radix == 2 && !divBy0) ? &OP1_FONT : &OP2_FONT ;
-    int x ;
-
-    SetBackground(DISPLAY_BGND) ;
-
-    SetForeground(DISPLAY_BGND) ;
-    SetFontSize(&OP1_FONT) ;
-    x = DISPLAY_XPOS + DISPLAY_XSIZE - OP1_FONT.Width*strlen(prev1) - 4 ;
-    DisplayStringAt(x, y1, prev1) ;
-    x = DISPLAY_XPOS + DISPLAY_XSIZE - OP1_FONT.Width*strlen(line1) - 4 ;
-    SetForeground(DISPLAY_FGND) ;
-    DisplayStringAt(x, y1, line1) ;
-    strcpy(prev1, line1) ;
-
-    SetForeground(DISPLAY_BGND) ;
-    SetFontSize(prev2) ;
-    x = DISPLAY_XPOS + DISPLAY_XSIZE - prev2->Width*strlen(line2) - 4 ;
-    DisplayStringAt(x, y2, line2) ;
-    if (divBy0) sprintf(line2, "Divide by 0 ") ;
+    static WIDGET top =
+        {
+        DISPLAY_XPOS + 2, DISPLAY_YPOS + 1, DISPLAY_XSIZE - 6, 0,
+        WIDGET_RIGHT, &OP1_FONT, DISPLAY_FGND, DISPLAY_BGND
+        } ;
+    static WIDGET bottom =
+        {
+        DISPLAY_XPOS + 2, 0, DISPLAY_XSIZE - 6, 0,
+        WIDGET_RIGHT, &OP2_FONT, DISPLAY_FGND, DISPLAY_BGND
+        } ;
+    char line2[100] ;
+
+    WidgetText(&top, line1) ;
+
+    bottom.ypos = top.ypos + OP1_FONT.Height ;
+
+    if (divBy0) strcpy(line2, "Divide by 0 ") ;
     else Num2Text(op2, line2, radix) ;
-    SetFontSize(font2) ;
-    x = DISPLAY_XPOS + DISPLAY_XSIZE - font2->Width*strlen(line2) - 4 ;
-    SetForeground(divBy0 ? DISPLAY_ERR : DISPLAY_FGND) ;
-    DisplayStringAt(x, y2, line2) ;
-    prev2 = font2 ;
+    bottom.font = (radix == 2 && !divBy0) ? &OP1_FONT : &OP2_FONT ;
+    bottom.foreground = divBy0 ? DISPLAY_ERR : DISPLAY_FGND ;
+    WidgetText(&bottom, line2) ;
     }
 
 static void SetFontSize(sFONT *Font)
@@ -342,19 +338,6 @@ static void InitializeTouchScreen(void)
     ClearDisplay() ;
     }
 
-static uint32_t GetTimeout(uint32_t msec)
-    {
-#   define  CPU_CLOCK_SPEED_MHZ         168
-    uint32_t cycles = 1000 * msec * CPU_CLOCK_SPEED_MHZ ;
-    return GetClockCycleCount() + cycles ;
-    }
-
-static void Delay(uint32_t msec)
-    {
-    uint32_t timeout = GetTimeout(msec) ;
-    while ((int) (timeout - GetClockCycleCount()) > 0) ;
-    }
-
 static int Null(void)
     {
     return op2 ;
@@ -413,6 +396,7 @@ static char *Num2Text(int op, char *text, int radix)
     {
     int bit, digits ;
     char *p, *sign ;
+    uint64_t bcd ;
 
     sign = "" ;
     p = text ;
@@ -428,8 +412,11 @@ static char *Num2Text(int op, char *text, int radix)
                 sign = "-" ;
                 op = -op ;
                 }
-            digits =  5 ;
-            break ;
+            // All the digits at once, most significant first
+            bcd = Bin2Bcd32(op & 0xFFFF) ;
+            strcpy(text, sign) ;
+            Bcd2Text(text + strlen(sign), (uint32_t *) &bcd, BCD32_WORDS) ;
+            return text ;
         case 16:
             digits =  4 ;
             break ;
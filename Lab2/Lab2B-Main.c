@@ -13,6 +13,10 @@
 #include "library.h"
 #include "graphics.h"
 #include "touch.h"
+#include "widget.h"
+#include "events.h"
+#include "timers.h"
+#include "tasks.h"
 
 #pragma GCC push_options
 #pragma GCC optimize ("O0")
@@ -55,6 +59,7 @@ typedef struct
     char *                  label ;
     void                    (*convert)(uint8_t, char []) ;
     BOOL                    (*verify)(uint8_t, char []) ;
+    WIDGET                  widget ;
     } VALUE ;
 
 typedef struct
@@ -104,6 +109,7 @@ typedef struct
 #define ADJUST_MARGIN       4
 #define ADJUST_SPACING      4
 #define ADJUST_SIZE         18
+#define ADJUST_REPEAT       300         // msec between steps while - or + is held
 
 #define SIGNS               "+-"
 
@@ -133,16 +139,14 @@ static ADJUST               adjust =
 static int32_t              Between(uint32_t min, uint32_t val, uint32_t max) ;
 static void                 Bits2BinaryString(uint8_t bits, char string[]) ;
 static void                 Bits2OnesCompString(uint8_t bits, char string[]) ;
-static void                 CheckAdjust(void) ;
-static void                 Delay(uint32_t msec) ;
+static void                 CheckAdjust(EVENT *event) ;
 static BOOL                 DigitsOK(char *string, char *digits) ;
 static void                 DisplayValues(uint8_t bits, DISPLAY *display) ;
-static void                 DoAdjust(ADJUST *adjust) ;
-static BOOL                 Expired(uint32_t timeout) ;
-static uint32_t             GetTimeout(uint32_t msec) ;
+static BOOL                 DoAdjust(ADJUST *adjust, int x, int y) ;
 static void                 InitializeTouchScreen(void) ;
 static void                 InitSlider(ADJUST *adjust) ;
 static void                 LEDs(int grn_on, int red_on) ;
+static void                 RepeatAdjust(void *arg) ;
 static void                 SetFontSize(sFONT *pFont) ;
 static void                 UpdateSlider(ADJUST *adjust, uint32_t x) ;
 static void                 UpdateValue(ADJUST *adjust, uint32_t x) ;
@@ -204,13 +208,18 @@ int main()
 	
     InitializeHardware(HEADER, "Lab 2B: Interpreting Binary") ;
     InitializeTouchScreen() ;
+    EventInitialize() ;
     LEDs(1, 0) ;
 
     InitSlider(&adjust) ;
 
     for (;;)
         {
-        CheckAdjust() ;
+        EVENT event ;
+
+        // Sleeps until a touch, or until a held - or + button repeats
+        if (EventPoll(&event)) CheckAdjust(&event) ;
+        else TaskIdle() ;
 
         if (adjust.bits == prev) continue ;
         prev = adjust.bits ;
@@ -256,30 +265,29 @@ static void DisplayValues(uint8_t bits, DISPLAY *display)
         value = display->values ;
         for (int which = 0; which < display->count; which++, value++)
             {
+            // The value takes whatever room the label leaves
+            int xleft = DISPLAY_XMARGIN + DISPLAY_XPADDING + font_value->Width * strlen(value->label) ;
+
             DisplayStringAt(DISPLAY_XMARGIN + DISPLAY_XPADDING, y, value->label) ;
+            value->widget = (WIDGET) {xleft, y, xright - xleft, 0, WIDGET_RIGHT, font_value, COLOR_BLACK, display->background} ;
             y += font_value->Height + DISPLAY_YSPACING ;
             }
 
         display->init = FALSE ;
         }
 
-    SetFontSize(font_value) ;
-    SetBackground(display->background) ;
-    y = display->ytop + font_value->Height + 2*DISPLAY_YPADDING + 1 ;
+    // Only the digits that differ from the previous value are repainted
     value = display->values ;
     for (int which = 0; which < display->count; which++, value++)
         {
-        static char blanks[] = "    " ;
         char string[10] ;
         BOOL valid ;
 
-        DisplayStringAt(xright - font_value->Width * strlen(blanks), y, blanks) ;
         (*value->convert)(bits, string) ;
         valid = (*value->verify)(bits, string) ;
         if (!valid) LEDs(0, 1) ;
-        SetForeground(valid ? COLOR_BLACK : COLOR_RED) ;
-        DisplayStringAt(xright - font_value->Width * strlen(string), y, string) ;
-        y += font_value->Height + DISPLAY_YSPACING ;
+        value->widget.foreground = valid ? COLOR_BLACK : COLOR_RED ;
+        WidgetText(&value->widget, string) ;
         }
     }
 
@@ -467,23 +475,47 @@ static void UpdateSlider(ADJUST *adjust, uint32_t x)
     adjust->xpos = x ;
     }
 
-static void CheckAdjust(void)
+static void CheckAdjust(EVENT *event)
+    {
+    static TIMER repeat ;
+    static EVENT touch ;
+
+    if (event->type == EVENT_TOUCH_UP)
+        {
+        TimerStop(&repeat) ;
+        return ;
+        }
+    if (event->type != EVENT_TOUCH_DOWN && event->type != EVENT_TOUCH_DRAG) return ;
+
+    // While - or + repeats, a drag only moves where the repeats land
+    touch = *event ;
+    if (repeat.active) return ;
+
+    if (DoAdjust(&adjust, touch.x, touch.y) && event->type == EVENT_TOUCH_DOWN)
+        {
+        TimerStart(&repeat, ADJUST_REPEAT, ADJUST_REPEAT, RepeatAdjust, &touch) ;
+        }
+    }
+
+static void RepeatAdjust(void *arg)
     {
-    if (TS_Touched()) DoAdjust(&adjust) ;
+    EVENT *touch = (EVENT *) arg ;
+
+    DoAdjust(&adjust, touch->x, touch->y) ;
     }
 
-static void DoAdjust(ADJUST *adjust)
+// Returns TRUE if the touch stepped the value with the - or + button
+static BOOL DoAdjust(ADJUST *adjust, int x, int y)
     {
 #   define  XFUDGE  0
 #   define  YFUDGE  -10
-    int x, y, xmin, xmax ;
-    uint32_t timeout ;
+    int xmin, xmax ;
     float percent ;
 
-    y = TS_GetY() + YFUDGE ;
-    if (!Between(adjust->ymin, y, adjust->ymin + adjust->height - 1))   return ;
+    y += YFUDGE ;
+    if (!Between(adjust->ymin, y, adjust->ymin + adjust->height - 1))   return FALSE ;
 
-    x = TS_GetX() + XFUDGE ;
+    x += XFUDGE ;
     xmin = adjust->xmin + ADJUST_SIZE/2 ;
     xmax = adjust->xmin + adjust->width - ADJUST_SIZE/2 - 1 ;
 
@@ -493,7 +525,7 @@ static void DoAdjust(ADJUST *adjust)
         if (x > xmax) x = xmax ;
         UpdateValue(adjust, x) ;
         UpdateSlider(adjust, x) ;
-        return ;
+        return FALSE ;
         }
 
     if (Between(adjust->xdec, x, adjust->xdec + ADJUST_SIZE -1) && adjust->bits > adjust->vmin)
@@ -505,15 +537,10 @@ static void DoAdjust(ADJUST *adjust)
         {
         percent = (float) (++adjust->bits - adjust->vmin) / (adjust->vmax - adjust->vmin) ;
         }
-    else return ;
+    else return FALSE ;
 
     UpdateSlider(adjust, xmin + percent * (xmax - xmin)) ;
-    timeout = GetTimeout(300) ;
-    do
-        {
-        if (Expired(timeout)) break ;
-        Delay(100) ;
-        } while (TS_Touched()) ;
+    return TRUE ;
     }
 
 static int32_t Between(uint32_t min, uint32_t val, uint32_t max)
@@ -527,24 +554,6 @@ static void UpdateValue(ADJUST *adjust, uint32_t x)
     adjust->bits = adjust->vmin + percent * (adjust->vmax - adjust->vmin) ;
     }
 
-static uint32_t GetTimeout(uint32_t msec)
-    {
-#   define  CPU_CLOCK_SPEED_MHZ         168
-    uint32_t cycles = 1000 * msec * CPU_CLOCK_SPEED_MHZ ;
-    return GetClockCycleCount() + cycles ;
-    }
-
-static BOOL Expired(uint32_t timeout)
-    {
-    return (int) (GetClockCycleCount() - timeout) >= 0 ;
-    }
-
-static void Delay(uint32_t msec)
-    {
-    uint32_t timeout = GetTimeout(msec) ;
-    while (!Expired(timeout)) ;
-    }
-
 static void LEDs(int grn_on, int red_on)
     {
     static uint32_t * const pGPIOG_MODER    = (uint32_t *) 0x40021800 ;
@@ -330,6 +330,7 @@ static void LEDs(BOOL grn_on, BOOL red_on)
     *pGPIOG_ODR |= (red_on ? 1 : 0) << 14 ;
     }
 
+#if defined(__arm__)
 #pragma GCC push_options
 #pragma GCC optimize ("O1")
 static void CallFunction(void *function, uint32_t before[], uint32_t after[]) 
@@ -346,4 +347,17 @@ static void CallFunction(void *function, uint32_t before[], uint32_t after[])
         ) ;
     }
 #pragma GCC pop_options
+#else
+// Host build: the C calling convention preserves callee-saved registers for us,
+// so pass the argument registers and copy the rest through unchanged.
+static void CallFunction(void *function, uint32_t before[], uint32_t after[]) 
+    {
+    typedef uint64_t (*FUNC)(uint32_t, uint32_t, uint32_t, uint32_t) ;
+    uint64_t result = ((FUNC) function)(before[0], before[1], before[2], before[3]) ;
+
+    memcpy(after, before, ALL_REGS*sizeof(uint32_t)) ;
+    after[0] = LSW(result) ;
+    after[1] = MSW(result) ;
+    }
+#endif
 
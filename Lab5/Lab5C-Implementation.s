@@ -33,7 +33,7 @@ MxPlusB:
         MULS.N R0,R0,R2            // R0 = (dvnd*dvsr) >> 31) * dvsr
 
         ADD R0, R2, R0, LSL 1           // R0 = ((dvnd*dvsr) >> 31) * dvsr) << 1) + dvsr
-        ADD R0, R0, R0, LSL 31          // Add 1 if R0 is negative so ASR divides by 2 correctly
+        ADD R0, R0, R0, LSR 31          // Add 1 if R0 is negative so ASR divides by 2 correctly
         
 
         ASR R0, R0, 1                   // R0 = rounding = (((dvnd*dvsr) >> 31) * dvsr) << 1) + dvsr) / 2
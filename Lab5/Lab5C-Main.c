@@ -13,6 +13,12 @@
 #include <memory.h>
 #include "library.h"
 #include "graphics.h"
+#include "profile.h"
+#include "format.h"
+#include "glyphs.h"
+#include "timers.h"
+#include "tasks.h"
+#include "divide.h"
 
 #pragma GCC push_options
 #pragma GCC optimize ("O0")
@@ -101,6 +107,15 @@ typedef struct
     int32_t             maxC ;
     } PLOT_DATA ;
 
+typedef struct
+    {
+    int32_t             scaled030 ;     // calibrated readings scaled to the current Vref
+    int32_t             scaled110 ;
+    int32_t             rawTemp ;       // latest temperature sensor reading
+    int32_t             ypos ;          // first line of the readouts that change
+    PLOT_DATA           plot ;
+    } SENSOR ;
+
 // Public fonts defined in run-time library
 typedef struct
     {
@@ -127,10 +142,13 @@ static RSTCLKCTL *      RCC         =   (RSTCLKCTL *)   0x40023800 ;
 #define SWSTART         (1 << 30)
 #define TSVREFE         (1 << 23)
 
+#define SAMPLE_MSEC     50  // Time between temperature samples
+#define SETTLE_TICKS    2   // At least one full msec: the next tick may come at once
+
 static void             ADC_Init(void) ;
 static int32_t          ADC_Reading(int32_t channel) ;
-static void             DelayMS(uint32_t msec) ;
-static uint32_t         GetTimeout(uint32_t msec) ;
+static void             DisplaySample(void *arg) ;
+static void             FinishSample(void *arg) ;
 static void             LEDs(int grn_on, int red_on) ;
 static int32_t          LowPassFilter(PLOT_DATA *plot, int depth) ;
 static int32_t          PutStringAt(int32_t x, int32_t y, char *fmt, ...) ;
@@ -140,15 +158,21 @@ static void             Rescale(PLOT_DATA *plot) ;
 static BOOL             SanityChecksOK(void) ;
 static void             SetFontSize(sFONT *Font) ;
 static void             ShiftPlotLeft(void) ;
+static void             StartConversion(void *arg) ;
+static void             StartSample(void *arg) ;
+static int32_t          Tenths(int32_t hundredths) ;
 static BOOL             UpdateData(PLOT_DATA *plot, int32_t degrX100) ;
 
 #define ENTRIES(a)      (sizeof(a)/sizeof(a[0]))
 
+static SENSOR           sensor ;
+static TIMER            sampler ;       // every SAMPLE_MSEC
+static TIMER            converter ;     // steps of one sample
+static TASK             display = {DisplaySample, &sensor} ;
+
 int main(void)
     {
-    int32_t curVref, calVref, cal030, cal110, scaled110 ;
-    int32_t rawTemp, scaled030, y, savey, degreesC ;
-    static PLOT_DATA plot = {0} ;
+    int32_t curVref, calVref, cal030, cal110, y ;
 
     InitializeHardware(NULL, "Lab 5C: Linear Interpolation") ;
     ADC_Init() ;
@@ -161,8 +185,8 @@ int main(void)
     cal110 = CALIBRATION->TEMP_3V3_110C ;       // Get calibrated temp reading for 110 degrees C
 
     // Scale calibrated temp readings to current reference voltage
-    scaled030 = MxPlusB(cal030, curVref, calVref, 0) ;
-    scaled110 = MxPlusB(cal110, curVref, calVref, 0) ;
+    sensor.scaled030 = MxPlusB(cal030, curVref, calVref, 0) ;
+    sensor.scaled110 = MxPlusB(cal110, curVref, calVref, 0) ;
 
     SetFontSize(&FONT) ;
     y = 50 ;
@@ -175,7 +199,7 @@ int main(void)
     SetBackground(COLOR_LIGHTGREEN) ;
     y = PutStringAt(20, y, "       Current Vref: %5d", (int) curVref) ;
     y = PutStringAt(20, y, "    Calibrated Vref: %5d", (int) calVref) ;
-    y = PutStringAt(20, y, "       Scale Factor: %5.2f", (float) curVref /(float) calVref) ;
+    y = PutStringAt(20, y, "       Scale Factor: %5.2q", (100*curVref + calVref/2) / calVref) ;
     SetBackground(COLOR_WHITE) ;
     y += 4 ;
 
@@ -188,37 +212,65 @@ int main(void)
     y = PutStringAt(20, y, "  Calibrated ( 30C): %5d", (int) cal030) ;
     y = PutStringAt(20, y, "  Calibrated (110C): %5d", (int) cal110) ;
     y += 4 ;
-    y = PutStringAt(20, y, "      Scaled ( 30C): %5d", (int) scaled030) ;
-    y = PutStringAt(20, y, "      Scaled (110C): %5d", (int) scaled110) ;
+    y = PutStringAt(20, y, "      Scaled ( 30C): %5d", (int) sensor.scaled030) ;
+    y = PutStringAt(20, y, "      Scaled (110C): %5d", (int) sensor.scaled110) ;
     y += 4 ;
 
-    savey = y ;
-    while (1)
-        {
-        y = savey ;
+    // The A/D converter is stepped by timers and the display updated by a task,
+    // so the processor sleeps between samples instead of spinning
+    sensor.ypos = y ;
+    TimerStart(&sampler, SAMPLE_MSEC, SAMPLE_MSEC, StartSample, &sensor) ;
+    TaskRun() ;
 
-        // Get raw temp reading from A/D converter
-        rawTemp = ADC_Reading(ADC1_IN18) ;
+    return 0 ;
+    }
 
-        SetForeground(COLOR_BLACK) ;
-        SetBackground(COLOR_LIGHTGREEN) ;
-        y = PutStringAt(20, y, "    Raw A/D Reading: %5d", (int) rawTemp) ;
+// Same steps as ADC_Reading, with a SETTLE_TICKS timer in place of each wait
+static void StartSample(void *arg)
+    {
+    ADC1->SQR[2]    = ADC1_IN18 ;       // Select temperature sensor
+    TimerStart(&converter, SETTLE_TICKS, 0, StartConversion, arg) ;
+    }
 
-        // Convert to temp in degrees C (times 100)
-        degreesC = MxPlusB(rawTemp - scaled030, 8000, scaled110 - scaled030, 3000) ;
+static void StartConversion(void *arg)
+    {
+    ADC1->CR[1]     |= SWSTART ;        // Start the ADC EndOfConversion=1
+    TimerStart(&converter, SETTLE_TICKS, 0, FinishSample, arg) ;
+    }
 
-        if (UpdateData(&plot, degreesC)) Rescale(&plot) ;
-        ShiftPlotLeft() ;
-        PlotDegreesC(&plot, plot.samples - 1) ;
+static void FinishSample(void *arg)
+    {
+    SENSOR *sensor = (SENSOR *) arg ;
 
-        SetForeground(COLOR_BLACK) ;
-        SetBackground(COLOR_LIGHTGREEN) ;
-        PutStringAt(20, y, "   Temp (degrees C): %5.1f", plot.fltX100[plot.samples-1]/100.0) ;
+    while ((ADC1->SR & ADC1_EOC) == 0) ;// Wait for conversion
+    sensor->rawTemp = ADC1->DR ;        // Read data and clear EndOfConversion
+    TaskReady(&display) ;
+    }
 
-        DelayMS(50) ;
-        }
+static void DisplaySample(void *arg)
+    {
+    SENSOR *sensor = (SENSOR *) arg ;
+    PROFILE_TIMER timer = ProfileBegin("Temperature") ;
+    PLOT_DATA *plot = &sensor->plot ;
+    int32_t y, degreesC ;
 
-    return 0 ;
+    SetForeground(COLOR_BLACK) ;
+    SetBackground(COLOR_LIGHTGREEN) ;
+    y = PutStringAt(20, sensor->ypos, "    Raw A/D Reading: %5d", (int) sensor->rawTemp) ;
+
+    // Convert to temp in degrees C (times 100)
+    degreesC = MxPlusB(sensor->rawTemp - sensor->scaled030, 8000, sensor->scaled110 - sensor->scaled030, 3000) ;
+
+    if (UpdateData(plot, degreesC)) Rescale(plot) ;
+    ShiftPlotLeft() ;
+    PlotDegreesC(plot, plot->samples - 1) ;
+
+    SetForeground(COLOR_BLACK) ;
+    SetBackground(COLOR_LIGHTGREEN) ;
+    PutStringAt(20, y, "   Temp (degrees C): %5.1q", Tenths(plot->fltX100[plot->samples-1])) ;
+
+    ProfileEnd(&timer) ;
+    ProfileOverlay("Temperature") ;
     }
 
 static BOOL UpdateData(PLOT_DATA *plot, int32_t degreesC)
@@ -290,20 +342,20 @@ static void Rescale(PLOT_DATA *plot)
     DrawRect(PLOT_XMIN - 1, PLOT_YMIN - 1, PLOT_WIDTH + 1, PLOT_HEIGHT) ;
 
     // Label vertical scale
-    plot->minC = plot->minX100/100 ;
-    plot->maxC = (plot->maxX100 + 100)/100 ;
+    plot->minC = DIVS32(plot->minX100, 100) ;
+    plot->maxC = DIVS32(plot->maxX100 + 100, 100) ;
     if (plot->maxC == plot->minC) plot->maxC = plot->minC + 1 ;
     plot->yScale = (float) PLOT_HEIGHT / (plot->maxC - plot->minC) ;
 
-    step = 0.5 + (float) (plot->maxC - plot->minC + 1) / (PLOT_HEIGHT / FONT.Height) ;
+    step = 0.5f + (float) (plot->maxC - plot->minC + 1) / (PLOT_HEIGHT / FONT.Height) ;
     if (step == 0) step = 1 ;
 
     SetForeground(COLOR_BLACK) ;
     SetBackground(COLOR_WHITE) ;
     for (degreesC = plot->minC; degreesC <= plot->maxC; degreesC += step)
         {
-        int row = 0.5 + plot->yScale * (degreesC - plot->minC) ;
-        sprintf(text, "%d", (int) degreesC) ;
+        int row = 0.5f + plot->yScale * (degreesC - plot->minC) ;
+        FormatString(text, sizeof(text), "%d", (int) degreesC) ;
         DisplayStringAt(4, PLOT_YMAX - row - FONT.Height/2, text) ;
         }
 
@@ -315,7 +367,7 @@ static void Rescale(PLOT_DATA *plot)
     SetForeground(COLOR_BLACK) ;
     for (line = 0; line <= 4*range; line += step)
         {
-        int row = 0.5 + plot->yScale * line/4.0 ;
+        int row = 0.5f + plot->yScale * line/4.0f ;
         DrawHLine(PLOT_XMIN, PLOT_YMAX - row, PLOT_WIDTH) ;
         }
 
@@ -344,9 +396,9 @@ static void PlotDegreesC(PLOT_DATA *plot, int sample)
 
     if (sample == 0 || plot->samples < 2) return ;
 
-    yold = plot->yScale * (plot->fltX100[sample-1]/100.0 - plot->minC) ;
+    yold = plot->yScale * (plot->fltX100[sample-1]/100.0f - plot->minC) ;
     xnew = PLOT_XMAX - (plot->samples - sample) ;
-    ynew = plot->yScale * (plot->fltX100[sample]/100.0 - plot->minC) ;
+    ynew = plot->yScale * (plot->fltX100[sample]/100.0f - plot->minC) ;
 
     SetForeground(COLOR_RED) ;
     DrawLine(xnew - 1, PLOT_YMAX - yold, xnew, PLOT_YMAX - ynew) ;
@@ -363,40 +415,35 @@ static void ADC_Init(void)
 static int32_t ADC_Reading(int32_t channel)
     {
     ADC1->SQR[2]    = channel ;         // Select channel IN18 as only input channel
-    DelayMS(1) ;
+    TaskDelay(SETTLE_TICKS) ;
 
     ADC1->CR[1]     |= SWSTART ;        // Start the ADC EndOfConversion=1
-    DelayMS(1) ;                        // Give it a chance to convert
+    TaskDelay(SETTLE_TICKS) ;           // Give it a chance to convert
 
     while ((ADC1->SR & ADC1_EOC) == 0) ;// Wait for conversion
     return ADC1->DR ;                   // Read data and clear EndOfConversion
     }
 
-static uint32_t GetTimeout(uint32_t msec)
-    {
-#   define  CPU_CLOCK_SPEED_MHZ         168
-    uint32_t cycles = 1000 * msec * CPU_CLOCK_SPEED_MHZ ;
-    return GetClockCycleCount() + cycles ;
-    }
-
-static void DelayMS(uint32_t msec)
-    {
-    uint32_t timeout = GetTimeout(msec) ;
-    while ((int) (timeout - GetClockCycleCount()) > 0) ;
-    }
-
 static int32_t PutStringAt(int32_t x, int32_t y, char *fmt, ...)
     {
     char text[100] ;
     va_list aptr ;
 
     va_start(aptr, fmt);
-    vsprintf(text, fmt, aptr) ;
+    FormatList(text, sizeof(text), fmt, aptr) ;
     va_end(aptr) ;
-    DisplayStringAt(x, y, text) ;
+    GlyphString(x, y, text) ;
     return y + FONT.Height ;
     }
 
+// Rounds half away from zero. "%5.1f" on hundredths/100.0 could differ when the
+// last digit is 5: it rounded the nearest double, so 0.25 went to even (0.2) and
+// 0.35, stored just below, went down (0.3).
+static int32_t Tenths(int32_t hundredths)
+    {
+    return DIVS32(hundredths + (hundredths < 0 ? -5 : 5), 10) ;
+    }
+
 static uint32_t *PixelAddress(uint32_t x, uint32_t y)
     {
     return ((uint32_t *) 0xD0000000) + x + 240*y ;
@@ -412,6 +459,7 @@ static BOOL SanityChecksOK(void)
         {1,  5,  3,  0,  2},    {1, -5,  3,  0, -2},    {1,  5, -3,  0, -2},    {1, -5, -3, 0,  2},
         {1,  4,  3,  0,  1},    {1, -4,  3,  0, -1},    {1,  4, -3,  0, -1},    {1, -4, -3, 0,  1}
         } ;
+    char line[60] ;
     int which, errors ;
     CHECK *p ;
 
@@ -425,14 +473,16 @@ static BOOL SanityChecksOK(void)
     LEDs(!errors, errors) ;
     if (errors == 0) return TRUE ;
 
-    printf("\n       SANITY CHECK ERRORS:\n\n") ;
-    printf("       x mtop mbtm b  result\n") ;
-    printf("       - ---- ---- -  ------\n") ;
+    fputs("\n       SANITY CHECK ERRORS:\n\n", stdout) ;
+    fputs("       x mtop mbtm b  result\n", stdout) ;
+    fputs("       - ---- ---- -  ------\n", stdout) ;
 
     p = check ;
     for (which = 0; which < COUNT(check); which++, p++)
         {
-        if (p->result != p->correct) printf("       %2d  %+d   %+d  %d  %+4d\n", p->x, p->mtop, p->mbtm, p->b, p->result) ;
+        if (p->result == p->correct) continue ;
+        FormatString(line, sizeof(line), "       %2d  %+d   %+d  %d  %+4d\n", p->x, p->mtop, p->mbtm, p->b, p->result) ;
+        fputs(line, stdout) ;
         }
     return FALSE ;
     }
@@ -14,6 +14,12 @@
 #include "library.h"
 #include "graphics.h"
 #include "touch.h"
+#include "profile.h"
+#include "format.h"
+#include "glyphs.h"
+#include "events.h"
+#include "timers.h"
+#include "tasks.h"
 
 #pragma GCC push_options
 #pragma GCC optimize ("O0")
@@ -101,7 +107,6 @@ typedef struct
     CELL *                  to ;
     } MOVE ;
 
-static void                 Delay(unsigned msec) ;
 static void                 DrawGridLines(void) ;
 static void                 InitializeBoard(void) ;
 static void                 InitializeTouchScreen(void) ;
@@ -113,11 +118,13 @@ static BOOL                 SanityChecksOK(void) ;
 static void                 ScrambleFmTo(CELL *fm, CELL *to) ;
 static void                 ScrambleTiles(int row, int col) ;
 static BOOL                 Scrambled(void) ;
+static void                 SlideCell(RGB_PXL *dst, RGB_PXL *src) ;
 static void                 Status(char *format, ...) ;
 static void                 UndoAllMoves(void) ;
 static void                 UndoLastMove(void) ;
+static void                 UndoStep(void *arg) ;
 
-#define CPU_SPEED_MHZ       168
+#define UNDO_MSEC           200         // between the moves of UndoAllMoves
 
 #define RGB_BFR_ADRS        0xD0000000
 #define RGB_COL_OFFSET      0
@@ -144,6 +151,7 @@ static MOVE                 history[1000] ;
 static unsigned             past_moves = 0 ;
 static unsigned             game_moves = 0 ;
 static unsigned             init_moves ;
+static TIMER                undo ;
 static CELL                 cells[CELL_ROWS][CELL_COLS] ;
 static TILE                 tiles[CELL_ROWS][CELL_COLS] ;
 static const uint8_t        photo_bmp[] = 
@@ -14564,21 +14572,32 @@ int main(void)
     if (!SanityChecksOK()) return 0 ;
     InitializeTouchScreen() ;
     InitializeBoard() ;
+    EventInitialize() ;
 
     Status("Touch a cell to move") ;
-    while (Scrambled())
+    while (Scrambled() || undo.active)
         {
-        if (PushButtonPressed())
+        EVENT event ;
+
+        // While UndoAllMoves plays back, input is dropped and the loop just idles
+        if (undo.active)
+            {
+            if (!EventPoll(&event)) TaskIdle() ;
+            continue ;
+            }
+
+        EventWait(&event) ;     // Sleeps until a touch or the push button
+
+        if (event.type == EVENT_BUTTON_UP)
             {
-            WaitForPushButton() ;
             UndoAllMoves() ;
             continue ;
             }
 
-        if (!TS_Touched()) continue ;
+        if (event.type != EVENT_TOUCH_DOWN) continue ;
 
-        x = TS_GetX() ;
-        y = TS_GetY() ;
+        x = event.x ;
+        y = event.y ;
 
         for (index = 0; index < TOTAL_CELLS; index++)
             {
@@ -14614,9 +14633,6 @@ int main(void)
             else Status("Move history is full!") ;
             break ;
             }
-
-        do Delay(50) ;
-        while (TS_Touched()) ;
         }
 
     // Repaint the entire image without the separating lines
@@ -14772,8 +14788,7 @@ static void UndoLastMove(void)
     CELL *to = move->to ;
     TILE *temptile ;
 
-    CopyCell(fm->pRGB, to->pRGB) ;
-    FillCell(to->pRGB, COLOR_WHITE) ;
+    SlideCell(fm->pRGB, to->pRGB) ;
 
     temptile = fm->tile ;
     fm->tile = to->tile ;
@@ -14782,21 +14797,17 @@ static void UndoLastMove(void)
     Status("Total Moves: %d", ++game_moves) ;
     }
 
+// Starts playing the moves back one every UNDO_MSEC; the main loop keeps running
 static void UndoAllMoves(void)
     {
     game_moves = 0 ;
-    while (past_moves > 0)
-        {
-        UndoLastMove() ;
-        Delay(200) ;
-        }
+    if (past_moves > 0) TimerStart(&undo, 1, UNDO_MSEC, UndoStep, NULL) ;
     }
 
-static void Delay(unsigned msec)
+static void UndoStep(void *arg)
     {
-    uint32_t cycles = 1000 * msec * CPU_SPEED_MHZ ;
-    uint32_t timeout = GetClockCycleCount() + cycles ;
-    while ((int) (timeout - GetClockCycleCount()) > 0) ;
+    if (past_moves > 0) UndoLastMove() ;
+    else TimerStop(&undo) ;     // after one more period showing the last move
     }
 
 static void PaintOneCell(BMP_PXL *pBMP, RGB_PXL *pRGB)
@@ -14820,8 +14831,7 @@ static void MoveFmTo(CELL *fm, CELL *to)
     TILE *temptile ;
     MOVE *move ;
 
-    CopyCell(to->pRGB, fm->pRGB) ;
-    FillCell(fm->pRGB, COLOR_WHITE) ;
+    SlideCell(to->pRGB, fm->pRGB) ;
 
     // Swap tiles
     temptile = to->tile ;
@@ -14835,19 +14845,34 @@ static void MoveFmTo(CELL *fm, CELL *to)
     Status("Total Moves: %d", ++game_moves) ;
     }
 
+static void SlideCell(RGB_PXL *dst, RGB_PXL *src)
+    {
+    PROFILE_TIMER timer ;
+
+    timer = ProfileBegin("CopyCell") ;
+    CopyCell(dst, src) ;
+    ProfileEnd(&timer) ;
+
+    timer = ProfileBegin("FillCell") ;
+    FillCell(src, COLOR_WHITE) ;
+    ProfileEnd(&timer) ;
+
+    ProfileOverlay("CopyCell") ;
+    }
+
 static void Status(char *format, ...)
     {
     char text[100] ;
     va_list ap ;
 
     va_start(ap, format) ;
-    vsprintf(text, format, ap) ;
+    FormatList(text, sizeof(text), format, ap) ;
     va_end(ap) ;
 
     SetColor(COLOR_WHITE) ;
     FillRect(0, STATUS_ROW, 240, 15) ;
     SetColor(COLOR_BLACK) ;
-    DisplayStringAt((IMG_COLS - 7*strlen(text)) / 2, STATUS_ROW, text) ;
+    GlyphString((IMG_COLS - 7*strlen(text)) / 2, STATUS_ROW, text) ;
     }
 
 static void InitializeTouchScreen(void)
@@ -63,4 +63,96 @@ GetNibble:
 	
 	POP	{R4,R5}
 	BX	LR
+
+// void GetNibbles(uint8_t *bytes, const void *nibbles, uint32_t count) ;
+// Unpacks count nibbles, eight from each word: the even nibbles and the odd ones
+// masked out a byte apiece, then interleaved through the halfwords with UXTB16.
+
+        .global     GetNibbles
+        .thumb_func
+        .align
+GetNibbles:         // R0 = bytes, R1 = nibbles (word aligned), R2 = count
+        PUSH        {R4-R7}
+        LDR         R12,=0x0F0F0F0F
+        SUBS        R2,R2,8             // at least 8 left?
+        BLO         GetTail
+GetEight:
+        LDR         R3,[R1],4           // nibbles n7 (top) to n0
+        AND         R4,R3,R12           // bytes n0 n2 n4 n6
+        AND         R5,R12,R3,LSR 4     // bytes n1 n3 n5 n7
+        UXTB16      R6,R4               // n0 : n4 in the halfwords
+        UXTB16      R7,R4,ROR 8         // n2 : n6
+        UXTB16      R3,R5               // n1 : n5
+        UXTB16      R5,R5,ROR 8         // n3 : n7
+        ORR         R6,R6,R3,LSL 8      // bytes n0 n1 n4 n5
+        ORR         R7,R7,R5,LSL 8      // bytes n2 n3 n6 n7
+        PKHBT       R4,R6,R7,LSL 16     // n0 n1 n2 n3
+        PKHTB       R5,R7,R6,ASR 16     // n4 n5 n6 n7
+        STR         R4,[R0],4           // bytes need not be aligned
+        STR         R5,[R0],4
+        SUBS        R2,R2,8
+        BHS         GetEight
+GetTail:
+        ADDS        R2,R2,8             // 0 to 7 left
+        BEQ         GetDone
+        LDR         R3,[R1]
+GetOne:
+        AND         R4,R3,15
+        STRB        R4,[R0],1
+        LSRS        R3,R3,4
+        SUBS        R2,R2,1
+        BNE         GetOne
+GetDone:
+        POP         {R4-R7}
+        BX          LR
+
+// void PutNibbles(void *nibbles, const uint8_t *bytes, uint32_t count) ;
+// Packs count bytes (their low four bits) back into nibbles, a word at a time:
+// each byte pair folds into one byte, UXTB16 drops the odd bytes and BFI joins the
+// two halfwords. The nibbles after count in the last word are left alone.
+
+        .global     PutNibbles
+        .thumb_func
+        .align
+PutNibbles:         // R0 = nibbles (word aligned), R1 = bytes, R2 = count
+        PUSH        {R4-R6}
+        LDR         R12,=0x0F0F0F0F
+        SUBS        R2,R2,8             // at least 8 left?
+        BLO         PutTail
+PutEight:
+        LDR         R3,[R1],4           // bytes n0 n1 n2 n3
+        LDR         R4,[R1],4           // bytes n4 n5 n6 n7
+        AND         R3,R3,R12
+        AND         R4,R4,R12
+        ORR         R3,R3,R3,LSR 4      // n1n0 in byte 0, n3n2 in byte 2
+        ORR         R4,R4,R4,LSR 4      // n5n4 in byte 0, n7n6 in byte 2
+        UXTB16      R3,R3
+        UXTB16      R4,R4
+        ORR         R3,R3,R3,LSR 8      // n3n2n1n0 in the low halfword
+        ORR         R4,R4,R4,LSR 8      // n7n6n5n4
+        BFI         R3,R4,16,16
+        STR         R3,[R0],4
+        SUBS        R2,R2,8
+        BHS         PutEight
+PutTail:
+        ADDS        R2,R2,8             // 0 to 7 left
+        BEQ         PutDone
+        LDR         R3,[R0]
+        MOVS        R5,0                // shift
+PutOne:
+        LDRB        R4,[R1],1
+        AND         R4,R4,15
+        MOVS        R6,15
+        LSLS        R6,R6,R5
+        BICS        R3,R3,R6
+        LSLS        R4,R4,R5
+        ORRS        R3,R3,R4
+        ADDS        R5,R5,4
+        SUBS        R2,R2,1
+        BNE         PutOne
+        STR         R3,[R0]
+PutDone:
+        POP         {R4-R6}
+        BX          LR
+
         .end
@@ -13,6 +13,13 @@
 #include "library.h"
 #include "graphics.h"
 #include "touch.h"
+#include "profile.h"
+#include "format.h"
+#include "glyphs.h"
+#include "events.h"
+#include "timers.h"
+#include "tasks.h"
+#include "dlx.h"
 
 #pragma GCC push_options
 #pragma GCC optimize ("O0")
@@ -45,6 +52,23 @@ void __attribute__((weak)) PutNibble(void *nibbles, uint32_t which, uint32_t val
         }
     }
 
+// The whole board at once: one byte per nibble, and back
+void __attribute__((weak)) GetNibbles(uint8_t *bytes, void *nibbles, uint32_t count)
+    {
+    for (uint32_t which = 0; which < count; which++)
+        {
+        bytes[which] = GetNibble(nibbles, which) ;
+        }
+    }
+
+void __attribute__((weak)) PutNibbles(void *nibbles, uint8_t *bytes, uint32_t count)
+    {
+    for (uint32_t which = 0; which < count; which++)
+        {
+        PutNibble(nibbles, which, bytes[which] & 0b00001111) ;
+        }
+    }
+
 #pragma GCC pop_options
 
 typedef enum {FALSE = 0, TRUE = 1} BOOL ;
@@ -59,9 +83,11 @@ typedef struct
     unsigned            putCalls ;
     unsigned            getCycles ;
     unsigned            putCycles ;
-    float               elapsed ;
+    unsigned            elapsed ;   // hundredths of a second, in the selected mode
     } REPORT ;
 
+typedef struct _SEARCH SEARCH ;     // below, once CELLS is defined
+
 typedef struct _tFont
     {
     const uint8_t *     table ;
@@ -76,30 +102,47 @@ extern sFONT            Font20 ;
 extern sFONT            Font24 ;   // Largest font used for game
 
 // Functions private to the main program
+static uint32_t         Candidates(int index) ;
 static int              Cell2Fill(int index) ;
 static void             ClearFlags(int row, int col, int digit) ;
 static BOOL             Conflict(int row, int col, int digit) ;
+static int              CountCandidates(uint32_t mask) ;
 static void             DisplayBoard(void) ;
 static void             DisplayCell(int row, int col, int digit) ;
-static void             DisplayResults(REPORT *report) ;
+static void             DisplayResults(REPORT results[]) ;
+static void             DlxMove(void *arg, int cell, int digit) ;
 static void             DrawGrid(void) ;
 static void             EditConfiguration(void) ;
+static int              FewestCandidates(void) ;
+static void             InitializeCandidates(void) ;
 static void             InitializeGame(void) ;
 static void             InitializeFlags(void) ;
+static void             InitializePeers(void) ;
 static void             InitializeStats(void) ;
 static void             InitializeTouchScreen(void) ;
+static void             Journal(int index, int digit) ;
+static void             JournalBegin(void) ;
+static void             JournalDrain(void) ;
 static void             LEDs(int grn_on, int red_on) ;
+static void             MaskDigit(int index, int digit) ;
 static void             RandomizeGame(void) ;
+static void             RestoreGame(void) ;
 static void             RandomizeMajor(void (*Swap)(int major1, int major2)) ;
 static void             RandomizeMinor(void (*Swap)(int minor1, int minor2)) ;
+static void             RenderFrame(void *arg) ;
 static int              ReportHeader(int row, sFONT *font, char *text, int lines) ;
 static int              ReportLine(int row, sFONT *font, char *fmt, ...) ;
 static int              SanityChecksOK(void) ;
 static void             SetFlags(int row, int col, int digit) ;
 static void             SetFontSize(sFONT *font) ;
-static int              SolvePuzzle(int index, int count) ;
+static void             ShowMode(void) ;
+static void             SolveBegin(SEARCH *search, int method, int count) ;
+static int              SolveStep(SEARCH *search, unsigned budget) ;
+static void             SolveTask(void *arg) ;
 static void             SwapCols(int col1, int col2) ;
 static void             SwapRows(int row1, int row2) ;
+static void             UnmaskDigit(int index, int digit) ;
+static void             WaitForButtonUp(void) ;
 
 #define TOP_EDGE        56
 #define LFT_EDGE        10
@@ -120,12 +163,15 @@ static void             SwapRows(int row1, int row2) ;
 #define INDEX(row, col) ((row)*COLS+(col))
 #define ENTRIES(a)      (sizeof(a)/sizeof(a[0]))
 
-#define REPORT_XPOS     20
-#define REPORT_YPOS     55
-#define REPORT_WIDTH    18
+#define REPORT_XPOS     22
+#define REPORT_YPOS     60
+#define REPORT_WIDTH    28
 
 #define EMPTY           0
 
+#define NIBBLE_SAMPLES  32
+#define CYCLES_PER_10MS 1680000
+
 static uint32_t storage[WORDS] ;
 static uint32_t initial[WORDS] =
     {
@@ -135,11 +181,87 @@ static uint32_t initial[WORDS] =
     } ;
 static REPORT           report ;
 
+// The same puzzle goes to each solver in turn, from the board as edited
+#define SCAN            0           // cells in Cell2Fill order
+#define FEWEST          1           // the cell with the fewest candidates
+#define EXACT           2           // exact cover on dancing links, in dlx.c
+#define SOLVERS         3
+
+#define SOLVE_BUDGET    64          // nodes per SolveTask
+
+// A cell the search has filled, and what is left to try there
+typedef struct
+    {
+    uint8_t             index ;
+    uint8_t             digit ;     // in the cell now
+    uint16_t            mask ;      // FEWEST: candidates not tried yet
+    } CHOICE ;
+
+typedef enum {SOLVE_RUNNING, SOLVE_SOLVED, SOLVE_FAILED, SOLVE_ABORTED} SOLVE_RESULT ;
+
+// The whole state of a search between calls of SolveStep: a choice per empty
+// cell in place of the recursive version's stack frames
+struct _SEARCH
+    {
+    int                 method ;    // SCAN or FEWEST
+    SOLVE_RESULT        result ;
+    int                 filled ;    // cells with a digit
+    int                 depth ;     // choices on the stack
+    int                 next ;      // SCAN: the cell to look at next
+    BOOL                descend ;   // look for a cell to fill, else try the top one's next digit
+    CHOICE              stack[CELLS] ;
+    } ;
+
+static SEARCH           search ;
+static DLX              dlx ;
+static TASK             solving = {SolveTask, &search} ;
+
+// The search only journals its placements and removals. RenderFrame drains the
+// journal every FRAME_MSEC (LIVE) or once at the end (TURBO) and redraws just the
+// cells whose digit is not the one on the screen; a full journal is drained
+// without drawing, so only the last digit of a cell ever reaches the LCD.
+#define LIVE            0
+#define TURBO           1
+#define MODES           2
+
+static int              mode = LIVE ;   // touched above the board to switch, shown in the header
+
+#define JOURNAL_SIZE    128         // a power of two
+#define FRAME_MSEC      40          // 25 frames a second
+
+typedef struct
+    {
+    uint8_t             index ;
+    uint8_t             digit ;     // EMPTY for a removal
+    } ENTRY ;
+
+static ENTRY            journal[JOURNAL_SIZE] ;
+static unsigned         journal_head ;  // written only by the search
+static unsigned         journal_tail ;  // written only by JournalDrain
+static uint8_t          pending[CELLS] ;    // each cell's latest digit from the journal
+static uint8_t          shown[CELLS] ;      // and the one on the screen
+static uint32_t         dirty[(CELLS + 31)/32] ;
+static TIMER            frame ;
+
+static uint32_t         start[WORDS] ;
+static uint32_t         start_flags[3][9] ;
+static REPORT           results[SOLVERS] ;
+
 #define FLAGS_ROWS      0
 #define FLAGS_COLS      1
 #define FLAGS_BLKS      2
 
 static uint32_t         flags[3][9] ;
+static uint8_t          board[CELLS] ;  // a nibble board unpacked by GetNibbles
+
+// Digits (bits 1-9, as in flags) still allowed in each empty cell, kept up to
+// date by MaskDigit and UnmaskDigit for FEWEST
+#define DIGIT_MASK      0x3FE
+#define FILLED          0x8000      // the cell has a digit
+#define PEERS           20          // other cells in the same row, column or block
+
+static uint16_t         candidates[CELLS] ;
+static uint8_t          peers[CELLS][PEERS] ;
 static uint32_t         digit_foreground ;
 static uint32_t         digit_background ;
 
@@ -147,12 +269,23 @@ int main()
     {
     InitializeHardware(HEADER, "Lab 7C: Autonomous Sudoku") ;
     InitializeTouchScreen() ;
+    EventInitialize() ;
 
     if (!SanityChecksOK()) return 255 ;
+    InitializePeers() ;
 
     while (1)
         {
-        unsigned cells_filled, strt, stop ;
+        // Each mode in its own profile regions, as drawing changes the time so much
+        static char *names[MODES][SOLVERS] =
+            {
+            {"SolvePuzzle", "SolveFewest", "SolveExact"},
+            {"TurboPuzzle", "TurboFewest", "TurboExact"}
+            } ;
+        static char *status[] = {"", "Solved", "Failed", "Abort!"} ;
+        SOLVE_RESULT result = SOLVE_RUNNING ;
+        int last = 0 ;          // the solver that ran last, aborted or not
+        unsigned gets ;
 
         InitializeStats() ;
         RandomizeGame() ;
@@ -160,29 +293,58 @@ int main()
         InitializeFlags() ;
         InitializeGame() ;
         EditConfiguration() ;
-        WaitForPushButton() ;   // Wait for user to start the algorithm
-
-        digit_foreground = COLOR_BLUE ;
-        digit_background = COLOR_WHITE ;
-
-        strt = GetClockCycleCount() ;
-        cells_filled = SolvePuzzle(0, report.initial) ;
-        stop = GetClockCycleCount() ;
-        report.elapsed = (stop - strt) / 168000000.0 ;
+        WaitForButtonUp() ;     // Wait for user to start the algorithm
 
-        if (cells_filled < CELLS)
+        memcpy(start, storage, sizeof(start)) ;
+        memcpy(start_flags, flags, sizeof(start_flags)) ;
+        gets = report.getCalls ;        // InitializeFlags' reads, in every solver's count
+        for (int solver = 0; solver < SOLVERS; solver++)
             {
-            report.status = "Failed" ;
+            results[solver] = report ;
+            results[solver].status = "-" ;
             }
-        else if (cells_filled == CELLS)
+
+        for (int solver = 0; solver < SOLVERS && result != SOLVE_ABORTED; solver++)
             {
-            WaitForPushButton() ;
-            report.status = "Solved" ;
+            PROFILE_TIMER timer ;
+
+            if (solver != SCAN) RestoreGame() ;
+            digit_foreground = COLOR_BLUE ;
+            digit_background = COLOR_WHITE ;
+            report.placed = report.removed = report.putCalls = 0 ;
+            report.getCalls = gets ;
+
+            // The search runs as a task a budget of nodes at a time; in between,
+            // the frame timer redraws the board and the button can stop it
+            timer = ProfileBegin(names[mode][solver]) ;
+            SolveBegin(&search, solver, report.initial) ;
+            if (mode == LIVE) TimerStart(&frame, FRAME_MSEC, FRAME_MSEC, RenderFrame, NULL) ;
+            TaskReady(&solving) ;
+            while (search.result == SOLVE_RUNNING)
+                {
+                EVENT event ;
+
+                if (!EventPoll(&event)) TaskIdle() ;
+                else if (event.type == EVENT_BUTTON_DOWN)
+                    {
+                    search.result = SOLVE_ABORTED ;
+                    WaitForButtonUp() ;
+                    }
+                }
+            TimerStop(&frame) ;
+            RenderFrame(NULL) ;
+            report.elapsed = (ProfileEnd(&timer) + CYCLES_PER_10MS/2) / CYCLES_PER_10MS ;
+
+            result = search.result ;
+            report.status = status[result] ;
+            results[solver] = report ;
+            last = solver ;
             }
-        else report.status = "Abort!" ;
 
-        DisplayResults(&report) ;
-        WaitForPushButton() ;
+        if (result == SOLVE_SOLVED) WaitForButtonUp() ;
+        DisplayResults(results) ;
+        ProfileOverlay(names[mode][last]) ;
+        WaitForButtonUp() ;
         }
 
     return 0 ;
@@ -220,23 +382,29 @@ static void InitializeTouchScreen(void)
 
 static void InitializeStats(void)
     {
-    unsigned strt, stop, ovhd ;
+    PROFILE_STATS stats ;
+    int sample ;
 
     memset(&report, 0, sizeof(report)) ;
 
-    strt = GetClockCycleCount() ;
-    stop = GetClockCycleCount() ;
-    ovhd = stop - strt ;
-
-    strt = GetClockCycleCount() ;
-    GetNibble(storage, 0) ;
-    stop = GetClockCycleCount() ;
-    report.getCycles = stop - strt - ovhd ;
+    // Median of several samples rather than one that may have caught an interrupt
+    for (sample = 0; sample < NIBBLE_SAMPLES; sample++)
+        {
+        PROFILE_TIMER timer = ProfileBegin("GetNibble") ;
+        GetNibble(storage, 0) ;
+        ProfileEnd(&timer) ;
+        }
+    ProfileStats("GetNibble", &stats) ;
+    report.getCycles = stats.median ;
 
-    strt = GetClockCycleCount() ;
-    PutNibble(storage, 0, EMPTY) ;
-    stop = GetClockCycleCount() ;
-    report.putCycles = stop - strt - ovhd ;
+    for (sample = 0; sample < NIBBLE_SAMPLES; sample++)
+        {
+        PROFILE_TIMER timer = ProfileBegin("PutNibble") ;
+        PutNibble(storage, 0, EMPTY) ;
+        ProfileEnd(&timer) ;
+        }
+    ProfileStats("PutNibble", &stats) ;
+    report.putCycles = stats.median ;
     }
 
 static int ReportHeader(int row, sFONT *font, char *title, int lines)
@@ -247,7 +415,7 @@ static int ReportHeader(int row, sFONT *font, char *title, int lines)
     FillRect(REPORT_XPOS, row, REPORT_WIDTH*font->Width, font->Height) ;
     SetForeground(COLOR_WHITE) ;
     SetBackground(COLOR_BLACK) ;
-    DisplayStringAt(REPORT_XPOS + font->Width, row, title) ;
+    GlyphString(REPORT_XPOS + font->Width, row, title) ;
     return row + font->Height + font->Height/4 ;
     }
 
@@ -259,15 +427,17 @@ static int ReportLine(int row, sFONT *font, char *format, ...)
     SetForeground(COLOR_BLACK) ;
     SetBackground(COLOR_WHITE) ;
     va_start(args, format) ;
-    vsnprintf(text, sizeof(text), format, args);
-    DisplayStringAt(REPORT_XPOS + font->Width, row, text) ;
+    FormatList(text, sizeof(text), format, args) ;
+    GlyphString(REPORT_XPOS + font->Width, row, text) ;
     va_end(args) ;
     return row + font->Height ;
     }
 
-static void DisplayResults(REPORT *report)
+// The three searches side by side: SCAN's counts, then FEWEST's, then EXACT's
+static void DisplayResults(REPORT results[])
     {
-    sFONT *font = &Font16 ;
+    REPORT *scan = &results[SCAN], *fewest = &results[FEWEST], *exact = &results[EXACT] ;
+    sFONT *font = &Font12 ;
     int row ;
 
     ClearDisplay() ;
@@ -275,28 +445,28 @@ static void DisplayResults(REPORT *report)
 
     row = REPORT_YPOS ;
 
-    row = ReportHeader(row, font, "PUZZLE RESULTS", 2) ;
-    row = ReportLine(row, font, "   Status:%s", report->status) ;
-    row = ReportLine(row, font, "  Elapsed:%.2fs", report->elapsed) ;
+    row = ReportHeader(row, font, "RESULT  SCAN    MRV    DLX", 2) ;
+    row = ReportLine(row, font, "State %6s %6s %6s", scan->status, fewest->status, exact->status) ;
+    row = ReportLine(row, font, "%-5s %5.2qs %5.2qs %5.2qs", mode == LIVE ? "Live" : "Turbo",
+                     scan->elapsed, fewest->elapsed, exact->elapsed) ;
 
-    row += 6 ;
+    row += 8 ;
 
     row = ReportHeader(row, font, "DIGIT PLACEMENTS", 3) ;
-    row = ReportLine(row, font, "  Initial:%u", report->initial) ;
-    row = ReportLine(row, font, " Attempts:%u", report->placed) ;
-    row = ReportLine(row, font, " Removals:%u", report->removed) ;
+    row = ReportLine(row, font, "Given %6u %6u %6u", scan->initial, fewest->initial, exact->initial) ;
+    row = ReportLine(row, font, "Tried %6u %6u %6u", scan->placed, fewest->placed, exact->placed) ;
+    row = ReportLine(row, font, "Undo  %6u %6u %6u", scan->removed, fewest->removed, exact->removed) ;
 
-    row += 6 ;
+    row += 8 ;
 
     row = ReportHeader(row, font, "FUNCTION CALLS", 2) ;
-    row = ReportLine(row, font, "GetNibble:%u", report->getCalls) ;
-    row = ReportLine(row, font, "PutNibble:%u", report->putCalls) ;
+    row = ReportLine(row, font, "Gets  %6u %6u %6u", scan->getCalls, fewest->getCalls, exact->getCalls) ;
+    row = ReportLine(row, font, "Puts  %6u %6u %6u", scan->putCalls, fewest->putCalls, exact->putCalls) ;
 
-    row += 6 ;
+    row += 8 ;
 
-    row = ReportHeader(row, font, "CLOCK CYCLES", 2) ;
-    row = ReportLine(row, font, "GetNibble:%u", report->getCycles) ;
-    row = ReportLine(row, font, "PutNibble:%u", report->putCycles) ;
+    row = ReportHeader(row, font, "CLOCK CYCLES", 1) ;
+    row = ReportLine(row, font, "Get:%u  Put:%u", scan->getCycles, scan->putCycles) ;
     }
 
 static void SetFontSize(sFONT *font)
@@ -305,6 +475,17 @@ static void SetFontSize(sFONT *font)
     BSP_LCD_SetFont(font) ;
     }
 
+// The mode in the corner of the header, white on its blue
+static void ShowMode(void)
+    {
+    static char *labels[] = {" LIVE", "TURBO"} ;
+
+    SetFontSize(&Font8) ;
+    SetForeground(COLOR_WHITE) ;
+    SetBackground(COLOR_BLUE) ;
+    DisplayStringAt(XPIXELS - 5*Font8.Width - 4, 4, (uint8_t *) labels[mode]) ;
+    }
+
 static void InitializeGame(void)
     {
     for (int word = 0; word < WORDS; word++)
@@ -313,66 +494,227 @@ static void InitializeGame(void)
         }
     }
 
-static int SolvePuzzle(int index, int cells_filled)
+static void SolveBegin(SEARCH *search, int method, int cells_filled)
     {
-    int row, col ;
-
-    // Check for user abort
-    if (PushButtonPressed())
+    search->method = method ;
+    search->result = SOLVE_RUNNING ;
+    search->filled = cells_filled ;
+    search->depth = 0 ;
+    search->next = 0 ;
+    search->descend = TRUE ;
+    if (method == FEWEST) InitializeCandidates() ;
+    if (method == EXACT)
         {
-        WaitForPushButton() ;
-        return CELLS + 1 ;
+        GetNibbles(board, storage, CELLS) ;
+        if (DlxBegin(&dlx, board, DlxMove, NULL) != DLX_RUNNING) search->result = SOLVE_FAILED ;
         }
+    JournalBegin() ;
+    }
 
-    if (cells_filled >= CELLS)
+// Runs the search for up to budget nodes and returns its result so far. A node is
+// one visit to a cell, the steps one level of the recursive search took: look for
+// the next cell to fill and push it, or try the next digit in the top cell and pop
+// it when there are none left. SCAN walks the cells in Cell2Fill order and tries
+// the digits upwards through Conflict; FEWEST takes the empty cell with the fewest
+// candidates and tries them from the highest digit down with CLZ. EXACT hands the
+// budget to DlxStep, whose nodes are the same two steps on the exact cover matrix.
+static int SolveStep(SEARCH *search, unsigned budget)
+    {
+    if (search->method == EXACT)
         {
-        return cells_filled ;
+        DLX_RESULT result = search->result == SOLVE_RUNNING ? DlxStep(&dlx, budget) : DLX_RUNNING ;
+
+        if (result == DLX_SOLVED) search->result = SOLVE_SOLVED ;
+        else if (result == DLX_FAILED) search->result = SOLVE_FAILED ;
+        return search->result ;
         }
 
-    report.getCalls++ ;
-    if (GetNibble(storage, index) != EMPTY)
+    while (search->result == SOLVE_RUNNING && budget-- > 0)
         {
-        cells_filled = SolvePuzzle(Cell2Fill(index), cells_filled) ;
-        return cells_filled ;
-        }
+        CHOICE *choice ;
+        int row, col, digit ;
 
-    /*
-     * Iterate through the possible digits for this empty cell
-     * and recurse for every valid one, to test if it's part
-     * of the valid solution.
-     */
-    row = index / ROWS ;
-    col = index % COLS ;
+        if (search->descend)
+            {
+            int index ;
+
+            if (search->filled >= CELLS)
+                {
+                search->result = SOLVE_SOLVED ;
+                break ;
+                }
+
+            if (search->method == SCAN)
+                {
+                index = search->next ;
+                search->next = Cell2Fill(index) ;
+                report.getCalls++ ;
+                if (GetNibble(storage, index) != EMPTY) continue ;
+                }
+            else if ((index = FewestCandidates()) < 0)
+                {
+                search->result = SOLVE_FAILED ;
+                break ;
+                }
+
+            choice = &search->stack[search->depth++] ;
+            choice->index = index ;
+            choice->digit = EMPTY ;
+            if (search->method == FEWEST)
+                {
+                choice->mask = candidates[index] ;
+                candidates[index] = FILLED ;
+                }
+            search->descend = FALSE ;
+            continue ;
+            }
 
-    for (int digit = 1; digit <= 9; digit++)
-        {
-        int new_filled ;
+        // Take back the digit that led nowhere and try the next one
+        choice = &search->stack[search->depth - 1] ;
+        row = choice->index / ROWS ;
+        col = choice->index % COLS ;
+        if (choice->digit != EMPTY)
+            {
+            if (search->method == SCAN) ClearFlags(row, col, choice->digit) ;
+            else UnmaskDigit(choice->index, choice->digit) ;
+            search->filled-- ;
+            }
+
+        digit = EMPTY ;
+        if (search->method == SCAN)
+            {
+            for (digit = choice->digit + 1; digit <= 9 && Conflict(row, col, digit); digit++) continue ;
+            if (digit > 9) digit = EMPTY ;
+            }
+        else if (choice->mask != 0)
+            {
+            digit = 31 - __builtin_clz(choice->mask) ;
+            choice->mask &= ~(1 << digit) ;
+            }
 
-        if (Conflict(row, col, digit)) continue ;
+        if (digit != EMPTY)
+            {
+            PutNibble(storage, choice->index, digit) ;
+            Journal(choice->index, digit) ;
+            if (search->method == SCAN) SetFlags(row, col, digit) ;
+            else MaskDigit(choice->index, digit) ;
+            report.placed++ ;
+            report.putCalls++ ;
+
+            choice->digit = digit ;
+            search->filled++ ;
+            search->next = Cell2Fill(choice->index) ;
+            search->descend = TRUE ;
+            continue ;
+            }
 
-        SetColor(COLOR_RED) ;
-        PutNibble(storage, index, digit) ;
-        DisplayCell(row, col, digit) ;
-        SetFlags(row, col, digit) ;
-        report.placed++ ;
+        if (search->method == FEWEST) candidates[choice->index] = Candidates(choice->index) ;
+        PutNibble(storage, choice->index, EMPTY) ;
+        Journal(choice->index, EMPTY) ;
+        report.removed++ ;
         report.putCalls++ ;
+        if (--search->depth == 0) search->result = SOLVE_FAILED ;
+        }
+
+    return search->result ;
+    }
+
+// EXACT's board and counts, kept as the other searches keep theirs
+static void DlxMove(void *arg, int cell, int digit)
+    {
+    PutNibble(storage, cell, digit) ;
+    Journal(cell, digit) ;
+    if (digit != EMPTY) report.placed++ ;
+    else report.removed++ ;
+    report.putCalls++ ;
+    }
+
+// One budget of nodes at a time, between the events and timers of the main loop
+static void SolveTask(void *arg)
+    {
+    if (SolveStep((SEARCH *) arg, SOLVE_BUDGET) == SOLVE_RUNNING) TaskReady(&solving) ;
+    }
+
+// The screen shows the board the search starts from
+static void JournalBegin(void)
+    {
+    journal_head = journal_tail = 0 ;
+    memset(dirty, 0, sizeof(dirty)) ;
+    GetNibbles(shown, storage, CELLS) ;
+    memcpy(pending, shown, sizeof(pending)) ;
+    }
 
-        new_filled = SolvePuzzle(Cell2Fill(index), cells_filled + 1) ;
-        if (new_filled >= CELLS)
+static void Journal(int index, int digit)
+    {
+    ENTRY *entry ;
+
+    if (journal_head - journal_tail == JOURNAL_SIZE) JournalDrain() ;
+    entry = &journal[journal_head++ % JOURNAL_SIZE] ;
+    entry->index = index ;
+    entry->digit = digit ;
+    }
+
+// Entries for the same cell collapse into its pending digit
+static void JournalDrain(void)
+    {
+    while (journal_tail != journal_head)
+        {
+        ENTRY *entry = &journal[journal_tail++ % JOURNAL_SIZE] ;
+
+        pending[entry->index] = entry->digit ;
+        dirty[entry->index / 32] |= 1u << (entry->index % 32) ;
+        }
+    }
+
+// The frame timer's callback, and the last frame of every search
+static void RenderFrame(void *arg)
+    {
+    JournalDrain() ;
+    for (int word = 0; word < ENTRIES(dirty); word++)
+        {
+        while (dirty[word] != 0)
             {
-            SetColor(COLOR_BLUE) ;
-            DisplayCell(row, col, digit) ;
-            return new_filled ;
+            int index = 32*word + __builtin_ctz(dirty[word]) ;
+
+            dirty[word] &= dirty[word] - 1 ;
+            if (pending[index] == shown[index]) continue ;
+            shown[index] = pending[index] ;
+            DisplayCell(index / COLS, index % COLS, shown[index]) ;
             }
+        }
+    }
 
-        ClearFlags(row, col, digit) ;
+// The first empty cell with the fewest candidates, stopping early at one that
+// has none or one; -1 if no cell is empty
+static int FewestCandidates(void)
+    {
+    int fewest = 10, best = -1 ;
+
+    for (int index = 0; index < CELLS; index++)
+        {
+        int count ;
+
+        if (candidates[index] & FILLED) continue ;
+
+        count = CountCandidates(candidates[index]) ;
+        if (count < fewest)
+            {
+            fewest = count ;
+            best = index ;
+            if (fewest <= 1) break ;
+            }
         }
 
-    PutNibble(storage, index, EMPTY) ;
-    DisplayCell(row, col, EMPTY) ;
-    report.removed++ ;
-    report.putCalls++ ;
-    return cells_filled ;
+    return best ;
+    }
+
+// Bits set in a 9-bit candidate mask, two bits, then four, then eight at a time
+static int CountCandidates(uint32_t mask)
+    {
+    mask = mask - ((mask >> 1) & 0x155) ;
+    mask = (mask & 0x333) + ((mask >> 2) & 0x333) ;
+    mask = (mask + (mask >> 4)) & 0x30F ;
+    return (mask + (mask >> 8)) & 0xF ;
     }
 
 static void DisplayCell(int row, int col, int digit)
@@ -401,7 +743,7 @@ static void DisplayCell(int row, int col, int digit)
         FillRect(pxlcol[col] + HORZ_OFFSET - 3, pxlrow[row] + VERT_OFFSET - 1, Font24.Width + 6, Font24.Height + 1) ;
         SetForeground(digit_foreground) ;
         SetBackground(digit_background) ;
-        DisplayChar(pxlcol[col] + HORZ_OFFSET, pxlrow[row] + VERT_OFFSET, digit + '0') ;
+        GlyphChar(pxlcol[col] + HORZ_OFFSET, pxlrow[row] + VERT_OFFSET, digit + '0') ;
         }
     }
 
@@ -412,11 +754,12 @@ static void DisplayBoard(void)
     SetFontSize(&Font24) ;
     digit_foreground = COLOR_BLACK ;
     digit_background = COLOR_LIGHTGRAY ;
+    GetNibbles(board, initial, CELLS) ;
     for (int row = 0; row < ROWS; row++)
         {
         for (int col = 0; col < COLS; col++)
             {
-            DisplayCell(row, col, GetNibble(initial, INDEX(row, col))) ;
+            DisplayCell(row, col, board[INDEX(row, col)]) ;
             }
         }
     }
@@ -493,6 +836,23 @@ static int SanityChecksOK(void)
     if (GetNibble(storage, index) != 0xF) bugs |= 0x2 ;
     storage[word] = 0 ;
 
+    // Every nibble of random words out and back in, the spare nibbles after the board untouched
+    for (int i = 0; i < WORDS; i++) storage[i] = GetRandomNumber() ;
+    GetNibbles(board, storage, CELLS) ;
+    for (index = 0; index < CELLS; index++)
+        {
+        if (board[index] != (storage[index / 8] >> 4*(index % 8) & 0xF)) bugs |= 0x4 ;
+        board[index] = ~board[index] ;
+        }
+    left = storage[WORDS - 1] ;
+    PutNibbles(storage, board, CELLS) ;
+    for (index = 0; index < CELLS; index++)
+        {
+        if ((storage[index / 8] >> 4*(index % 8) & 0xF) != (board[index] & 0xF)) bugs |= 0x8 ;
+        }
+    if (storage[WORDS - 1] >> 4*(CELLS % 8) != left >> 4*(CELLS % 8)) bugs |= 0x8 ;
+    for (int i = 0; i < WORDS; i++) storage[i] = 0 ;
+
     LEDs(!bugs, bugs) ;
     if (!bugs) return 1 ;
 
@@ -500,6 +860,8 @@ static int SanityChecksOK(void)
     SetBackground(COLOR_RED) ;
     if (bugs & 0x1) DisplayStringAt(5, 50, (uint8_t *) " Bad Function PutNibble\n") ;
     if (bugs & 0x2) DisplayStringAt(5, 70, (uint8_t *) " Bad Function GetNibble\n") ;
+    if (bugs & 0x4) DisplayStringAt(5, 90, (uint8_t *) " Bad Function GetNibbles\n") ;
+    if (bugs & 0x8) DisplayStringAt(5, 110, (uint8_t *) " Bad Function PutNibbles\n") ;
     return 0 ;
     }
 
@@ -514,11 +876,13 @@ static void LEDs(int grn_on, int red_on)
     *pGPIOG_ODR |= (red_on ? 1 : 0) << 14 ;
     }
 
-static void TS_Delay(unsigned clocks)
+// Sleeps until the push button is let go, skipping everything else
+static void WaitForButtonUp(void)
     {
-#   define  DWT_CYCCNT ((volatile uint32_t *)   0xE0001004)
-    uint32_t timeout = *DWT_CYCCNT + clocks ;
-    while ((timeout - *DWT_CYCCNT) > 100) ;
+    EVENT event ;
+
+    do EventWait(&event) ;
+    while (event.type != EVENT_BUTTON_UP) ;
     }
 
 static void EditConfiguration(void)
@@ -537,20 +901,31 @@ static void EditConfiguration(void)
         10 + 6*CELL_WIDTH,  11 + 7*CELL_WIDTH,  12 + 8*CELL_WIDTH
         } ;
 
+    ShowMode() ;
     SetFontSize(&Font24) ;
     digit_foreground = COLOR_WHITE ;
     digit_background = COLOR_LIGHTGRAY ;
-    while (!PushButtonPressed())
+    for (;;)
         {
         int x, y, digit, row, col ;
+        EVENT event ;
 
-        if (!TS_Touched()) continue ;
+        // Sleeps until the button starts the search or a finger lifts off a cell
+        EventWait(&event) ;
+        if (event.type == EVENT_BUTTON_DOWN) break ;
+        if (event.type != EVENT_TOUCH_UP) continue ;
 
-        x = TS_GetX() ;
-        y = TS_GetY() ;
+        x = event.x ;
+        y = event.y ;
 
-        do TS_Delay(8000000) ;
-        while (TS_Touched()) ;
+        // Above the board: LIVE draws the search as it goes, TURBO only its result
+        if (y < TOP_EDGE)
+            {
+            mode = mode == LIVE ? TURBO : LIVE ;
+            ShowMode() ;
+            SetFontSize(&Font24) ;
+            continue ;
+            }
 
         // Find row
         for (row = 0; row < ROWS; row++)
@@ -583,12 +958,27 @@ static void EditConfiguration(void)
         }
     }
 
+// Back to the board as it was edited, for the next solver
+static void RestoreGame(void)
+    {
+    memcpy(storage, start, sizeof(storage)) ;
+    memcpy(flags, start_flags, sizeof(flags)) ;
+    GetNibbles(board, start, CELLS) ;
+    for (int index = 0; index < CELLS; index++)
+        {
+        if (board[index] == EMPTY) DisplayCell(index / COLS, index % COLS, EMPTY) ;
+        }
+    }
+
+// The swaps work on the bytes of the unpacked board
 static void RandomizeGame(void)
     {
+    GetNibbles(board, initial, CELLS) ;
     RandomizeMajor(SwapRows) ;
     RandomizeMajor(SwapCols) ;
     RandomizeMinor(SwapRows) ;
     RandomizeMinor(SwapCols) ;
+    PutNibbles(initial, board, CELLS) ;
     }
 
 static void RandomizeMajor(void (*Swap)(int, int))
@@ -620,10 +1010,9 @@ static void SwapRows(int row1, int row2)
     int idx2 = COLS*row2 ;
     for (int col = 0; col < COLS; col++)
         {
-        uint32_t cell1 = GetNibble(initial, idx1) ;
-        uint32_t cell2 = GetNibble(initial, idx2) ;
-        PutNibble(initial, idx1, cell2) ;
-        PutNibble(initial, idx2, cell1) ;
+        uint8_t cell1 = board[idx1] ;
+        board[idx1] = board[idx2] ;
+        board[idx2] = cell1 ;
         idx1 += 1 ;
         idx2 += 1 ;
         }
@@ -635,10 +1024,9 @@ static void SwapCols(int col1, int col2)
     int idx2 = 1*col2 ;
     for (int row = 0; row < ROWS; row++)
         {
-        uint32_t cell1 = GetNibble(initial, idx1) ;
-        uint32_t cell2 = GetNibble(initial, idx2) ;
-        PutNibble(initial, idx1, cell2) ;
-        PutNibble(initial, idx2, cell1) ;
+        uint8_t cell1 = board[idx1] ;
+        board[idx1] = board[idx2] ;
+        board[idx2] = cell1 ;
         idx1 += COLS ;
         idx2 += COLS ;
         }
@@ -647,11 +1035,12 @@ static void SwapCols(int col1, int col2)
 static void InitializeFlags(void)
     {
     memset(flags, 0, sizeof(flags)) ;
+    GetNibbles(board, initial, CELLS) ;
+    report.getCalls += CELLS ;          // as the GetNibble a cell it stands in for
     for (int index = 0; index < CELLS; index++)
         {
-        int digit = GetNibble(initial, index) ;
+        int digit = board[index] ;
 
-        report.getCalls++ ;
         if (digit != EMPTY)
             {
             int bit = 1 << digit ;
@@ -686,6 +1075,70 @@ static void SetFlags(int row, int col, int digit)
     flags[FLAGS_BLKS][blk] |= bit ;
     }
 
+// Digits that no cell in the same row, column or block has yet
+static uint32_t Candidates(int index)
+    {
+    int row = index / COLS ;
+    int col = index % COLS ;
+    int blk = 3*(row/3) + col/3 ;
+
+    return ~(flags[FLAGS_ROWS][row] | flags[FLAGS_COLS][col] | flags[FLAGS_BLKS][blk]) & DIGIT_MASK ;
+    }
+
+static void InitializeCandidates(void)
+    {
+    GetNibbles(board, storage, CELLS) ;
+    for (int index = 0; index < CELLS; index++)
+        {
+        if (board[index] != EMPTY) candidates[index] = FILLED ;
+        else candidates[index] = Candidates(index) ;
+        }
+    }
+
+static void InitializePeers(void)
+    {
+    for (int index = 0; index < CELLS; index++)
+        {
+        int row = index / COLS ;
+        int col = index % COLS ;
+        int blk = 3*(row/3) + col/3 ;
+        int count = 0 ;
+
+        for (int other = 0; other < CELLS; other++)
+            {
+            int r = other / COLS ;
+            int c = other % COLS ;
+
+            if (other == index) continue ;
+            if (r == row || c == col || 3*(r/3) + c/3 == blk) peers[index][count++] = other ;
+            }
+        }
+    }
+
+// A digit placed: no peer can have it
+static void MaskDigit(int index, int digit)
+    {
+    uint32_t bit = 1 << digit ;
+
+    SetFlags(index / COLS, index % COLS, digit) ;
+    for (int peer = 0; peer < PEERS; peer++)
+        {
+        candidates[peers[index][peer]] &= ~bit ;
+        }
+    }
+
+// A digit taken back: each empty peer gets it back unless another cell it sees has it
+static void UnmaskDigit(int index, int digit)
+    {
+    ClearFlags(index / COLS, index % COLS, digit) ;
+    for (int peer = 0; peer < PEERS; peer++)
+        {
+        int other = peers[index][peer] ;
+
+        if (!(candidates[other] & FILLED)) candidates[other] = Candidates(other) ;
+        }
+    }
+
 static int Cell2Fill(int index)
     {
     return (index + 1) % CELLS ;
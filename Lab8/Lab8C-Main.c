@@ -10,10 +10,13 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
-#include <inttypes.h>
 #include "library.h"
 #include "graphics.h"
 #include "touch.h"
+#include "format.h"
+#include "widget.h"
+#include "events.h"
+#include "timers.h"
 
 #pragma GCC push_options
 #pragma GCC optimize ("O0")
@@ -33,6 +36,39 @@ uint32_t __attribute__((weak)) Div32X10(uint32_t dividend)
     return dividend / 10 ;
     }
 
+uint64_t __attribute__((weak)) Div64X10(uint64_t dividend)
+    {
+    return dividend / 10 ;
+    }
+
+uint64_t __attribute__((weak)) DivMod64X10(uint64_t dividend, uint32_t *remainder)
+    {
+    *remainder = dividend % 10 ;
+    return dividend / 10 ;
+    }
+
+uint32_t __attribute__((weak)) Tolerance64(uint32_t digits, int32_t exponent, uint32_t hundredths, uint64_t values[3])
+    {
+    uint64_t unit = 1 ;
+
+    if (digits >= 1000 || exponent < -2 || exponent > 9 || hundredths > 10000) return 0 ;
+    for (int k = -2; k < exponent; k++) unit *= 10 ;
+    values[0] = 10000 * digits * unit ;
+    values[1] = values[0] - hundredths * digits * unit ;
+    values[2] = values[0] + hundredths * digits * unit ;
+    return 1 ;
+    }
+
+void __attribute__((weak)) Mul32X10Array(uint32_t *dst, uint32_t *src, uint32_t count)
+    {
+    while (count-- > 0) *dst++ = 10 * *src++ ;
+    }
+
+void __attribute__((weak)) Div32X10Array(uint32_t *dst, uint32_t *src, uint32_t count)
+    {
+    while (count-- > 0) *dst++ = *src++ / 10 ;
+    }
+
 #pragma GCC pop_options
 
 typedef enum {FALSE = 0, TRUE = 1} BOOL ;
@@ -42,17 +78,43 @@ typedef int             COLOR ;
 typedef struct
     {
     COLOR               color ;
-    uint32_t            value ;
+    int32_t             value ;
     } CODE ;
 
+typedef enum {DIGITS, ZEROES, PERCNT, TEMPCO, TABLES} TABLE ;
+
 typedef struct
     {
-    COLOR               *color ;
     CODE                *code ;
     int                 codes ;
+    } CODES ;
+
+#define MAX_BANDS       6
+
+// Where a band goes on the body, what it means and its color before it is touched
+typedef struct
+    {
+    TABLE               table ;
+    int                 gaps ;          // BAND_GAPs left of it, besides the bands
+    COLOR               color ;
+    } PLACE ;
+
+// One kind of part: its bands from left to right
+typedef struct
+    {
+    const char          *name ;
+    int                 count ;
+    PLACE               place[MAX_BANDS] ;
+    } SPEC ;
+
+typedef struct
+    {
+    COLOR               color ;
+    TABLE               table ;
     int                 xpos ;
     int                 ypos ;
     int                 ndex ;
+    int32_t             value ;         // decoded from color, UNKNOWN if not in the table
     } BAND ;
 
 // Public fonts defined in run-time library
@@ -68,7 +130,6 @@ extern sFONT Font8, Font12, Font16, Font20, Font24 ;
 #define FONT_BAND       Font16
 #define FONT_EXP        Font12
 #define FONT_VAL        Font16
-#define FONT_ERR        Font16
 
 #define ENTRIES(a)      (sizeof(a)/sizeof(a[0]))
 
@@ -85,7 +146,7 @@ extern sFONT Font8, Font12, Font16, Font20, Font24 ;
 
 #define BAND_WIDTH      12
 #define BAND_GAP        6
-#define BODY_LENGTH     (6*(BAND_WIDTH + BAND_GAP))
+#define BODY_LENGTH     (7*(BAND_WIDTH + BAND_GAP))
 #define BODY_DIAMETER   30
 #define BODY_XLFT       ((XPIXELS - BODY_LENGTH)/2)
 #define BODY_YTOP       70
@@ -100,26 +161,34 @@ extern sFONT Font8, Font12, Font16, Font20, Font24 ;
 #define YPOS_MIN        (YPOS_VAL + 3*FONT_VAL.Height)
 #define YPOS_MAX        (YPOS_MIN + 3*FONT_VAL.Height)
 
+#define SPEC_WIDTH      (9*FONT_EXP.Width + 8)
+#define SPEC_HEIGHT     (FONT_EXP.Height + 4)
+#define SPEC_XLFT       ((XPIXELS - SPEC_WIDTH)/2)
+#define SPEC_YTOP       (BODY_YTOP - SPEC_HEIGHT - 3)
+
 #define TS_XFUDGE           -4
 #define TS_YFUDGE           -4
 
-#define CPU_CLOCK_SPEED_MHZ 168
+#define REPEAT_DELAY        500     // msec a finger is held before a band repeats
+#define REPEAT_MSEC         30      // msec between repeats
+#define ARRAY_CHECK         7       // words through the array routines: 4 + a tail of 3
+
+#define UNKNOWN             INT32_MIN   // LookUp's value for a color not in the table
 
+static void             Adjust(void *arg) ;
 static BOOL             Adjusted(unsigned x, unsigned y) ;
 static BOOL             Between(unsigned min, unsigned val, unsigned max) ;
-static void             DelayMS(uint32_t msec) ;
+static unsigned         Decode(void) ;
 static void             DisplayBands(void) ;
+static void             DisplayCode(WIDGET *widget, const char *format, int32_t value) ;
 static void             DisplayResults(void) ;
 static void             DisplayValues(void) ;
-static void             Error(void) ;
-static unsigned         GetTimeout(uint32_t msec) ;
 static void             InitializeTouchScreen(void) ;
-static uint32_t         LookUp(COLOR color, CODE *code, unsigned length) ;
+static int32_t          LookUp(COLOR color, TABLE table, int *ndex) ;
 static void             PaintResistor(void) ;
-static uint64_t         Pow10(uint32_t exp) ;
-static void             SetColorIndices(void) ;
+static void             SetBands(int which) ;
 static void             SetFontSize(sFONT *Font) ;
-static char *           Value(uint64_t ohms) ;
+static char *           Value(uint64_t micro) ;
 
 static CODE digits[] = 
     {
@@ -135,8 +204,6 @@ static CODE digits[] =
     {COLOR_WHITE,       9}
     } ;
 
-#define DIGIT(color)    LookUp(color, digits, ENTRIES(digits))
-
 static CODE zeroes[] = 
     {
     {COLOR_BLACK,       0},     //  x1
@@ -149,72 +216,122 @@ static CODE zeroes[] =
     {COLOR_VIOLET,      7},     //  x10000000
     {COLOR_GRAY,        8},     //  x100000000
     {COLOR_WHITE,       9},     //  x1000000000
+    {COLOR_GOLD,       -1},     //  x0.1
+    {COLOR_SILVER,     -2}      //  x0.01
     } ;
 
-#define ZEROES(color)   LookUp(color, zeroes, ENTRIES(zeroes))
-
-static CODE percnt[] =
+static CODE percnt[] =              // hundredths of a percent
     {
-    {COLOR_BROWN,        1},        //  1%
-    {COLOR_RED,          2},        //  2%
-    {COLOR_GOLD,         5},        //  5%
-    {COLOR_SILVER,      10},        //  10%
-    {COLOR_NONE,        20}         //  20%
+    {COLOR_GRAY,         5},        //  0.05%
+    {COLOR_VIOLET,      10},        //  0.1%
+    {COLOR_BLUE,        25},        //  0.25%
+    {COLOR_DARKGREEN,   50},        //  0.5%
+    {COLOR_BROWN,      100},        //  1%
+    {COLOR_RED,        200},        //  2%
+    {COLOR_GOLD,       500},        //  5%
+    {COLOR_SILVER,    1000},        //  10%
+    {COLOR_NONE,      2000}         //  20%
     } ;
 
-#define PERCNT(color)   LookUp(color, percnt, ENTRIES(percnt))
+static CODE tempco[] =              // ppm per degree C
+    {
+    {COLOR_BLACK,      250},
+    {COLOR_BROWN,      100},
+    {COLOR_RED,         50},
+    {COLOR_ORANGE,      15},
+    {COLOR_YELLOW,      25},
+    {COLOR_DARKGREEN,   20},
+    {COLOR_BLUE,        10},
+    {COLOR_VIOLET,       5},
+    {COLOR_GRAY,         1}
+    } ;
 
-static COLOR colors[4] = {COLOR_RED, COLOR_BLUE, COLOR_DARKGREEN, COLOR_GOLD} ;
+static CODES tables[TABLES] =
+    {
+    {digits, ENTRIES(digits)},
+    {zeroes, ENTRIES(zeroes)},
+    {percnt, ENTRIES(percnt)},
+    {tempco, ENTRIES(tempco)}
+    } ;
 
-static BAND bands[] =
+// Tolerance and temperature coefficient stand a little apart from the value bands
+static const SPEC specs[] =
     {
-    {&colors[0], digits, ENTRIES(digits), BODY_XLFT + 1*BAND_GAP + 0*BAND_WIDTH, BODY_YTOP + 1},
-    {&colors[1], digits, ENTRIES(digits), BODY_XLFT + 2*BAND_GAP + 1*BAND_WIDTH, BODY_YTOP + 1},
-    {&colors[2], zeroes, ENTRIES(zeroes), BODY_XLFT + 3*BAND_GAP + 2*BAND_WIDTH, BODY_YTOP + 1},
-    {&colors[3], percnt, ENTRIES(percnt), BODY_XLFT + 6*BAND_GAP + 3*BAND_WIDTH, BODY_YTOP + 1}
+    {"4 Bands", 4, {{DIGITS, 1, COLOR_RED},   {DIGITS, 2, COLOR_BLUE},   {ZEROES, 3, COLOR_DARKGREEN},
+                    {PERCNT, 6, COLOR_GOLD}}},
+    {"5 Bands", 5, {{DIGITS, 1, COLOR_BROWN}, {DIGITS, 2, COLOR_BLACK},  {DIGITS, 3, COLOR_BLACK},
+                    {ZEROES, 4, COLOR_BROWN}, {PERCNT, 7, COLOR_BROWN}}},
+    {"6 Bands", 6, {{DIGITS, 1, COLOR_YELLOW}, {DIGITS, 2, COLOR_VIOLET}, {DIGITS, 3, COLOR_BLACK},
+                    {ZEROES, 4, COLOR_BROWN}, {PERCNT, 7, COLOR_BROWN}, {TEMPCO, 8, COLOR_RED}}}
     } ;
 
+static const SPEC *spec ;          // the kind of part on the screen, set by SetBands
+static BAND bands[MAX_BANDS] ;
+
+// Decoded terms, by table: the significand of the digit bands, then the exponent,
+// tolerance and temperature coefficient. A band that changes marks its table
+// stale, and Decode recomputes only those terms.
+static int32_t terms[TABLES] ;
+static unsigned stale ;
+static uint64_t micro[3] ;          // nominal, minimum and maximum in micro-ohms
+static const char *problem ;        // instead of micro[], or NULL
+
+#define VALUE_TERMS     ((1 << DIGITS) | (1 << ZEROES) | (1 << PERCNT))
+
 int main()
     {
-    unsigned delay1, delay2, x, y ;
+    static TIMER repeat ;
+    static EVENT touch ;
 
     InitializeHardware(HEADER, "Lab 8C: Resistor Color Codes") ;
     InitializeTouchScreen() ;
-    SetColorIndices() ;
+    SetBands(0) ;
+    EventInitialize() ;
 
-    delay1 = delay2 = 0 ;
+    PaintResistor() ;
+    DisplayResults() ;
     while (1)
         {
-        PaintResistor() ;
-        DisplayResults() ;
-        DelayMS(delay1) ;
-        delay1 = delay2 ;
-        while (1)
-            {
-            if (TS_Touched())
-                {
-                x = TS_GetX() + TS_XFUDGE ;
-                y = TS_GetY() + TS_YFUDGE ;
+        EVENT event ;
 
-                if (Adjusted(x, y))
-                    {
-                    delay2 = 30 ;
-                    break ;
-                    }
-                }
-            else delay1 = 500 ;
+        EventWait(&event) ;
+
+        // A band steps once when touched and then repeats while the finger stays on it
+        if (event.type == EVENT_TOUCH_DOWN)
+            {
+            touch = event ;
+            Adjust(&touch) ;
+            TimerStart(&repeat, REPEAT_DELAY, REPEAT_MSEC, Adjust, &touch) ;
             }
+        else if (event.type == EVENT_TOUCH_DRAG) touch = event ;
+        else if (event.type == EVENT_TOUCH_UP) TimerStop(&repeat) ;
         }
 
     return 0 ;
     }
 
+static void Adjust(void *arg)
+    {
+    EVENT *touch = (EVENT *) arg ;
+
+    if (!Adjusted(touch->x + TS_XFUDGE, touch->y + TS_YFUDGE)) return ;
+    PaintResistor() ;
+    DisplayResults() ;
+    }
+
 static void DisplayResults(void)
     {
-    SetForeground(COLOR_BKGD) ;
-    FillRect(10, YPOS_VAL - FONT_VAL.Height/2, XPIXELS - 20, 9*FONT_VAL.Height + 6) ;
-    SetForeground(COLOR_BRDR) ;
-    DrawRect(10, YPOS_VAL - FONT_VAL.Height/2, XPIXELS - 20, 9*FONT_VAL.Height + 6) ;
+    static BOOL init = TRUE ;
+
+    // The box is painted once; after that the widgets inside it repaint only what changes
+    if (init)
+        {
+        SetForeground(COLOR_BKGD) ;
+        FillRect(10, YPOS_VAL - FONT_VAL.Height/2, XPIXELS - 20, 9*FONT_VAL.Height + 6) ;
+        SetForeground(COLOR_BRDR) ;
+        DrawRect(10, YPOS_VAL - FONT_VAL.Height/2, XPIXELS - 20, 9*FONT_VAL.Height + 6) ;
+        init = FALSE ;
+        }
 
     DisplayBands() ;
     DisplayValues() ;
@@ -222,112 +339,232 @@ static void DisplayResults(void)
 
 static void DisplayBands(void)
     {
-    char digit[5] ;
-    int xpos, ypos ;
+    static WIDGET text[MAX_BANDS], button ;
+    static const SPEC *shown = NULL ;
+    int ypos = BODY_YTOP + BODY_DIAMETER + 9 ;
+    BAND *band ;
+    int b, digits ;
 
-    SetFontSize(&FONT_BAND) ;
-    SetForeground(COLOR_BLACK) ;
-    SetBackground(COLOR_WHITE) ;
-
-    ypos = bands[0].ypos + BODY_DIAMETER + 8 ;
-    sprintf(digit, "%u", (unsigned) DIGIT(colors[0])) ;
-    DisplayStringAt(bands[0].xpos + 1, ypos, digit) ;
-    sprintf(digit, "%u", (unsigned) DIGIT(colors[1])) ;
-    DisplayStringAt(bands[1].xpos + 1, ypos, digit) ;
-    sprintf(digit, "%u%%", (unsigned) PERCNT(colors[3])) ;
-    DisplayStringAt(bands[3].xpos + 1, ypos, digit) ;
-
-    xpos = bands[2].xpos - 4 ;
-    DisplayStringAt(xpos, ypos, "10") ;
-    sprintf(digit, "%u", (unsigned) ZEROES(colors[2])) ;
-    SetFontSize(&FONT_EXP) ;
-    xpos += 2*FONT_BAND.Width ;
-    DisplayStringAt(xpos, ypos - FONT_EXP.Height/2, digit) ;
+    // Under each band what it stands for; laid out again for another kind of part
+    if (shown != spec)
+        {
+        SetForeground(COLOR_WHITE) ;
+        FillRect(0, ypos - FONT_EXP.Height/2, XPIXELS, FONT_EXP.Height/2 + 2*FONT_BAND.Height) ;
+        SetFontSize(&FONT_BAND) ;
+        SetForeground(COLOR_BLACK) ;
+        SetBackground(COLOR_WHITE) ;
+
+        band = &bands[0] ;
+        for (b = digits = 0; b < spec->count; b++, band++)
+            {
+            int xpos = band->xpos + 1 ;
+
+            // After a third digit the multiplier and tolerance move a cell right,
+            // clear of it and of each other
+            if (digits == 3 && (band->table == ZEROES || band->table == PERCNT)) xpos += FONT_BAND.Width ;
+            switch (band->table)
+                {
+                case DIGITS:
+                    digits++ ;
+                    text[b] = (WIDGET) {xpos, ypos, 1*FONT_BAND.Width, 0, WIDGET_LEFT, &FONT_BAND, COLOR_BLACK, COLOR_WHITE} ;
+                    break ;
+                case ZEROES:
+                    xpos -= 6 ;
+                    text[b] = (WIDGET) {xpos + 2*FONT_BAND.Width, ypos - FONT_EXP.Height/2, 2*FONT_EXP.Width, 0, WIDGET_LEFT, &FONT_EXP, COLOR_BLACK, COLOR_WHITE} ;
+                    DisplayStringAt(xpos, ypos, (uint8_t *) "10") ;
+                    break ;
+                case PERCNT:
+                    text[b] = (WIDGET) {xpos, ypos, 5*FONT_BAND.Width, 0, WIDGET_LEFT, &FONT_BAND, COLOR_BLACK, COLOR_WHITE} ;
+                    break ;
+                default:            // a line lower, clear of the tolerance
+                    text[b] = (WIDGET) {xpos, ypos + FONT_BAND.Height, 6*FONT_BAND.Width, 0, WIDGET_LEFT, &FONT_BAND, COLOR_BLACK, COLOR_WHITE} ;
+                    break ;
+                }
+            }
+
+        button = (WIDGET) {SPEC_XLFT, SPEC_YTOP, SPEC_WIDTH, SPEC_HEIGHT, WIDGET_CENTER, &FONT_EXP, COLOR_BLACK, COLOR_BODY, COLOR_BLACK} ;
+        shown = spec ;
+        }
+
+    WidgetText(&button, spec->name) ;
+    band = &bands[0] ;
+    for (b = 0; b < spec->count; b++, band++)
+        {
+        int32_t value = band->value ;
+
+        switch (band->table)
+            {
+            case DIGITS:
+            case ZEROES:
+                DisplayCode(&text[b], "%d", value) ;
+                break ;
+            case PERCNT:
+                if (value != UNKNOWN && value % 100 == 0) DisplayCode(&text[b], "%d%%", value / 100) ;
+                else DisplayCode(&text[b], "%.2q%%", value) ;
+                break ;
+            default:
+                DisplayCode(&text[b], "%dppm", value) ;
+                break ;
+            }
+        }
+    }
+
+static void DisplayCode(WIDGET *widget, const char *format, int32_t value)
+    {
+    if (value == UNKNOWN) WidgetText(widget, "?") ;
+    else WidgetFormat(widget, format, (int) value) ;
+    }
+
+// Recomputes the stale terms, and the values if a term they depend on is one of
+// them; returns the tables whose terms were recomputed
+static unsigned Decode(void)
+    {
+    unsigned changed = stale ;
+    BAND *band ;
+    int b ;
+
+    for (int t = 0; t < TABLES; t++)
+        {
+        if (changed & (1 << t)) terms[t] = 0 ;
+        }
+
+    band = &bands[0] ;
+    for (b = 0; b < spec->count; b++, band++)
+        {
+        int32_t *term = &terms[band->table] ;
+
+        if (!(changed & (1 << band->table)) || *term == UNKNOWN) continue ;
+        if (band->value == UNKNOWN) *term = UNKNOWN ;
+        else if (band->table == DIGITS) *term = Mul32X10(*term) + band->value ;
+        else *term = band->value ;
+        }
+
+    if (changed & VALUE_TERMS)
+        {
+        problem = NULL ;
+        if (terms[DIGITS] == UNKNOWN || terms[ZEROES] == UNKNOWN || terms[PERCNT] == UNKNOWN) problem = "Unknown color" ;
+        else if (!Tolerance64(terms[DIGITS], terms[ZEROES], terms[PERCNT], micro)) problem = "Out of range" ;
+        }
+
+    stale = 0 ;
+    return changed ;
     }
 
 static void DisplayValues()
     {
-    uint64_t ohms = (Mul32X10(DIGIT(colors[0])) + DIGIT(colors[1])) * Pow10(ZEROES(colors[2])) ;
-    uint64_t delR = Div32X10(PERCNT(colors[3]) * (uint32_t) (ohms/10)) ;
-    uint64_t minR = ohms - delR ;
-    uint64_t maxR = ohms + delR ;
-    uint64_t rand ;
+    static const char *labels[] = {"Resistance:", "Minimum:", "Maximum:"} ;
+    static WIDGET label[3], value[3] ;
+    static char text[3][30] ;
+    static BOOL init = TRUE ;
+    unsigned changed = Decode() ;
+    uint32_t words[ARRAY_CHECK], product[ARRAY_CHECK], quotient[ARRAY_CHECK] ;
+    uint64_t rand, unit, check[3] ;
+    uint32_t digits, hundredths ;
+    int32_t power ;
     BOOL ok = TRUE ;
 
+    if (init)
+        {
+        const int ypos[] = {YPOS_VAL, YPOS_MIN, YPOS_MAX} ;
+
+        for (int k = 0; k < 3; k++)
+            {
+            label[k] = (WIDGET) {XPOS_VAL, ypos[k], strlen(labels[k])*FONT_VAL.Width, 0, WIDGET_LEFT, &FONT_VAL} ;
+            value[k] = (WIDGET) {XPOS_VAL + 20, ypos[k] + FONT_VAL.Height + 2, XPIXELS - 12 - (XPOS_VAL + 20), 0, WIDGET_LEFT, &FONT_VAL} ;
+            }
+        init = FALSE ;
+        }
+
     ((uint32_t *) &rand)[0] = GetRandomNumber() ;
     ((uint32_t *) &rand)[1] = GetRandomNumber() ;
     if (Mul64X10(rand) != 10ULL*rand) ok = FALSE ;
     if (Mul32X10(((uint32_t *) &rand)[0]) != 10*((uint32_t *) &rand)[0]) ok = FALSE ;
     if (Div32X10(((uint32_t *) &rand)[0]) != ((uint32_t *) &rand)[0]/10) ok = FALSE ;
+    if (Div64X10(rand) != rand/10) ok = FALSE ;
+
+    // Any multiplier and tolerance, against 10^(power+2) one Mul64X10 at a time
+    digits = ((uint32_t *) &rand)[0] % 1000 ;
+    power = ((uint32_t *) &rand)[1] % 12 - 2 ;
+    hundredths = percnt[((uint32_t *) &rand)[1] % ENTRIES(percnt)].value ;
+    unit = 1 ;
+    for (int k = -2; k < power; k++) unit = Mul64X10(unit) ;
+    if (!Tolerance64(digits, power, hundredths, check) || check[0] != 10000 * digits * unit ||
+        check[1] != check[0] - hundredths * digits * unit || check[2] != check[0] + hundredths * digits * unit) ok = FALSE ;
+    if (Tolerance64(1000, 0, 0, check) || Tolerance64(0, 10, 0, check) || Tolerance64(0, -3, 0, check) || Tolerance64(0, 0, 10001, check)) ok = FALSE ;
+
+    // Digit by digit, as a 64-bit decimal conversion would use it
+    for (uint64_t n = rand, q; n != 0; n = q)
+        {
+        uint32_t digit ;
 
-    SetFontSize(&FONT_VAL) ;
-    SetForeground(ok ? COLOR_TEXT : COLOR_WHITE) ;
-    SetBackground(ok ? COLOR_BKGD : COLOR_RED) ;
-
-    DisplayStringAt(XPOS_VAL, YPOS_VAL, "Resistance:") ;
-    DisplayStringAt(XPOS_VAL + 20, YPOS_VAL + FONT_VAL.Height + 2, Value(ohms)) ;
-
-    DisplayStringAt(XPOS_VAL, YPOS_MIN, "Minimum:") ;
-    DisplayStringAt(XPOS_VAL + 20, YPOS_MIN + FONT_VAL.Height + 2, Value(minR)) ;
-
-    DisplayStringAt(XPOS_VAL, YPOS_MAX, "Maximum:") ;
-    DisplayStringAt(XPOS_VAL + 20, YPOS_MAX + FONT_VAL.Height + 2, Value(maxR)) ;
-    }
-
-static char *Value(uint64_t ohms)
-    {
-    static char text[20] ;
+        q = DivMod64X10(n, &digit) ;
+        if (q != n/10 || digit != n%10) ok = FALSE ;
+        }
 
-    if (ohms >= 1000000000)
+    for (int k = 0; k < ARRAY_CHECK; k++) words[k] = GetRandomNumber() ;
+    Mul32X10Array(product, words, ARRAY_CHECK) ;
+    Div32X10Array(quotient, words, ARRAY_CHECK) ;
+    for (int k = 0; k < ARRAY_CHECK; k++)
         {
-        sprintf(text, "%f", ohms/1e9) ;
-        text[5] = '\0' ;
-        if (text[4] == '.') text[4] = '\0' ;
-        strcat(text, " GigaOhms") ;
+        if (product[k] != 10*words[k] || quotient[k] != words[k]/10) ok = FALSE ;
         }
-    else if (ohms >= 1000000)
+
+    for (int k = 0; k < 3; k++)
         {
-        sprintf(text, "%f", ohms/1e6) ;
-        text[5] = '\0' ;
-        if (text[4] == '.') text[4] = '\0' ;
-        strcat(text, " MegaOhms") ;
+        label[k].foreground = value[k].foreground = ok ? COLOR_TEXT : COLOR_WHITE ;
+        label[k].background = value[k].background = ok ? COLOR_BKGD : COLOR_RED ;
+        WidgetText(&label[k], labels[k]) ;
         }
-    else if (ohms >= 1000)
+
+    // Formatted again only when the nominal, minimum and maximum are
+    for (int k = 0; k < 3; k++)
         {
-        sprintf(text, "%f", ohms/1e3) ;
-        text[5] = '\0' ;
-        if (text[4] == '.') text[4] = '\0' ;
-        strcat(text, " KiloOhms") ;
+        if (changed & VALUE_TERMS) strcpy(text[k], problem ? problem : Value(micro[k])) ;
+        WidgetText(&value[k], text[k]) ;
         }
-    else
+    }
+
+static char *Value(uint64_t micro)
+    {
+    static char *units[] = {" MicroOhms", " MilliOhms", " Ohms", " KiloOhms", " MegaOhms", " GigaOhms", " TeraOhms"} ;
+    static char text[30] ;
+    char *end ;
+    int group ;
+
+    // Whole ohms below 1K, zero too, as plain ohms: 470 Ohms, not 470.0 Ohms
+    if (micro < 1000000000 && (uint32_t) micro % 1000000 == 0)
         {
-        sprintf(text, "%"PRIu64" Ohms", ohms) ;
+        FormatString(text, sizeof(text), "%u Ohms", (uint32_t) micro / 1000000) ;
+        return text ;
         }
 
+    // At most 5 characters, cut off rather than rounded: 4.700 KiloOhms, 470.0 KiloOhms
+    end = FormatEngineering(text, micro, 5, &group) ;
+    strcpy(end, units[group]) ;
     return text ;
     }
 
-static void SetColorIndices(void)
+// Puts the bands of specs[which] on the body in their first colors, each pointed
+// at its color's place in its table, with every term to be decoded
+static void SetBands(int which)
     {
     BAND *band ;
     int b ;
 
+    spec = &specs[which] ;
     band = &bands[0] ;
-    for (b = 0; b < ENTRIES(bands); b++, band++)
+    for (b = 0; b < spec->count; b++, band++)
         {
-        CODE *code ;
-        int c ;
-
-        code = &band->code[0] ;
-        for (c = 0; c < band->codes; c++, code++)
-            {
-            if (code->color == colors[b])
-                {
-                band->ndex = b ;
-                break ;
-                }
-            }
+        const PLACE *place = &spec->place[b] ;
+
+        band->color = place->color ;
+        band->table = place->table ;
+        band->xpos  = BODY_XLFT + place->gaps*BAND_GAP + b*BAND_WIDTH ;
+        band->ypos  = BODY_YTOP + 1 ;
+        band->ndex  = 0 ;
+        band->value = LookUp(band->color, band->table, &band->ndex) ;
         }
+    stale = (1 << TABLES) - 1 ;
     }
 
 static void PaintResistor(void)
@@ -344,9 +581,9 @@ static void PaintResistor(void)
     DrawRect(BODY_XLFT, BODY_YTOP, BODY_LENGTH, BODY_DIAMETER) ;
 
     band = &bands[0] ;
-    for (b = 0; b < ENTRIES(bands); b++, band++)
+    for (b = 0; b < spec->count; b++, band++)
         {
-        SetForeground(colors[b]) ;
+        SetForeground(band->color) ;
         FillRect(band->xpos, band->ypos, BAND_WIDTH, BODY_DIAMETER - 1) ;
         }
     }
@@ -356,15 +593,25 @@ static BOOL Adjusted(unsigned x, unsigned y)
     BAND *band ;
     int b ;
 
+    if (Between(SPEC_XLFT, x, SPEC_XLFT + SPEC_WIDTH) && Between(SPEC_YTOP, y, SPEC_YTOP + SPEC_HEIGHT))
+        {
+        SetBands((spec - specs + 1) % ENTRIES(specs)) ;
+        return TRUE ;
+        }
+
     band = &bands[0] ;
-    for (b = 0; b < ENTRIES(bands); b++, band++)
+    for (b = 0; b < spec->count; b++, band++)
         {
         if (Between(band->ypos, y, band->ypos + BODY_DIAMETER - 1))
             {
             if (Between(band->xpos, x, band->xpos + BAND_WIDTH))
                 {
-                band->ndex = (band->ndex + 1) % band->codes ;
-                *band->color = band->code[band->ndex].color ;
+                CODES *codes = &tables[band->table] ;
+
+                band->ndex = (band->ndex + 1) % codes->codes ;
+                band->color = codes->code[band->ndex].color ;
+                band->value = codes->code[band->ndex].value ;
+                stale |= 1 << band->table ;
                 return TRUE ;
                 }
             }
@@ -373,31 +620,19 @@ static BOOL Adjusted(unsigned x, unsigned y)
     return FALSE ;
     }
 
-static uint64_t Pow10(uint32_t exp)
+// The color's value in the table, and its place there if ndex is not NULL; UNKNOWN
+// for a color the table does not have
+static int32_t LookUp(COLOR color, TABLE table, int *ndex)
     {
-    uint64_t result = 1000000ULL ;
-    while (exp-- > 0) result = Mul64X10(result) ;
-    return result / 1000000ULL ;
-    }
-
-static void Error(void)
-    {
-    SetFontSize(&FONT_ERR) ;
-    SetForeground(COLOR_BLACK) ;
-    SetBackground(COLOR_WHITE) ;
-    printf("ERROR!\n") ;
-    exit(0) ;
-    }
+    int c ;
 
-static uint32_t LookUp(COLOR color, CODE *code, unsigned length)
-    {
-    while (length-- > 0)
+    for (c = 0; c < tables[table].codes; c++)
         {
-        if (code->color == color) return code->value ;
-        code++ ;
+        if (tables[table].code[c].color == color) break ;
         }
-    Error() ;
-    return 0 ;
+    if (c == tables[table].codes) return UNKNOWN ;
+    if (ndex != NULL) *ndex = c ;
+    return tables[table].code[c].value ;
     }
 
 static void InitializeTouchScreen(void)
@@ -436,18 +671,6 @@ static void SetFontSize(sFONT *Font)
     BSP_LCD_SetFont(Font) ;
     }
 
-static unsigned GetTimeout(uint32_t msec)
-    {
-    unsigned cycles = 1000 * msec * CPU_CLOCK_SPEED_MHZ ;
-    return GetClockCycleCount() + cycles ;
-    }
-
-static void DelayMS(uint32_t msec)
-    {
-    uint32_t timeout = GetTimeout(msec) ;
-    while ((int) (timeout - GetClockCycleCount()) > 0) ;
-    }
-
 static BOOL Between(unsigned min, unsigned val, unsigned max)
     {
     return (min <= val && val <= max) ;
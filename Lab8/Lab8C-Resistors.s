@@ -52,6 +52,195 @@ Div32X10:           // R0 = dividend
         LSRS.N      R0,R1,3             // r0 =  r1 / 3
         BX          LR                  // return
 
+// uint64_t Div64X10(uint64_t dividend) ;
+// Quotient = high 64 bits of dividend x 0xCCCCCCCCCCCCCCCD (2^67/10 rounded up),
+// shifted right 3: four 32x32 partial products, low column thrown away.
+
+        .global     Div64X10
+        .thumb_func
+        .align
+Div64X10:           // R1.R0 = dividend
+        PUSH        {R4,R5}
+        LDR         R3,=0xCCCCCCCC      // high word of the reciprocal
+        ADD         R2,R3,1             // low word, 0xCCCCCCCD
+        UMULL       R12,R4,R0,R2        // lo x lo: only its high half carries
+        MOVS        R5,0
+        UMLAL       R4,R5,R0,R3         // + lo x hi
+        MOVS        R12,0
+        UMLAL       R4,R12,R1,R2        // + hi x lo, R4 (bits 32-63) is done with
+        MOVS        R4,0
+        ADDS        R5,R5,R12           // both carries into bits 64-95
+        ADC         R4,R4,0             // and their carry into bits 96-127
+        UMLAL       R5,R4,R1,R3         // + hi x hi: R4.R5 = product >> 64
+        LSRS        R0,R5,3
+        ORR         R0,R0,R4,LSL 29     // R1.R0 = R4.R5 >> 3
+        LSRS        R1,R4,3
+        POP         {R4,R5}
+        BX          LR
+
+// uint64_t DivMod64X10(uint64_t dividend, uint32_t *remainder) ;
+// Same quotient as Div64X10; remainder = dividend - 10 x quotient, low words only.
+
+        .global     DivMod64X10
+        .thumb_func
+        .align
+DivMod64X10:        // R1.R0 = dividend, R2 = remainder address
+        PUSH        {R4-R6}
+        MOV         R6,R2
+        LDR         R3,=0xCCCCCCCC
+        ADD         R2,R3,1
+        UMULL       R12,R4,R0,R2
+        MOVS        R5,0
+        UMLAL       R4,R5,R0,R3
+        MOVS        R12,0
+        UMLAL       R4,R12,R1,R2
+        MOVS        R4,0
+        ADDS        R5,R5,R12
+        ADC         R4,R4,0
+        UMLAL       R5,R4,R1,R3
+        LSRS        R5,R5,3
+        ORR         R5,R5,R4,LSL 29     // low word of quotient
+        ADD         R2,R5,R5,LSL 2      // 5 x quotient
+        SUB         R2,R0,R2,LSL 1      // dividend - 10 x quotient
+        STR         R2,[R6]
+        MOV         R0,R5
+        LSRS        R1,R4,3
+        POP         {R4-R6}
+        BX          LR
+
+// uint32_t Tolerance64(uint32_t digits, int32_t exponent, uint32_t hundredths, uint64_t values[3]) ;
+// Nominal, minimum and maximum of digits x 10^exponent ohms, +/- hundredths of a
+// percent, in micro-ohms so that all three are exact: with q = digits x 10^(exponent+2),
+// nominal = 10000 x q and the tolerance is hundredths x q. Returns 0 and leaves values
+// alone unless digits < 1000, -2 <= exponent <= 9 and hundredths <= 10000, which also
+// keeps everything below 2^63.
+
+        .global     Tolerance64
+        .thumb_func
+        .align
+Tolerance64:        // R0 = digits, R1 = exponent, R2 = hundredths, R3 = values
+        PUSH        {R4-R6}
+        LDR         R12,=10000
+        ADDS        R1,R1,2             // unsigned, so exponent < -2 is out of range too
+        CMP         R1,11
+        BHI         TolRange
+        CMP         R0,1000
+        BHS         TolRange
+        CMP         R2,R12
+        BHI         TolRange
+        ADR         R6,Powers
+        ADD         R6,R6,R1,LSL 3
+        LDRD        R4,R5,[R6]          // R5.R4 = 10^(exponent+2)
+        UMULL       R4,R6,R0,R4
+        MLA         R5,R0,R5,R6         // R5.R4 = q
+        UMULL       R0,R6,R4,R2
+        MLA         R6,R5,R2,R6         // R6.R0 = tolerance
+        UMULL       R4,R1,R4,R12
+        MLA         R5,R5,R12,R1        // R5.R4 = nominal
+        STRD        R4,R5,[R3]
+        SUBS        R1,R4,R0
+        SBC         R2,R5,R6
+        STRD        R1,R2,[R3,8]        // minimum
+        ADDS        R1,R4,R0
+        ADC         R2,R5,R6
+        STRD        R1,R2,[R3,16]       // maximum
+        MOVS        R0,1
+        POP         {R4-R6}
+        BX          LR
+TolRange:
+        MOVS        R0,0
+        POP         {R4-R6}
+        BX          LR
+
+        .align      2
+Powers: .word       1, 0                // 10^0 to 10^11, low word first
+        .word       10, 0
+        .word       100, 0
+        .word       1000, 0
+        .word       10000, 0
+        .word       100000, 0
+        .word       1000000, 0
+        .word       10000000, 0
+        .word       100000000, 0
+        .word       1000000000, 0
+        .word       1410065408, 2
+        .word       1215752192, 23
+
+// void Div32X10Array(uint32_t *dst, uint32_t *src, uint32_t count) ;
+// dst may be src. Four words per pass through LDMIA/STMIA, then one at a time.
+
+        .global     Div32X10Array
+        .thumb_func
+        .align
+Div32X10Array:      // R0 = dst, R1 = src, R2 = count
+        PUSH        {R4-R7}
+        LDR         R3,=3435973837      // same reciprocal as Div32X10
+        SUBS        R2,R2,4             // at least 4 left?
+        BLO         DivTail
+DivFour:
+        LDMIA       R1!,{R4-R7}         // 4 dividends
+        UMULL       R12,R4,R3,R4        // keep only the high halves
+        UMULL       R12,R5,R3,R5
+        UMULL       R12,R6,R3,R6
+        UMULL       R12,R7,R3,R7
+        LSRS.N      R4,R4,3
+        LSRS.N      R5,R5,3
+        LSRS.N      R6,R6,3
+        LSRS.N      R7,R7,3
+        STMIA       R0!,{R4-R7}         // 4 quotients
+        SUBS        R2,R2,4
+        BHS         DivFour
+DivTail:
+        ADDS        R2,R2,4             // 0 to 3 left
+        BEQ         DivDone
+DivOne:
+        LDR         R4,[R1],4
+        UMULL       R12,R4,R3,R4
+        LSRS.N      R4,R4,3
+        STR         R4,[R0],4
+        SUBS        R2,R2,1
+        BNE         DivOne
+DivDone:
+        POP         {R4-R7}
+        BX          LR
+
+// void Mul32X10Array(uint32_t *dst, uint32_t *src, uint32_t count) ;
+// dst may be src. Four words per pass through LDMIA/STMIA, then one at a time.
+
+        .global     Mul32X10Array
+        .thumb_func
+        .align
+Mul32X10Array:      // R0 = dst, R1 = src, R2 = count
+        PUSH        {R4-R7}
+        SUBS        R2,R2,4             // at least 4 left?
+        BLO         MulTail
+MulFour:
+        LDMIA       R1!,{R4-R7}         // 4 multiplicands
+        ADD         R4,R4,R4,LSL 2      // x*5
+        ADD         R5,R5,R5,LSL 2
+        ADD         R6,R6,R6,LSL 2
+        ADD         R7,R7,R7,LSL 2
+        LSLS.N      R4,R4,1             // x*10
+        LSLS.N      R5,R5,1
+        LSLS.N      R6,R6,1
+        LSLS.N      R7,R7,1
+        STMIA       R0!,{R4-R7}         // 4 products
+        SUBS        R2,R2,4
+        BHS         MulFour
+MulTail:
+        ADDS        R2,R2,4             // 0 to 3 left
+        BEQ         MulDone
+MulOne:
+        LDR         R4,[R1],4
+        ADD         R4,R4,R4,LSL 2
+        LSLS.N      R4,R4,1
+        STR         R4,[R0],4
+        SUBS        R2,R2,1
+        BNE         MulOne
+MulDone:
+        POP         {R4-R7}
+        BX          LR
+
         .end
 
 